@@ -34,6 +34,24 @@ protected:
      */
     std::shared_ptr<Channel> _channel;
 
+    /**
+     *  The memory of requests that are done
+     */
+    std::shared_ptr<Pool> _pool;
+
+    /**
+     *  The answers that were received before
+     */
+    std::shared_ptr<Cache> _cache;
+
+    /**
+     *  Answer a request from the cache, attach it to an identical request
+     *  that was already sent, or send it to the ares library
+     *  @param  request     the request, which is freed when it is done
+     *  @return bool
+     */
+    bool query(Request *request);
+
 public:
     /**
      *  Destructor
@@ -55,6 +73,22 @@ public:
     {
         return _channel;
     }
+
+    /**
+     *  Get access to the pool of requests
+     */
+    std::shared_ptr<Pool> pool()
+    {
+        return _pool;
+    }
+
+    /**
+     *  Get access to the cache
+     */
+    std::shared_ptr<Cache> cache()
+    {
+        return _cache;
+    }
 };
 
 /**
@@ -0,0 +1,224 @@
+/**
+ *  Bulk.h
+ *
+ *  A batch of lookups that is started with Resolver::bulk(). The names are
+ *  taken from the source one at a time, and never more lookups than the
+ *  window allows are on their way, so that even huge batches do not flood
+ *  the resolver. The results are reported as they arrive, and the object
+ *  keeps statistics about the throughput and the latency.
+ *
+ *  @copyright 2014 Copernica BV
+ */
+
+/**
+ *  Set up namespace
+ */
+namespace React { namespace Dns {
+
+/**
+ *  Class definition
+ */
+class Bulk : public std::enable_shared_from_this<Bulk>
+{
+private:
+    /**
+     *  Function that is called when a lookup is done, with true if it failed
+     */
+    using DoneCallback = std::function<void(bool failed)>;
+
+    /**
+     *  Function that starts the lookup of a name
+     */
+    using Lookup = std::function<void(const std::string &name, const DoneCallback &done)>;
+
+    /**
+     *  Pointer to the loop
+     *  @var    Loop
+     */
+    Loop *_loop;
+
+    /**
+     *  The names to look up
+     *  @var    NameSource
+     */
+    NameSource _source;
+
+    /**
+     *  Starts the lookup of one name
+     *  @var    Lookup
+     */
+    Lookup _lookup;
+
+    /**
+     *  Max number of lookups that are on their way
+     *  @var    size_t
+     */
+    size_t _window;
+
+    /**
+     *  Number of lookups that are on their way
+     *  @var    size_t
+     */
+    size_t _inflight = 0;
+
+    /**
+     *  Are there no more names to look up?
+     *  @var    bool
+     */
+    bool _exhausted = false;
+
+    /**
+     *  Are we busy starting lookups?
+     *  @var    bool
+     */
+    bool _filling = false;
+
+    /**
+     *  Time at which the batch started and finished
+     *  @var    Timestamp
+     */
+    Timestamp _started;
+    Timestamp _finished = 0.0;
+
+    /**
+     *  Counters
+     *  @var    uint64_t
+     */
+    uint64_t _completed = 0;
+    uint64_t _failed = 0;
+
+    /**
+     *  Total and highest latency of the lookups
+     *  @var    Timestamp
+     */
+    Timestamp _latency = 0.0;
+    Timestamp _slowest = 0.0;
+
+    /**
+     *  Callback that is called when all lookups are done
+     *  @var    FinishedCallback
+     */
+    FinishedCallback _finishedCallback;
+
+    /**
+     *  Constructor
+     *  @param  loop        Event loop
+     *  @param  source      The names to look up
+     *  @param  lookup      Function that starts the lookup of one name
+     *  @param  window      Max number of lookups that are on their way
+     */
+    Bulk(Loop *loop, const NameSource &source, const Lookup &lookup, size_t window);
+
+    /**
+     *  Start lookups until the window is full
+     */
+    void fill();
+
+    /**
+     *  Called when a lookup is done
+     *  @param  started     Time at which the lookup started
+     *  @param  failed      Did the lookup fail?
+     */
+    void done(Timestamp started, bool failed);
+
+    /**
+     *  The resolver creates the batches
+     */
+    friend class Resolver;
+
+public:
+    /**
+     *  Batches can not be copied
+     *  @param  that
+     */
+    Bulk(const Bulk &that) = delete;
+
+    /**
+     *  Destructor
+     */
+    virtual ~Bulk() {}
+
+    /**
+     *  Install the callback that is called when all lookups are done. If
+     *  the batch is already done, it is called right away.
+     *  @param  callback
+     */
+    void onFinished(const FinishedCallback &callback);
+
+    /**
+     *  Stop taking names from the source, the lookups that are on their way
+     *  are still reported
+     */
+    void cancel();
+
+    /**
+     *  Are all lookups done?
+     *  @return bool
+     */
+    bool finished() const
+    {
+        return _exhausted && _inflight == 0;
+    }
+
+    /**
+     *  Number of lookups that are on their way
+     *  @return size_t
+     */
+    size_t inflight() const
+    {
+        return _inflight;
+    }
+
+    /**
+     *  Number of lookups that are done, failed ones included
+     *  @return uint64_t
+     */
+    uint64_t completed() const
+    {
+        return _completed;
+    }
+
+    /**
+     *  Number of lookups that failed
+     *  @return uint64_t
+     */
+    uint64_t failed() const
+    {
+        return _failed;
+    }
+
+    /**
+     *  Number of seconds since the start, until the batch finished
+     *  @return Timestamp
+     */
+    Timestamp elapsed() const;
+
+    /**
+     *  Number of lookups per second
+     *  @return double
+     */
+    double throughput() const;
+
+    /**
+     *  Average number of seconds per lookup
+     *  @return Timestamp
+     */
+    Timestamp latency() const
+    {
+        return _completed == 0 ? 0.0 : _latency / _completed;
+    }
+
+    /**
+     *  Number of seconds of the slowest lookup
+     *  @return Timestamp
+     */
+    Timestamp slowest() const
+    {
+        return _slowest;
+    }
+};
+
+/**
+ *  End namespace
+ */
+}}
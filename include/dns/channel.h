@@ -24,16 +24,13 @@ private:
     Loop *_loop;
 
     /**
-     *  Set of readers
-     *  @var    std::map
+     *  Watchers for the sockets of the ares library, indexed by filedescriptor,
+     *  that are started and stopped in place. A deque does not move its
+     *  elements when it grows, which matters because libev keeps pointers
+     *  to the active watchers.
+     *  @var    std::deque
      */
-    std::map<int,std::unique_ptr<ReadWatcher>> _readers;
-
-    /**
-     *  Set of writers
-     *  @var    std::map
-     */
-    std::map<int,std::unique_ptr<WriteWatcher>> _writers;
+    std::deque<struct ev_io> _watchers;
 
     /**
      *  The actual underlying channel
@@ -56,6 +53,15 @@ public:
      */
     virtual ~Channel();
 
+    /**
+     *  The loop in which the channel runs
+     *  @return Loop
+     */
+    Loop *loop() const
+    {
+        return _loop;
+    }
+
     /**
      *  Set the timeout for the next iteration
      */
@@ -50,6 +50,17 @@ public:
      *  @param  addr    address and time-to-live
      */
     IpRecord(struct ares_addr6ttl *addr) : _ip(addr->ip6addr), _ttl(addr->ttl) {}
+
+    /**
+     *  Constructor
+     *
+     *  You normally don't construct IpRecord objects yourself, but retrieve
+     *  them with a call to Resolver::ips().
+     *
+     *  @param  ip      the address
+     *  @param  ttl     time-to-live
+     */
+    IpRecord(const Net::Ip &ip, int ttl) : _ip(ip), _ttl(ttl) {}
     
     /**
      *  Destructor
@@ -48,6 +48,18 @@ public:
      */
     MxRecord(const char *hostname, int priority) : _hostname(hostname), _priority(priority) {}
 
+    /**
+     *  Constructor
+     *
+     *  You normally don't construct MxRecord objects yourself, but retrieve
+     *  them with a call to Resolver::mx().
+     *
+     *  @param  hostname    the hostname that handles incoming mail
+     *  @param  priority    the priority (lower gets priority)
+     *  @param  ttl         time-to-live
+     */
+    MxRecord(const char *hostname, int priority, int ttl) : _hostname(hostname), _priority(priority), _ttl(ttl) {}
+
     /**
      *  Destructor
      */
@@ -29,23 +29,25 @@ public:
      */
     MxResult(const unsigned char *buffer, int len)
     {
-        // initial size and data
-        struct ares_mx_reply *first = NULL;
-        
-        // parse the data
-        if (ares_parse_mx_reply(buffer, len, &first) != ARES_SUCCESS) return;
-        
-        // loop over the results
-        for (auto current = first; current; current = current->next) 
+        // buffer for the hostnames
+        char hostname[NS_MAXDNAME];
+
+        // walk over the records
+        Parser parser(buffer, len);
+        while (parser.next())
         {
+            // only MX records of the name or its aliases count, they are in the answer section
+            if (parser.section() != Parser::answer) break;
+            if (parser.type() != ns_t_mx || parser.length() < 3 || !parser.relevant()) continue;
+
+            // the priority is followed by the hostname
+            if (parser.name(parser.data() + 2, hostname, sizeof(hostname)) < 0) continue;
+
             // create record
-            insert(MxRecord(current->host, current->priority));
+            insert(MxRecord(hostname, Parser::read16(parser.data()), parser.ttl()));
         }
-
-        // free used memory
-        ares_free_data(first);
     }
-    
+
     /**
      *  Destructor
      */
@@ -0,0 +1,443 @@
+/**
+ *  Parser.h
+ *
+ *  Class that walks over the records of an answer in wire format. It does
+ *  not allocate memory: the records are read straight from the buffer, and
+ *  names are decoded into a buffer that is supplied by the caller. The
+ *  result classes use it to fill themselves.
+ *
+ *  The parser follows the CNAME records in the answer section, starting at
+ *  the name in the question. Records of which the owner is not the name in
+ *  the question or one of its aliases are not part of the answer, and can
+ *  be recognized with the relevant() method.
+ *
+ *  @copyright 2014 Copernica BV
+ */
+
+/**
+ *  Set up namespace
+ */
+namespace React { namespace Dns {
+
+/**
+ *  Class definition
+ */
+class Parser
+{
+public:
+    /**
+     *  The sections of an answer
+     */
+    enum Section {
+        answer      =   0,
+        authority   =   1,
+        additional  =   2
+    };
+
+private:
+    /**
+     *  The answer
+     *  @var    const unsigned char *
+     */
+    const unsigned char *_buffer;
+
+    /**
+     *  Size of the answer
+     *  @var    int
+     */
+    int _size;
+
+    /**
+     *  Position of the next record
+     *  @var    int
+     */
+    int _pos = 12;
+
+    /**
+     *  Number of records that are left in each section
+     *  @var    int
+     */
+    int _left[3] = { 0, 0, 0 };
+
+    /**
+     *  Section of the current record
+     *  @var    int
+     */
+    int _section = -1;
+
+    /**
+     *  Is the answer valid so far?
+     *  @var    bool
+     */
+    bool _valid = false;
+
+    /**
+     *  Position of the owner name and the data of the current record
+     *  @var    int
+     */
+    int _owner = 0;
+    int _data = 0;
+
+    /**
+     *  Position of the name that the records should belong to, this starts
+     *  as the name in the question and follows the CNAME records
+     *  @var    int
+     */
+    int _alias = -1;
+
+    /**
+     *  Type, ttl and size of the data of the current record
+     *  @var    int
+     */
+    int _type = 0;
+    int _ttl = 0;
+    int _length = 0;
+
+public:
+    /**
+     *  Read a 16 bit number
+     *  @param  buffer      Pointer into the answer
+     *  @return int
+     */
+    static int read16(const unsigned char *buffer)
+    {
+        return (buffer[0] << 8) | buffer[1];
+    }
+
+    /**
+     *  Read a 32 bit number
+     *  @param  buffer      Pointer into the answer
+     *  @return uint32_t
+     */
+    static uint32_t read32(const unsigned char *buffer)
+    {
+        return ((uint32_t)buffer[0] << 24) | (buffer[1] << 16) | (buffer[2] << 8) | buffer[3];
+    }
+
+    /**
+     *  Read a TTL, values with the highest bit set are treated as zero (RFC 2181)
+     *  @param  buffer      Pointer into the answer
+     *  @return int
+     */
+    static int readTtl(const unsigned char *buffer)
+    {
+        uint32_t value = read32(buffer);
+        return value & 0x80000000 ? 0 : value;
+    }
+
+    /**
+     *  Skip over a domain name
+     *  @param  buffer      The answer
+     *  @param  size        Size of the answer
+     *  @param  pos         Position of the name, moved to the end of the name
+     *  @return bool        False if the name runs past the end
+     */
+    static bool skip(const unsigned char *buffer, int size, int &pos)
+    {
+        // process all labels
+        while (pos < size)
+        {
+            // size of the label
+            unsigned char label = buffer[pos];
+
+            // the name ends with an empty label
+            if (label == 0) return ++pos <= size;
+
+            // or with a pointer to a name elsewhere in the answer
+            if ((label & 0xc0) == 0xc0) return (pos += 2) <= size;
+
+            // other label types are not supported
+            if ((label & 0xc0) != 0) return false;
+
+            // skip the label
+            pos += label + 1;
+        }
+
+        // the name does not fit in the answer
+        return false;
+    }
+
+private:
+    /**
+     *  Follow the pointers at a position in a name
+     *  @param  pos         Position in the name, moved to the first label
+     *  @param  limit       Pointers should go before this position
+     *  @return bool        False if the name is invalid
+     */
+    bool resolve(int &pos, int &limit) const
+    {
+        // follow the pointers
+        while (pos < _size && (_buffer[pos] & 0xc0) == 0xc0)
+        {
+            // the pointer should fit
+            if (pos + 1 >= _size) return false;
+
+            // pointers should only go back, otherwise there could be a loop
+            int target = ((_buffer[pos] & 0x3f) << 8) | _buffer[pos + 1];
+            if (target >= limit) return false;
+
+            // continue there
+            pos = limit = target;
+        }
+
+        // we should be at a normal label
+        return pos < _size && (_buffer[pos] & 0xc0) == 0;
+    }
+
+    /**
+     *  Compare two names in the answer, names are case insensitive
+     *  @param  a           Position of the first name
+     *  @param  b           Position of the second name
+     *  @return bool
+     */
+    bool equals(int a, int b) const
+    {
+        // the pointers of the names should go before their start
+        int limitA = a;
+        int limitB = b;
+
+        // compare all labels
+        while (resolve(a, limitA) && resolve(b, limitB))
+        {
+            // the same position means the rest of the name is the same too
+            if (a == b) return true;
+
+            // the labels should have the same size
+            if (_buffer[a] != _buffer[b]) return false;
+
+            // the name ends with an empty label
+            int size = _buffer[a];
+            if (size == 0) return true;
+
+            // the labels should fit
+            if (a + 1 + size > _size || b + 1 + size > _size) return false;
+
+            // compare the labels
+            for (int i = 1; i <= size; ++i) if (tolower(_buffer[a + i]) != tolower(_buffer[b + i])) return false;
+
+            // next label
+            a += size + 1;
+            b += size + 1;
+        }
+
+        // one of the names is invalid
+        return false;
+    }
+
+public:
+    /**
+     *  Constructor
+     *  @param  buffer      The answer in wire format
+     *  @param  size        Size of the answer
+     */
+    Parser(const unsigned char *buffer, int size) : _buffer(buffer), _size(size)
+    {
+        // the header should be there
+        if (size < 12) return;
+
+        // skip the questions, which are followed by a type and class
+        for (int i = read16(buffer + 4); i > 0; --i) if (!skip(buffer, size, _pos) || (_pos += 4) > size) return;
+
+        // the records should belong to the name in the question
+        if (read16(buffer + 4) > 0) _alias = 12;
+
+        // the number of records in each section
+        _left[answer] = read16(buffer + 6);
+        _left[authority] = read16(buffer + 8);
+        _left[additional] = read16(buffer + 10);
+
+        // the answer can be parsed
+        _valid = true;
+    }
+
+    /**
+     *  Destructor
+     */
+    virtual ~Parser() {}
+
+    /**
+     *  Is the answer valid? This becomes false when a record runs past the
+     *  end of the answer
+     *  @return bool
+     */
+    bool valid() const
+    {
+        return _valid;
+    }
+
+    /**
+     *  Move to the next record
+     *  @return bool        False when there are no more records
+     */
+    bool next()
+    {
+        // find the first section that has records left
+        while (_section < additional && (_section < 0 || _left[_section] == 0)) ++_section;
+
+        // check if there is a record
+        if (!_valid || _left[_section] == 0) return false;
+
+        // one record less
+        _left[_section] -= 1;
+
+        // the record starts with the owner name, followed by a type, class, ttl and data size
+        _owner = _pos;
+        if (!skip(_buffer, _size, _pos) || _pos + 10 > _size) return _valid = false;
+
+        // read the record, ttls with the highest bit set should be treated as zero
+        _type = read16(_buffer + _pos);
+        _ttl = readTtl(_buffer + _pos + 4);
+        _length = read16(_buffer + _pos + 8);
+        _data = _pos + 10;
+
+        // move to the next record
+        _pos = _data + _length;
+
+        // the data should fit
+        if (!(_valid = _pos <= _size)) return false;
+
+        // an alias of the name moves the chain to the canonical name
+        if (_section == answer && _type == ns_t_cname && relevant()) _alias = _data;
+
+        // done
+        return true;
+    }
+
+    /**
+     *  Does the current record belong to the name in the question, or to
+     *  one of its aliases? CNAME records that lead to the name are skipped
+     *  over.
+     *  @return bool
+     */
+    bool relevant() const
+    {
+        // without a question all records are relevant
+        return _alias < 0 || equals(_owner, _alias);
+    }
+
+    /**
+     *  Section of the current record
+     *  @return Section
+     */
+    Section section() const
+    {
+        return (Section)_section;
+    }
+
+    /**
+     *  Type of the current record
+     *  @return int
+     */
+    int type() const
+    {
+        return _type;
+    }
+
+    /**
+     *  TTL of the current record
+     *  @return int
+     */
+    int ttl() const
+    {
+        return _ttl;
+    }
+
+    /**
+     *  Owner name of the current record, in wire format
+     *  @return const unsigned char *
+     */
+    const unsigned char *owner() const
+    {
+        return _buffer + _owner;
+    }
+
+    /**
+     *  Data of the current record
+     *  @return const unsigned char *
+     */
+    const unsigned char *data() const
+    {
+        return _buffer + _data;
+    }
+
+    /**
+     *  Size of the data of the current record
+     *  @return int
+     */
+    int length() const
+    {
+        return _length;
+    }
+
+    /**
+     *  Decode a domain name in the answer, like the owner of a record or a
+     *  name in the data of a record
+     *  @param  name        The name in wire format
+     *  @param  output      Buffer for the name, which is terminated with a null
+     *  @param  size        Size of the buffer
+     *  @return int         Length of the name, or -1 if it is invalid or does not fit
+     */
+    int name(const unsigned char *name, char *output, size_t size) const
+    {
+        // position in the answer, and the number of bytes written
+        int pos = name - _buffer;
+        size_t written = 0;
+
+        // pointers should only go back, otherwise there could be a loop
+        int limit = pos;
+
+        // process all labels
+        while (pos >= 0 && pos < _size)
+        {
+            // size of the label
+            unsigned char label = _buffer[pos];
+
+            // the name ends with an empty label
+            if (label == 0)
+            {
+                // there should be room for the terminator
+                if (written >= size) return -1;
+
+                // terminate the name
+                output[written] = 0;
+
+                // done
+                return written;
+            }
+
+            // pointers continue the name elsewhere
+            if ((label & 0xc0) == 0xc0)
+            {
+                // the pointer should fit, and go back
+                if (pos + 1 >= _size) return -1;
+                if ((pos = ((label & 0x3f) << 8) | _buffer[pos + 1]) >= limit) return -1;
+
+                // the next pointer should go back further
+                limit = pos;
+                continue;
+            }
+
+            // other label types are not supported, and the label should fit
+            if ((label & 0xc0) != 0 || pos + 1 + label > _size) return -1;
+
+            // there should be room for a dot, the label and the terminator
+            if (written + (written > 0) + label + 1 > size) return -1;
+
+            // add the label
+            if (written > 0) output[written++] = '.';
+            memcpy(output + written, _buffer + pos + 1, label);
+            written += label;
+
+            // next label
+            pos += label + 1;
+        }
+
+        // the name runs past the end
+        return -1;
+    }
+};
+
+/**
+ *  End namespace
+ */
+}}
@@ -0,0 +1,104 @@
+/**
+ *  PtrRecord.h
+ *
+ *  Class holding a PTR record retrieved from DNS, the name that belongs
+ *  to an address
+ *
+ *  @copyright 2014 Copernica BV
+ */
+
+/**
+ *  Set up namespace
+ */
+namespace React { namespace Dns {
+
+/**
+ *  Class definition
+ */
+class PtrRecord
+{
+private:
+    /**
+     *  Host name
+     *  @var    std::string
+     */
+    std::string _hostname;
+
+    /**
+     *  Time to live
+     *  @var    int
+     */
+    int _ttl;
+
+public:
+    /**
+     *  Constructor
+     *
+     *  You normally don't construct PtrRecord objects yourself, but retrieve
+     *  them with a call to Resolver::ptr().
+     *
+     *  @param  hostname    the name
+     *  @param  ttl         time-to-live
+     */
+    PtrRecord(const char *hostname, int ttl) : _hostname(hostname), _ttl(ttl) {}
+
+    /**
+     *  Destructor
+     */
+    virtual ~PtrRecord() {}
+
+    /**
+     *  Retrieve the hostname
+     *  @return std::string
+     */
+    const std::string &hostname() const
+    {
+        return _hostname;
+    }
+
+    /**
+     *  Retrieve the TTL
+     *  @return int
+     */
+    int ttl() const
+    {
+        return _ttl;
+    }
+
+    /**
+     *  Compare two objects
+     *  @param  that    record to compare to
+     *  @return bool
+     */
+    bool operator==(const PtrRecord &that) const
+    {
+        return _hostname == that._hostname && _ttl == that._ttl;
+    }
+
+    /**
+     *  Compare two objects
+     *  @param  that    record to compare to
+     *  @return bool
+     */
+    bool operator!=(const PtrRecord &that) const
+    {
+        return _hostname != that._hostname || _ttl != that._ttl;
+    }
+};
+
+/**
+ *  Function to write a record to a stream
+ *  @param  os  stream to write to
+ *  @param  ptr the ptr record to display
+ *  @return ostream
+ */
+inline std::ostream &operator<<(std::ostream &os, const React::Dns::PtrRecord &ptr)
+{
+    os << ptr.hostname();
+    return os;
+}
+
+/**
+ *  End namespace
+ */
+}}
@@ -0,0 +1,60 @@
+/**
+ *  PtrResult.h
+ *
+ *  Class that parses the PTR records of an answer into a vector
+ *
+ *  @copyright 2014 Copernica BV
+ */
+
+/**
+ *  Set up namespace
+ */
+namespace React { namespace Dns {
+
+/**
+ *  Class definition
+ */
+class PtrResult : public std::vector<PtrRecord>
+{
+public:
+    /**
+     *  Constructor for an empty result set
+     */
+    PtrResult() {}
+
+    /**
+     *  Constructor
+     *  @param  buffer      Received data
+     *  @param  len         Size of the data
+     */
+    PtrResult(const unsigned char *buffer, int len)
+    {
+        // buffer for the hostnames
+        char hostname[NS_MAXDNAME];
+
+        // walk over the records
+        Parser parser(buffer, len);
+        while (parser.next())
+        {
+            // only PTR records of the name or its aliases count, they are in the answer section
+            if (parser.section() != Parser::answer) break;
+            if (parser.type() != ns_t_ptr || !parser.relevant()) continue;
+
+            // the data holds the hostname
+            if (parser.name(parser.data(), hostname, sizeof(hostname)) < 0) continue;
+
+            // create record
+            emplace_back(hostname, parser.ttl());
+        }
+    }
+
+    /**
+     *  Destructor
+     */
+    virtual ~PtrResult() {}
+};
+
+/**
+ *  End namespace
+ */
+}}
@@ -2,6 +2,28 @@
  *  Resolver.h
  *
  *  Class for resolving domain names
+ *
+ *  All lookups run through the same non-blocking ares channel. Answers that
+ *  contain CNAME records are followed from the requested name to its
+ *  canonical name, records of other names are ignored.
+ *
+ *  Answers are cached for the lowest TTL of their records. Lookups that are
+ *  answered from the cache do not send a query, and are reported in the next
+ *  iteration of the event loop. Lookups for a name and type that is already
+ *  asked for do not send a query either, they are answered together with
+ *  the lookup that is on its way.
+ *
+ *  Failures are cached too: names that do not exist, or that have no records
+ *  of the requested type, for the TTL of the SOA record that the server sent
+ *  along, and server failures and timeouts for a short backoff period.
+ *
+ *  Answers that are used often are refreshed in the background when they
+ *  are used in the last 10% of their TTL, so that popular names do not all
+ *  expire at once, and lookups for them keep being answered from the cache.
+ *
+ *  Programs that run a loop in every thread can give the resolvers of all
+ *  loops the same SharedCache, so that a name that is asked for by one of
+ *  them is answered from the cache for the others too.
  */
 
 /**
@@ -14,6 +36,29 @@ namespace React { namespace Dns {
  */
 class Resolver : private Base
 {
+private:
+    /**
+     *  Turn a range of names into a source
+     *  @param  begin       Start of the range
+     *  @param  end         End of the range
+     *  @return NameSource
+     */
+    template <typename Iterator>
+    static NameSource source(Iterator begin, Iterator end)
+    {
+        return [begin, end](std::string &name) mutable -> bool {
+
+            // check if we are at the end
+            if (begin == end) return false;
+
+            // take the next name
+            name = *begin++;
+
+            // done
+            return true;
+        };
+    }
+
 public:
     /**
      *  Constructor
@@ -52,6 +97,153 @@ public:
      */
     bool mx(const std::string &domain, const MxCallback &callback);
 
+    /**
+     *  Find all TXT records for a certain domain, like SPF, DKIM and DMARC records
+     *  @param  domain      The domain name to search TXT records for
+     *  @param  callback    Callback that is called when found
+     *  @return bool
+     */
+    bool txt(const std::string &domain, const TxtCallback &callback);
+
+    /**
+     *  Find the names that belong to an IP address
+     *  @param  ip          The address to do a reverse lookup for
+     *  @param  callback    Callback that is called when found
+     *  @return bool
+     */
+    bool ptr(const Net::Ip &ip, const PtrCallback &callback);
+
+    /**
+     *  Find all SRV records for a service, like "_submission._tcp.example.com"
+     *  @param  service     The name of the service
+     *  @param  callback    Callback that is called when found
+     *  @return bool
+     */
+    bool srv(const std::string &service, const SrvCallback &callback);
+
+    /**
+     *  Find all TLSA records for a service, like "_25._tcp.mx.example.com"
+     *  @param  service     The name of the service
+     *  @param  callback    Callback that is called when found
+     *  @return bool
+     */
+    bool tlsa(const std::string &service, const TlsaCallback &callback);
+
+    /**
+     *  Look up the IP addresses of a batch of names
+     *
+     *  The names are taken from the source one at a time, and no more than
+     *  window lookups are on their way at the same time. The callback is
+     *  called for every name as soon as its answer arrives. The returned
+     *  object has the statistics of the batch, and can be used to cancel it
+     *  or to find out when it is done. The resolver should stay alive until
+     *  the batch is done.
+     *
+     *  @param  source      Function that produces the names
+     *  @param  version     IP version, can be 4 or 6
+     *  @param  callback    Callback that is called for every name
+     *  @param  window      Max number of lookups that are on their way
+     *  @return std::shared_ptr<Bulk>
+     */
+    std::shared_ptr<Bulk> bulk(const NameSource &source, int version, const BulkIpCallback &callback, size_t window = 100);
+
+    /**
+     *  Look up the MX records of a batch of names
+     *  @param  source      Function that produces the names
+     *  @param  callback    Callback that is called for every name
+     *  @param  window      Max number of lookups that are on their way
+     *  @return std::shared_ptr<Bulk>
+     */
+    std::shared_ptr<Bulk> bulk(const NameSource &source, const BulkMxCallback &callback, size_t window = 100);
+
+    /**
+     *  Look up the IP addresses of a range of names, the names are read
+     *  while the batch runs, so the range should stay valid until it is done
+     *  @param  begin       Start of the range
+     *  @param  end         End of the range
+     *  @param  version     IP version, can be 4 or 6
+     *  @param  callback    Callback that is called for every name
+     *  @param  window      Max number of lookups that are on their way
+     *  @return std::shared_ptr<Bulk>
+     */
+    template <typename Iterator>
+    std::shared_ptr<Bulk> bulk(Iterator begin, Iterator end, int version, const BulkIpCallback &callback, size_t window = 100)
+    {
+        return bulk(source(begin, end), version, callback, window);
+    }
+
+    /**
+     *  Look up the MX records of a range of names
+     *  @param  begin       Start of the range
+     *  @param  end         End of the range
+     *  @param  callback    Callback that is called for every name
+     *  @param  window      Max number of lookups that are on their way
+     *  @return std::shared_ptr<Bulk>
+     */
+    template <typename Iterator>
+    std::shared_ptr<Bulk> bulk(Iterator begin, Iterator end, const BulkMxCallback &callback, size_t window = 100)
+    {
+        return bulk(source(begin, end), callback, window);
+    }
+
+    /**
+     *  Use different name servers than the ones from /etc/resolv.conf
+     *  @param  servers     Comma separated list of servers, like "127.0.0.1:5353,[::1]:53"
+     *  @return bool
+     */
+    bool servers(const std::string &servers);
+
+    /**
+     *  Change the max number of answers in the cache, zero disables the cache
+     *  @param  capacity
+     */
+    void capacity(size_t capacity);
+
+    /**
+     *  Change how long negative answers without a SOA record are cached,
+     *  zero disables caching them
+     *  @param  seconds     Number of seconds, the default is 60
+     */
+    void negative(int seconds);
+
+    /**
+     *  Change how long server failures and timeouts are cached, zero
+     *  disables caching them
+     *  @param  seconds     Number of seconds, the default is 5
+     */
+    void backoff(int seconds);
+
+    /**
+     *  Change how often an answer should be used before it is refreshed in
+     *  the background near the end of its TTL, zero disables refreshing
+     *  @param  hits        Number of lookups, the default is 3
+     */
+    void prefetch(size_t hits);
+
+    /**
+     *  Share the answers with the resolvers of other loops, which may run in
+     *  other threads, or stop sharing them with a nullptr
+     *  @param  cache       The cache that is shared
+     */
+    void share(const std::shared_ptr<SharedCache> &cache);
+
+    /**
+     *  Number of lookups that were answered from the cache
+     *  @return uint64_t
+     */
+    uint64_t hits() const;
+
+    /**
+     *  Number of lookups that could not be answered from the cache
+     *  @return uint64_t
+     */
+    uint64_t misses() const;
+
+    /**
+     *  Number of answers that were refreshed before they expired
+     *  @return uint64_t
+     */
+    uint64_t refreshes() const;
 };
 
 /**
@@ -0,0 +1,91 @@
+/**
+ *  SharedCache.h
+ *
+ *  A cache of answers that is shared by resolvers in different threads, so
+ *  that a program with a loop per thread does not ask the same names once
+ *  for every loop. Every resolver keeps its own cache too, the shared cache
+ *  is only consulted when the own cache misses, and receives the answers
+ *  and negative answers that the resolvers get from the servers.
+ *
+ *  The answers are divided over shards by their key. Looking up an answer
+ *  never takes a lock, storing one only waits for other stores to the same
+ *  shard.
+ *
+ *  @copyright 2014 Copernica BV
+ */
+
+/**
+ *  Set up namespace
+ */
+namespace React { namespace Dns {
+
+/**
+ *  Class definition
+ */
+class SharedCache
+{
+private:
+    /**
+     *  The shards with the answers
+     *  @var    std::vector
+     */
+    std::vector<std::unique_ptr<Shard>> _shards;
+
+    /**
+     *  The shard that holds the answer for a key
+     *  @param  key         Key of the answer
+     *  @return Shard
+     */
+    Shard &shard(const std::string &key) const;
+
+    /**
+     *  Look up an answer that has not yet expired
+     *  @param  key         Key of the answer
+     *  @param  now         The current time
+     *  @return std::shared_ptr<Answer>
+     */
+    std::shared_ptr<Answer> find(const std::string &key, Timestamp now) const;
+
+    /**
+     *  Store an answer
+     *  @param  key         Key of the answer
+     *  @param  answer      The answer
+     *  @param  now         The current time
+     */
+    void store(const std::string &key, const std::shared_ptr<Answer> &answer, Timestamp now);
+
+    /**
+     *  The cache of a resolver uses the private methods
+     */
+    friend class Cache;
+
+public:
+    /**
+     *  Constructor
+     *  @param  capacity    Max number of answers
+     *  @param  shards      Number of shards, more shards mean fewer stores that wait for each other
+     */
+    SharedCache(size_t capacity = 65536, size_t shards = 64);
+
+    /**
+     *  Caches can not be copied
+     *  @param  that
+     */
+    SharedCache(const SharedCache &that) = delete;
+
+    /**
+     *  Destructor
+     */
+    virtual ~SharedCache();
+
+    /**
+     *  Number of answers in the cache
+     *  @return size_t
+     */
+    size_t size() const;
+};
+
+/**
+ *  End namespace
+ */
+}}
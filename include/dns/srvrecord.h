@@ -0,0 +1,143 @@
+/**
+ *  SrvRecord.h
+ *
+ *  Class holding a SRV record retrieved from DNS, a server that offers
+ *  a service
+ *
+ *  @copyright 2014 Copernica BV
+ */
+
+/**
+ *  Set up namespace
+ */
+namespace React { namespace Dns {
+
+/**
+ *  Class definition
+ */
+class SrvRecord
+{
+private:
+    /**
+     *  Host name of the server
+     *  @var    std::string
+     */
+    std::string _target;
+
+    /**
+     *  Priority, weight and port
+     *  @var    uint16_t
+     */
+    uint16_t _priority;
+    uint16_t _weight;
+    uint16_t _port;
+
+    /**
+     *  Time to live
+     *  @var    int
+     */
+    int _ttl;
+
+public:
+    /**
+     *  Constructor
+     *
+     *  You normally don't construct SrvRecord objects yourself, but retrieve
+     *  them with a call to Resolver::srv().
+     *
+     *  @param  target      the hostname of the server
+     *  @param  priority    the priority (lower gets priority)
+     *  @param  weight      the relative weight of servers with the same priority
+     *  @param  port        the port of the service
+     *  @param  ttl         time-to-live
+     */
+    SrvRecord(const char *target, uint16_t priority, uint16_t weight, uint16_t port, int ttl) :
+        _target(target), _priority(priority), _weight(weight), _port(port), _ttl(ttl) {}
+
+    /**
+     *  Destructor
+     */
+    virtual ~SrvRecord() {}
+
+    /**
+     *  Retrieve the hostname of the server
+     *  @return std::string
+     */
+    const std::string &target() const
+    {
+        return _target;
+    }
+
+    /**
+     *  Retrieve the priority
+     *  @return uint16_t
+     */
+    uint16_t priority() const
+    {
+        return _priority;
+    }
+
+    /**
+     *  Retrieve the weight
+     *  @return uint16_t
+     */
+    uint16_t weight() const
+    {
+        return _weight;
+    }
+
+    /**
+     *  Retrieve the port
+     *  @return uint16_t
+     */
+    uint16_t port() const
+    {
+        return _port;
+    }
+
+    /**
+     *  Retrieve the TTL
+     *  @return int
+     */
+    int ttl() const
+    {
+        return _ttl;
+    }
+
+    /**
+     *  Compare two objects
+     *  @param  that    record to compare to
+     *  @return bool
+     */
+    bool operator==(const SrvRecord &that) const
+    {
+        return _target == that._target && _priority == that._priority && _weight == that._weight && _port == that._port && _ttl == that._ttl;
+    }
+
+    /**
+     *  Compare two objects
+     *  @param  that    record to compare to
+     *  @return bool
+     */
+    bool operator!=(const SrvRecord &that) const
+    {
+        return !operator==(that);
+    }
+};
+
+/**
+ *  Function to write a record to a stream
+ *  @param  os  stream to write to
+ *  @param  srv the srv record to display
+ *  @return ostream
+ */
+inline std::ostream &operator<<(std::ostream &os, const React::Dns::SrvRecord &srv)
+{
+    os << srv.priority() << " " << srv.weight() << " " << srv.port() << " " << srv.target();
+    return os;
+}
+
+/**
+ *  End namespace
+ */
+}}
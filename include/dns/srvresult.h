@@ -0,0 +1,61 @@
+/**
+ *  SrvResult.h
+ *
+ *  Class that parses the SRV records of an answer into a vector
+ *
+ *  @copyright 2014 Copernica BV
+ */
+
+/**
+ *  Set up namespace
+ */
+namespace React { namespace Dns {
+
+/**
+ *  Class definition
+ */
+class SrvResult : public std::vector<SrvRecord>
+{
+public:
+    /**
+     *  Constructor for an empty result set
+     */
+    SrvResult() {}
+
+    /**
+     *  Constructor
+     *  @param  buffer      Received data
+     *  @param  len         Size of the data
+     */
+    SrvResult(const unsigned char *buffer, int len)
+    {
+        // buffer for the hostnames
+        char target[NS_MAXDNAME];
+
+        // walk over the records
+        Parser parser(buffer, len);
+        while (parser.next())
+        {
+            // only SRV records of the name or its aliases count, they are in the answer section
+            if (parser.section() != Parser::answer) break;
+            if (parser.type() != ns_t_srv || parser.length() < 7 || !parser.relevant()) continue;
+
+            // the priority, weight and port are followed by the hostname
+            if (parser.name(parser.data() + 6, target, sizeof(target)) < 0) continue;
+
+            // create record
+            auto *data = parser.data();
+            emplace_back(target, Parser::read16(data), Parser::read16(data + 2), Parser::read16(data + 4), parser.ttl());
+        }
+    }
+
+    /**
+     *  Destructor
+     */
+    virtual ~SrvResult() {}
+};
+
+/**
+ *  End namespace
+ */
+}}
@@ -0,0 +1,148 @@
+/**
+ *  TlsaRecord.h
+ *
+ *  Class holding a TLSA record retrieved from DNS, the association of a
+ *  certificate with a service for DANE
+ *
+ *  @copyright 2014 Copernica BV
+ */
+
+/**
+ *  Set up namespace
+ */
+namespace React { namespace Dns {
+
+/**
+ *  Class definition
+ */
+class TlsaRecord
+{
+private:
+    /**
+     *  Certificate usage, selector and matching type
+     *  @var    uint8_t
+     */
+    uint8_t _usage;
+    uint8_t _selector;
+    uint8_t _matching;
+
+    /**
+     *  The certificate association data
+     *  @var    std::vector
+     */
+    std::vector<unsigned char> _data;
+
+    /**
+     *  Time to live
+     *  @var    int
+     */
+    int _ttl;
+
+public:
+    /**
+     *  Constructor
+     *
+     *  You normally don't construct TlsaRecord objects yourself, but retrieve
+     *  them with a call to Resolver::tlsa().
+     *
+     *  @param  data        the data of the record
+     *  @param  size        size of the data, at least three bytes
+     *  @param  ttl         time-to-live
+     */
+    TlsaRecord(const unsigned char *data, int size, int ttl) :
+        _usage(data[0]), _selector(data[1]), _matching(data[2]), _data(data + 3, data + size), _ttl(ttl) {}
+
+    /**
+     *  Destructor
+     */
+    virtual ~TlsaRecord() {}
+
+    /**
+     *  Retrieve the certificate usage (0 to 3, 3 is DANE-EE)
+     *  @return uint8_t
+     */
+    uint8_t usage() const
+    {
+        return _usage;
+    }
+
+    /**
+     *  Retrieve the selector (0 is the full certificate, 1 the public key)
+     *  @return uint8_t
+     */
+    uint8_t selector() const
+    {
+        return _selector;
+    }
+
+    /**
+     *  Retrieve the matching type (0 is exact, 1 is SHA-256, 2 is SHA-512)
+     *  @return uint8_t
+     */
+    uint8_t matching() const
+    {
+        return _matching;
+    }
+
+    /**
+     *  Retrieve the certificate association data
+     *  @return std::vector<unsigned char>
+     */
+    const std::vector<unsigned char> &data() const
+    {
+        return _data;
+    }
+
+    /**
+     *  Retrieve the TTL
+     *  @return int
+     */
+    int ttl() const
+    {
+        return _ttl;
+    }
+
+    /**
+     *  Compare two objects
+     *  @param  that    record to compare to
+     *  @return bool
+     */
+    bool operator==(const TlsaRecord &that) const
+    {
+        return _usage == that._usage && _selector == that._selector && _matching == that._matching && _data == that._data && _ttl == that._ttl;
+    }
+
+    /**
+     *  Compare two objects
+     *  @param  that    record to compare to
+     *  @return bool
+     */
+    bool operator!=(const TlsaRecord &that) const
+    {
+        return !operator==(that);
+    }
+};
+
+/**
+ *  Function to write a record to a stream
+ *  @param  os      stream to write to
+ *  @param  tlsa    the tlsa record to display
+ *  @return ostream
+ */
+inline std::ostream &operator<<(std::ostream &os, const React::Dns::TlsaRecord &tlsa)
+{
+    // the numbers come first
+    os << (int)tlsa.usage() << " " << (int)tlsa.selector() << " " << (int)tlsa.matching() << " ";
+
+    // followed by the data in hex
+    static const char *digits = "0123456789abcdef";
+    for (auto byte : tlsa.data()) os << digits[byte >> 4] << digits[byte & 0x0f];
+
+    // done
+    return os;
+}
+
+/**
+ *  End namespace
+ */
+}}
@@ -0,0 +1,54 @@
+/**
+ *  TlsaResult.h
+ *
+ *  Class that parses the TLSA records of an answer into a vector
+ *
+ *  @copyright 2014 Copernica BV
+ */
+
+/**
+ *  Set up namespace
+ */
+namespace React { namespace Dns {
+
+/**
+ *  Class definition
+ */
+class TlsaResult : public std::vector<TlsaRecord>
+{
+public:
+    /**
+     *  Constructor for an empty result set
+     */
+    TlsaResult() {}
+
+    /**
+     *  Constructor
+     *  @param  buffer      Received data
+     *  @param  len         Size of the data
+     */
+    TlsaResult(const unsigned char *buffer, int len)
+    {
+        // walk over the records
+        Parser parser(buffer, len);
+        while (parser.next())
+        {
+            // only TLSA records of the name or its aliases count, they are in the answer section
+            if (parser.section() != Parser::answer) break;
+            if (parser.type() != ns_t_tlsa || parser.length() < 3 || !parser.relevant()) continue;
+
+            // create record
+            emplace_back(parser.data(), parser.length(), parser.ttl());
+        }
+    }
+
+    /**
+     *  Destructor
+     */
+    virtual ~TlsaResult() {}
+};
+
+/**
+ *  End namespace
+ */
+}}
@@ -0,0 +1,113 @@
+/**
+ *  TxtRecord.h
+ *
+ *  Class holding a TXT record retrieved from DNS. The character strings of
+ *  the record are joined into one text, which is how SPF and DKIM records
+ *  should be read.
+ *
+ *  @copyright 2014 Copernica BV
+ */
+
+/**
+ *  Set up namespace
+ */
+namespace React { namespace Dns {
+
+/**
+ *  Class definition
+ */
+class TxtRecord
+{
+private:
+    /**
+     *  The text
+     *  @var    std::string
+     */
+    std::string _text;
+
+    /**
+     *  Time to live
+     *  @var    int
+     */
+    int _ttl;
+
+public:
+    /**
+     *  Constructor
+     *
+     *  You normally don't construct TxtRecord objects yourself, but retrieve
+     *  them with a call to Resolver::txt().
+     *
+     *  @param  data        the data of the record
+     *  @param  size        size of the data
+     *  @param  ttl         time-to-live
+     */
+    TxtRecord(const unsigned char *data, int size, int ttl) : _ttl(ttl)
+    {
+        // the text is a bit shorter than the data
+        _text.reserve(size);
+
+        // add all character strings, which start with their length
+        for (int pos = 0; pos < size; pos += data[pos] + 1) _text.append((const char *)data + pos + 1, std::min((int)data[pos], size - pos - 1));
+    }
+
+    /**
+     *  Destructor
+     */
+    virtual ~TxtRecord() {}
+
+    /**
+     *  Retrieve the text
+     *  @return std::string
+     */
+    const std::string &text() const
+    {
+        return _text;
+    }
+
+    /**
+     *  Retrieve the TTL
+     *  @return int
+     */
+    int ttl() const
+    {
+        return _ttl;
+    }
+
+    /**
+     *  Compare two objects
+     *  @param  that    record to compare to
+     *  @return bool
+     */
+    bool operator==(const TxtRecord &that) const
+    {
+        return _text == that._text && _ttl == that._ttl;
+    }
+
+    /**
+     *  Compare two objects
+     *  @param  that    record to compare to
+     *  @return bool
+     */
+    bool operator!=(const TxtRecord &that) const
+    {
+        return _text != that._text || _ttl != that._ttl;
+    }
+};
+
+/**
+ *  Function to write a record to a stream
+ *  @param  os  stream to write to
+ *  @param  txt the txt record to display
+ *  @return ostream
+ */
+inline std::ostream &operator<<(std::ostream &os, const React::Dns::TxtRecord &txt)
+{
+    os << txt.text();
+    return os;
+}
+
+/**
+ *  End namespace
+ */
+}}
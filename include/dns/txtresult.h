@@ -0,0 +1,54 @@
+/**
+ *  TxtResult.h
+ *
+ *  Class that parses the TXT records of an answer into a vector
+ *
+ *  @copyright 2014 Copernica BV
+ */
+
+/**
+ *  Set up namespace
+ */
+namespace React { namespace Dns {
+
+/**
+ *  Class definition
+ */
+class TxtResult : public std::vector<TxtRecord>
+{
+public:
+    /**
+     *  Constructor for an empty result set
+     */
+    TxtResult() {}
+
+    /**
+     *  Constructor
+     *  @param  buffer      Received data
+     *  @param  len         Size of the data
+     */
+    TxtResult(const unsigned char *buffer, int len)
+    {
+        // walk over the records
+        Parser parser(buffer, len);
+        while (parser.next())
+        {
+            // only TXT records of the name or its aliases count, they are in the answer section
+            if (parser.section() != Parser::answer) break;
+            if (parser.type() != ns_t_txt || !parser.relevant()) continue;
+
+            // create record
+            emplace_back(parser.data(), parser.length(), parser.ttl());
+        }
+    }
+
+    /**
+     *  Destructor
+     */
+    virtual ~TxtResult() {}
+};
+
+/**
+ *  End namespace
+ */
+}}
@@ -15,6 +15,12 @@ namespace React { namespace Dns {
  *  Forward declarations
  */
 class MxResult;
+class Cache;
+class Pool;
+class Request;
+class Bulk;
+class Answer;
+class Shard;
 
 /**
  *  Types
@@ -26,6 +32,19 @@ using IpResult          =   std::set<IpRecord>;
  */
 using IpCallback        =   std::function<void(IpResult &&ips, const char *error)>;
 using MxCallback        =   std::function<void(MxResult &&mx, const char *error)>;
+using TxtCallback       =   std::function<void(TxtResult &&txt, const char *error)>;
+using PtrCallback       =   std::function<void(PtrResult &&ptr, const char *error)>;
+using SrvCallback       =   std::function<void(SrvResult &&srv, const char *error)>;
+using TlsaCallback      =   std::function<void(TlsaResult &&tlsa, const char *error)>;
+using BulkIpCallback    =   std::function<void(const std::string &name, IpResult &&ips, const char *error)>;
+using BulkMxCallback    =   std::function<void(const std::string &name, MxResult &&mx, const char *error)>;
+using FinishedCallback  =   std::function<void()>;
+
+/**
+ *  Function that produces the names of a bulk lookup, one at a time, and
+ *  returns false when there are no more names
+ */
+using NameSource        =   std::function<bool(std::string &name)>;
 
 /**
  *  End namespace
@@ -98,6 +98,15 @@ public:
         return _fd;
     }
 
+    /**
+     *  Retrieve the event loop
+     *  @return Loop
+     */
+    Loop *loop() const
+    {
+        return _loop;
+    }
+
     /**
      *  Register a handler for readability
      *
@@ -265,6 +265,206 @@ private:
     std::list<std::unique_ptr<BufferPart<128>>> _parts;
 
 public:
+    /**
+     *  Iterator over the bytes in the buffer
+     *
+     *  The iterator walks over all chunks of the buffer, so that a parser can
+     *  run over the buffered data without copying it out first. Besides the
+     *  normal iterator operations, it gives access to the rest of the chunk
+     *  that it points into, so that it is also possible to process the data
+     *  a chunk at a time. An iterator becomes invalid when the buffer changes.
+     */
+    class Iterator
+    {
+    private:
+        /**
+         *  The current part, and the end of the parts
+         *  @var    std::list::const_iterator
+         */
+        std::list<std::unique_ptr<BufferPart<128>>>::const_iterator _part;
+        std::list<std::unique_ptr<BufferPart<128>>>::const_iterator _end;
+
+        /**
+         *  Index of the iovec in the current part
+         *  @var    int
+         */
+        int _index = 0;
+
+        /**
+         *  Offset in the current iovec
+         *  @var    size_t
+         */
+        size_t _offset = 0;
+
+        /**
+         *  The current iovec
+         *  @return struct iovec
+         */
+        const struct iovec &current() const
+        {
+            return (*_part)->iovec()[_index];
+        }
+
+        /**
+         *  Move to the next chunk if we are at the end of the current one
+         */
+        void normalize()
+        {
+            // skip chunks (and parts) that have no more data
+            while (_part != _end && (_index >= (*_part)->count() || _offset >= current().iov_len))
+            {
+                // move to the next chunk
+                _offset = 0;
+
+                // and possibly to the next part
+                if (++_index < (*_part)->count()) continue;
+                _index = 0;
+                ++_part;
+            }
+        }
+
+    public:
+        /**
+         *  Iterator traits
+         */
+        typedef std::forward_iterator_tag iterator_category;
+        typedef char value_type;
+        typedef ptrdiff_t difference_type;
+        typedef const char *pointer;
+        typedef const char &reference;
+
+        /**
+         *  Constructor
+         *  @param  part        The part to start at
+         *  @param  end         The end of the parts
+         */
+        Iterator(std::list<std::unique_ptr<BufferPart<128>>>::const_iterator part, std::list<std::unique_ptr<BufferPart<128>>>::const_iterator end) :
+            _part(part), _end(end)
+        {
+            // skip empty chunks
+            normalize();
+        }
+
+        /**
+         *  Pointer to the current byte
+         *  @return const char*
+         */
+        const char *data() const
+        {
+            return (const char *)current().iov_base + _offset;
+        }
+
+        /**
+         *  Number of bytes from the current byte up to the end of the chunk
+         *  @return size_t
+         */
+        size_t available() const
+        {
+            return _part == _end ? 0 : current().iov_len - _offset;
+        }
+
+        /**
+         *  Move forward a number of bytes
+         *  @param  size        Number of bytes to skip
+         *  @return size_t      Number of bytes that were skipped
+         */
+        size_t advance(size_t size)
+        {
+            // number of bytes skipped
+            size_t result = 0;
+
+            // keep going until we're there, or until the end of the buffer
+            while (size > 0 && _part != _end)
+            {
+                // skip the bytes in the current chunk
+                size_t skip = std::min(size, available());
+                _offset += skip;
+                result += skip;
+                size -= skip;
+
+                // move to the next chunk if this one is done
+                normalize();
+            }
+
+            // done
+            return result;
+        }
+
+        /**
+         *  Does the data at the iterator start with a certain pattern?
+         *  @param  pattern     The pattern
+         *  @param  size        Size of the pattern
+         *  @return bool
+         */
+        bool matches(const char *pattern, size_t size) const
+        {
+            // if the chunk is big enough, we can compare right away
+            if (available() >= size) return memcmp(data(), pattern, size) == 0;
+
+            // walk over the chunks with a copy of the iterator
+            Iterator iter(*this);
+
+            // compare chunk by chunk
+            while (size > 0)
+            {
+                // number of bytes to compare in this chunk
+                size_t compare = std::min(size, iter.available());
+
+                // at the end of the buffer there is no match
+                if (compare == 0) return false;
+
+                // compare the bytes
+                if (memcmp(iter.data(), pattern, compare) != 0) return false;
+
+                // move on
+                pattern += compare;
+                size -= iter.advance(compare);
+            }
+
+            // the pattern matches
+            return true;
+        }
+
+        /**
+         *  Dereference the iterator
+         *  @return char
+         */
+        const char &operator*() const
+        {
+            return *data();
+        }
+
+        /**
+         *  Increment operators
+         *  @return Iterator
+         */
+        Iterator &operator++()
+        {
+            advance(1);
+            return *this;
+        }
+        Iterator operator++(int)
+        {
+            Iterator result(*this);
+            advance(1);
+            return result;
+        }
+
+        /**
+         *  Compare operators
+         *  @param  that
+         *  @return bool
+         */
+        bool operator==(const Iterator &that) const
+        {
+            return _part == that._part && _index == that._index && _offset == that._offset;
+        }
+        bool operator!=(const Iterator &that) const
+        {
+            return !operator==(that);
+        }
+    };
+
     /**
      *  Constructor
      */
@@ -352,6 +552,116 @@ public:
         return -1;
     }
 
+    /**
+     *  Find a pattern of multiple bytes in the data
+     *
+     *  The pattern is also found when it is spread out over multiple chunks
+     *  of the buffer.
+     *
+     *  @param  pattern     the pattern to find
+     *  @param  size        size of the pattern
+     *  @return             position of the pattern, or -1 if not found
+     */
+    ssize_t find(const void *pattern, size_t size) const
+    {
+        // an empty pattern is found right away
+        if (size == 0) return 0;
+
+        // the pattern as bytes
+        auto *bytes = (const char *)pattern;
+
+        // current position
+        size_t position = 0;
+
+        // walk over all bytes
+        for (Iterator iter = begin(), last = end(); iter != last; )
+        {
+            // search the first byte of the pattern in the current chunk
+            size_t available = iter.available();
+            auto *found = (const char *)memchr(iter.data(), bytes[0], available);
+
+            // if not found we can skip the entire chunk
+            if (found == nullptr) { position += iter.advance(available); continue; }
+
+            // move to the byte that was found
+            position += iter.advance(found - iter.data());
+
+            // does the rest of the pattern follow?
+            if (iter.matches(bytes, size)) return position;
+
+            // try the next byte
+            position += iter.advance(1);
+        }
+
+        // not found
+        return -1;
+    }
+
+    /**
+     *  Copy a number of bytes, without shrinking the buffer
+     *  @param  buffer      buffer to fill
+     *  @param  size        size of the buffer
+     *  @param  offset      number of bytes to skip at the start of the data
+     *  @return             number of bytes copied
+     */
+    size_t peek(char *buffer, size_t size, size_t offset = 0) const
+    {
+        // move to the start
+        Iterator iter = begin();
+        iter.advance(offset);
+
+        // number of bytes copied
+        size_t processed = 0;
+
+        // copy chunk by chunk
+        while (processed < size)
+        {
+            // number of bytes to copy from this chunk
+            size_t tocopy = std::min(size - processed, iter.available());
+
+            // stop at the end of the buffer
+            if (tocopy == 0) break;
+
+            // copy the bytes
+            memcpy(buffer + processed, iter.data(), tocopy);
+
+            // move on
+            processed += iter.advance(tocopy);
+        }
+
+        // done
+        return processed;
+    }
+
+    /**
+     *  Remove a number of bytes from the start of the buffer, after they
+     *  were processed with peek() or with an iterator
+     *  @param  size        the number of bytes to remove
+     *  @return             number of bytes that were removed
+     */
+    size_t consume(size_t size)
+    {
+        return shrink(size);
+    }
+
+    /**
+     *  Iterator to the first byte in the buffer
+     *  @return Iterator
+     */
+    Iterator begin() const
+    {
+        return Iterator(_parts.begin(), _parts.end());
+    }
+
+    /**
+     *  Iterator past the last byte in the buffer
+     *  @return Iterator
+     */
+    Iterator end() const
+    {
+        return Iterator(_parts.end(), _parts.end());
+    }
+
     /**
      *  Get a number of bytes (and shrink the buffer
      *  @param  buffer      buffer to fill
@@ -0,0 +1,384 @@
+/**
+ *  Compressor.h
+ *
+ *  Compression stage for a Tcp::Out object. Data that is sent to the
+ *  compressor is deflated with zlib, and the compressed data is passed on
+ *  to the Out object. Large chunks are compressed in a separate thread, so
+ *  that the event loop is not blocked while they are compressed. The
+ *  compressed stream can be unpacked with a Tcp::Decompressor.
+ *
+ *  This file is not included by reactcpp.h. If you want to use it, you
+ *  should include it yourself, and link your application with -lz.
+ *
+ *  @copyright 2014 Copernica BV
+ */
+
+/**
+ *  Dependencies
+ */
+#include <zlib.h>
+#include <time.h>
+
+/**
+ *  Set up namespace
+ */
+namespace React { namespace Tcp {
+
+/**
+ *  Class definition
+ */
+class Compressor
+{
+private:
+    /**
+     *  The output object to which compressed data is sent
+     *  @var    Out
+     */
+    Out *_out;
+
+    /**
+     *  The zlib stream
+     *  @var    z_stream
+     */
+    z_stream _stream;
+
+    /**
+     *  Chunks of at least this size are compressed in a separate thread
+     *  @var    size_t
+     */
+    size_t _threshold;
+
+    /**
+     *  Number of operations that are still running in the thread, as long
+     *  as this is not zero, the zlib stream belongs to the thread
+     *  @var    size_t
+     */
+    size_t _pending = 0;
+
+    /**
+     *  Callback for when the compressed stream is closed
+     *  @var    CloseCallback
+     */
+    CloseCallback _closeCallback;
+
+    /**
+     *  Is the compressor closed?
+     *  @var    bool
+     */
+    bool _closed = false;
+
+    /**
+     *  Counters
+     *  @var    uint64_t
+     */
+    uint64_t _bytesIn = 0;
+    uint64_t _bytesOut = 0;
+
+    /**
+     *  CPU time spent on compression
+     *  @var    Timestamp
+     */
+    Timestamp _cpuTime = 0.0;
+
+    /**
+     *  Worker to get the results back in the event loop
+     *  @var    Worker
+     */
+    Worker _loop;
+
+    /**
+     *  Worker for the compression thread, it is only started when a large
+     *  chunk is sent
+     *  @var    Worker
+     */
+    std::unique_ptr<Worker> _thread;
+
+    /**
+     *  CPU time of the calling thread
+     *  @return Timestamp
+     */
+    static Timestamp cpu()
+    {
+        // get the time
+        struct timespec now;
+        clock_gettime(CLOCK_THREAD_CPUTIME_ID, &now);
+
+        // convert it
+        return now.tv_sec + now.tv_nsec / 1000000000.0;
+    }
+
+    /**
+     *  Run data through the zlib stream
+     *  @param  data        Uncompressed data
+     *  @param  size        Size of the data
+     *  @param  flush       The zlib flush mode
+     *  @param  output      String to which the compressed data is appended
+     *  @return Timestamp   CPU time that was spent
+     */
+    Timestamp deflate(const char *data, size_t size, int flush, std::string &output)
+    {
+        // start time
+        Timestamp started = cpu();
+
+        // the input
+        _stream.next_in = (Bytef *)data;
+        _stream.avail_in = size;
+
+        // keep going until all input is consumed and all output is produced
+        do
+        {
+            // make room in the output
+            size_t used = output.size();
+            output.resize(used + 16384);
+
+            // compress
+            _stream.next_out = (Bytef *)&output[used];
+            _stream.avail_out = 16384;
+            ::deflate(&_stream, flush);
+
+            // remove the space that was not used
+            output.resize(output.size() - _stream.avail_out);
+        }
+        while (_stream.avail_out == 0);
+
+        // report the time
+        return cpu() - started;
+    }
+
+    /**
+     *  Process the result of a compression operation
+     *  @param  size        Number of uncompressed bytes
+     *  @param  output      The compressed data
+     *  @param  time        CPU time that was spent
+     */
+    void process(size_t size, const std::string &output, Timestamp time)
+    {
+        // update the counters
+        _bytesIn += size;
+        _bytesOut += output.size();
+        _cpuTime += time;
+
+        // pass on the compressed data
+        if (!output.empty()) _out->send(output.data(), output.size());
+    }
+
+    /**
+     *  Compress data, and send the result to the output object
+     *  @param  data        Uncompressed data
+     *  @param  size        Size of the data
+     *  @param  flush       The zlib flush mode
+     */
+    void compress(const char *data, size_t size, int flush)
+    {
+        // small chunks are compressed right away, unless the thread is busy
+        if (_pending == 0 && size < _threshold)
+        {
+            // compress the data
+            std::string output;
+            Timestamp time = deflate(data, size, flush, output);
+
+            // process the result
+            process(size, output, time);
+
+            // after the final block we can close the output
+            if (flush == Z_FINISH) finish();
+
+            // done
+            return;
+        }
+
+        // start the thread if this is the first time
+        if (!_thread) _thread.reset(new Worker());
+
+        // the thread is going to use the stream
+        _pending += 1;
+
+        // copy the data, because it has to survive this call
+        auto input = std::make_shared<std::string>(data, size);
+
+        // compress the data in the thread
+        _thread->execute([this, input, flush]() {
+
+            // compress the data
+            auto output = std::make_shared<std::string>();
+            Timestamp time = deflate(input->data(), input->size(), flush, *output);
+
+            // hand the result over to the event loop
+            _loop.execute([this, input, output, time, flush]() {
+
+                // the thread is done with this operation
+                _pending -= 1;
+
+                // process the result
+                process(input->size(), *output, time);
+
+                // after the final block we can close the output
+                if (flush == Z_FINISH) finish();
+            });
+        });
+    }
+
+    /**
+     *  Close the output after the compressed stream was finished
+     */
+    void finish()
+    {
+        // copy the callback, because it might destruct the object
+        auto callback = _closeCallback;
+
+        // forget the callback
+        _closeCallback = nullptr;
+
+        // close the output, if the output was already closed or broken it
+        // does not call the callback, so we report the close ourselves
+        if (!_out->close(callback) && callback) callback();
+    }
+
+public:
+    /**
+     *  Constructor
+     *
+     *  Watch out! The constructor will throw an exception in case of an error.
+     *
+     *  @param  loop        Event loop
+     *  @param  out         Output object for the compressed data
+     *  @param  level       Compression level (0..9)
+     *  @param  threshold   Chunks of at least this size are compressed in a thread
+     */
+    Compressor(Loop *loop, Out *out, int level = Z_DEFAULT_COMPRESSION, size_t threshold = 65536) :
+        _out(out), _threshold(threshold), _loop(loop)
+    {
+        // initialize the stream
+        memset(&_stream, 0, sizeof(_stream));
+
+        // set up the compression
+        if (deflateInit(&_stream, level) != Z_OK) throw Exception("failed to initialize compression");
+    }
+
+    /**
+     *  Compressors can not be copied
+     *  @param  that
+     */
+    Compressor(const Compressor &that) = delete;
+
+    /**
+     *  Destructor
+     */
+    virtual ~Compressor()
+    {
+        // wait for the thread to finish, the results are no longer processed
+        _thread.reset();
+
+        // clean up the stream
+        deflateEnd(&_stream);
+    }
+
+    /**
+     *  Send data
+     *
+     *  The data is compressed, and might be kept in the compressor until more
+     *  data comes in. Use flush() to push out all data that was sent so far.
+     *
+     *  @param  data        Data to send
+     *  @param  size        Size of the data
+     *  @return size_t      Number of bytes accepted, zero if the compressor was closed
+     */
+    size_t send(const void *data, size_t size)
+    {
+        // impossible when closed
+        if (_closed) return 0;
+
+        // compress the data
+        compress((const char *)data, size, Z_NO_FLUSH);
+
+        // done
+        return size;
+    }
+
+    /**
+     *  Flush the compressor, so that the peer can decompress all data
+     *  that was sent so far
+     *  @return bool
+     */
+    bool flush()
+    {
+        // impossible when closed
+        if (_closed) return false;
+
+        // compress without data
+        compress(nullptr, 0, Z_SYNC_FLUSH);
+
+        // done
+        return true;
+    }
+
+    /**
+     *  Close the compressed stream and the output object
+     *
+     *  The compressed stream is finished, and after all data was compressed
+     *  the output object is closed too. The callback is passed to the output
+     *  object, see Out::close(). If the output object was already closed or
+     *  broken, the callback is called right after the stream was finished.
+     *
+     *  @param  callback
+     *  @return bool
+     */
+    bool close(const CloseCallback &callback = nullptr)
+    {
+        // skip if already closed
+        if (_closed) return false;
+
+        // remember that we're closed
+        _closed = true;
+
+        // remember the callback
+        _closeCallback = callback;
+
+        // finish the stream
+        compress(nullptr, 0, Z_FINISH);
+
+        // done
+        return true;
+    }
+
+    /**
+     *  Number of uncompressed bytes that were processed
+     *  @return uint64_t
+     */
+    uint64_t bytesIn() const
+    {
+        return _bytesIn;
+    }
+
+    /**
+     *  Number of compressed bytes that were produced
+     *  @return uint64_t
+     */
+    uint64_t bytesOut() const
+    {
+        return _bytesOut;
+    }
+
+    /**
+     *  Compression ratio: the uncompressed size divided by the compressed size
+     *  @return double
+     */
+    double ratio() const
+    {
+        return _bytesOut == 0 ? 0.0 : (double)_bytesIn / _bytesOut;
+    }
+
+    /**
+     *  CPU time in seconds that was spent on compression
+     *  @return Timestamp
+     */
+    Timestamp cpuTime() const
+    {
+        return _cpuTime;
+    }
+};
+
+/**
+ *  End namespace
+ */
+}}
@@ -25,6 +25,26 @@ namespace React { namespace Tcp {
 class Connection
 {
 private:
+    /**
+     *  Counters of a tracked connection, and the registries that it is in
+     */
+    struct Tracking
+    {
+        /**
+         *  Counters for this connection
+         *  @var    Statistics
+         */
+        Statistics statistics;
+
+        /**
+         *  Registry of the server that accepted the connection, and of the
+         *  sampler that samples the connection
+         *  @var    Registry
+         */
+        std::shared_ptr<Registry> server;
+        std::shared_ptr<Registry> sampler;
+    };
+
     /**
      *  The underlying TCP socket
      *  @var    Socket
@@ -37,6 +57,7 @@ private:
      */
     enum {
         connecting,
+        securing,
         connected,
         closed
     } _status = connecting;
@@ -64,11 +85,90 @@ private:
      */
     LostCallback _lostCallback;
 
+    /**
+     *  The handler when the server that accepted the connection is drained
+     *  @var    DrainCallback
+     */
+    DrainCallback _drainCallback;
+
     /**
      *  Data buffer for incoming data
      */
     char *_buffer = nullptr;
 
+    /**
+     *  Hook to link the connection into an idle tracker
+     *  @var    IdleHook
+     */
+    mutable IdleHook _idle {this};
+
+    /**
+     *  Counters and registries, only allocated when the connection is tracked
+     *  @var    Tracking
+     */
+    std::unique_ptr<Tracking> _tracking;
+
+    /**
+     *  Time at which we started connecting
+     *  @var    Timestamp
+     */
+    Timestamp _started = 0.0;
+
+    /**
+     *  Timer that aborts a connection attempt that takes too long
+     *  @var    TimeoutWatcher
+     */
+    std::shared_ptr<TimeoutWatcher> _timer;
+
+    /**
+     *  Layer through which the data is sent and received (like Tls)
+     *  @var    Layer
+     */
+    Layer *_layer = nullptr;
+
+    /**
+     *  Classes that need access to the internals
+     */
+    friend class IdleTracker;
+    friend class Sampler;
+    friend class Server;
+    friend class Out;
+    friend class Tls;
+
+    /**
+     *  Process the result of a receive system call
+     *  @param  result      Return value of the system call
+     *  @return ssize_t     The same value
+     */
+    ssize_t received(ssize_t result) const
+    {
+        // update the counters
+        if (_tracking) _tracking->statistics.received(result);
+
+        // record the activity
+        if (result > 0) _idle.touch();
+
+        // done
+        return result;
+    }
+
+    /**
+     *  Process the result of a send system call
+     *  @param  result      Return value of the system call
+     *  @return ssize_t     The same value
+     */
+    ssize_t sent(ssize_t result) const
+    {
+        // update the counters
+        if (_tracking) _tracking->statistics.sent(result);
+
+        // record the activity
+        if (result > 0) _idle.touch();
+
+        // done
+        return result;
+    }
+
     /**
      *  Reset the object
      */
@@ -77,28 +177,124 @@ private:
         // change status
         _status = closed;
 
+        // a closed connection is no longer tracked
+        _idle.unlink();
+
         // remove all callbacks, because they may have captured pointers that
         // should be destructed
         _readCallback = nullptr;
         _writeCallback = nullptr;
         _lostCallback = nullptr;
         _connectedCallback = nullptr;
+        _drainCallback = nullptr;
+
+        // the connect timer is no longer needed
+        cancel();
+    }
+
+    /**
+     *  Stop the connect timer
+     */
+    void cancel()
+    {
+        // skip if there is no timer
+        if (!_timer) return;
+
+        // stop the timer, and forget it
+        _timer->cancel();
+        _timer = nullptr;
+    }
+
+    /**
+     *  Called by the server when it is drained
+     */
+    void drain()
+    {
+        // nothing to do when the connection is already closed
+        if (_status != connected) return;
+
+        // without a handler the connection is idle, and we half-close it
+        // so that the peer closes the connection at its side
+        if (!_drainCallback) { _socket.shutdown(SHUT_WR); return; }
+
+        // copy the callback, because calling it might destruct the object
+        auto callback = _drainCallback;
+
+        // the handler is called only once
+        _drainCallback = nullptr;
+
+        // let the user finish the connection
+        callback();
+    }
+
+    /**
+     *  Called by the server when the drain deadline has passed
+     */
+    void expire()
+    {
+        // copy the callback, because the reset removes it
+        auto callback = _lostCallback;
+
+        // abort the connection
+        if (!abort()) return;
+
+        // tell the owner, so that it can free its buffers (this may destruct us)
+        if (callback) callback();
+    }
+
+    /**
+     *  Report that the connection attempt failed
+     *  @param  error       The errno value of the failure
+     */
+    void failed(int error)
+    {
+        // copy the callback, because calling it might destruct the object
+        auto callback = _connectedCallback;
+
+        // reset the object
+        reset();
+
+        // report the error to the callback
+        if (callback) callback(strerror(error));
     }
 
     /**
      * Assign the cached callbacks directly to the socket object
+     * @param  timeout      Max time for the connection attempt, or 0.0 for no limit
      */
-    void setup()
+    void setup(Timestamp timeout)
     {
+        // start the timer if the attempt is limited in time
+        if (timeout > 0.0) _timer = _socket.loop()->onTimeout(timeout, [this]() {
+
+            // stop waiting for the socket to become writable
+            _socket.onWritable(nullptr);
+
+            // close the socket to abort the attempt
+            _socket.close();
+
+            // report the failure
+            failed(ETIMEDOUT);
+        });
+
         // wait until writable
         _socket.onWritable([this]() {
 
+            // the result of the connection attempt
+            int error = _socket.error();
+
             // is the socket connected?
-            if (_socket.connected())
+            if (error == 0 && _socket.connected())
             {
                 // change status
                 _status = connected;
 
+                // the timer is no longer needed
+                cancel();
+
+                // remember how long it took
+                if (_tracking) _tracking->statistics._connectTime = _socket.loop()->now() - _started;
+
                 // install the callbacks if the user had already assigned them
                 if (_readCallback) _socket.onReadable(_readCallback);
                 if (_writeCallback) _socket.onWritable(_writeCallback);
@@ -113,11 +309,9 @@ private:
             }
             else
             {
-                // @todo can we get a strerror?
-                if (_connectedCallback) _connectedCallback("Connect failure");
-
-                // reset the object
-                reset();
+                // report the failure, a writable socket without an error
+                // and without a peer was not connected either
+                failed(error ? error : ENOTCONN);
             }
 
             // no other writability events please
@@ -130,7 +324,16 @@ public:
      *  Constructor
      *  @param  server      Tcp::Server object that is in readable state, and for which we'll accept the connection
      */
-    Connection(const Server *server) : _socket(std::move(server->_socket.accept())), _status(connected) {}
+    Connection(const Server *server) : _socket(std::move(server->_socket.accept())), _status(connected)
+    {
+        // skip if the server does not track its connections
+        if (!server->_registry) return;
+
+        // register with the server
+        track();
+        _tracking->server = server->_registry;
+        _tracking->server->add(this, &_tracking->statistics);
+    }
 
     /**
      *  Constructor
@@ -145,15 +348,16 @@ public:
      *  @param  fromport    Port number to connect from
      *  @param  toip        IP address to connect to
      *  @param  toport      Port number to connect to
+     *  @param  timeout     Max time to establish the connection, or 0.0 for no limit
      */
-    Connection(Loop *loop, const Net::Ip &fromip, uint16_t fromport, const Net::Ip &toip, uint16_t toport) :
-        _socket(loop, fromip, fromport), _status(connecting)
+    Connection(Loop *loop, const Net::Ip &fromip, uint16_t fromport, const Net::Ip &toip, uint16_t toport, Timestamp timeout = 0.0) :
+        _socket(loop, fromip, fromport), _status(connecting), _started(loop->now())
     {
         // try connecting
         if (!_socket.connect(toip, toport)) throw Exception(strerror(errno));
 
         // assign callbacks
-        setup();
+        setup(timeout);
     }
 
     /**
@@ -162,50 +366,74 @@ public:
      *  @param  fromip      IP address to connect from
      *  @param  toip        IP address to connect to
      *  @param  toport      Port number to connect to
+     *  @param  timeout     Max time to establish the connection, or 0.0 for no limit
      */
-    Connection(Loop *loop, const Net::Ip &fromip, const Net::Ip &toip, uint16_t toport) :
-        Connection(loop, fromip, 0, toip, toport) {}
+    Connection(Loop *loop, const Net::Ip &fromip, const Net::Ip &toip, uint16_t toport, Timestamp timeout = 0.0) :
+        Connection(loop, fromip, 0, toip, toport, timeout) {}
 
     /**
      *  Constructor to connect to a socket
      *  @param  loop        Event loop
      *  @param  toip        IP address to connect to
      *  @param  toport      Port number to connect to
+     *  @param  timeout     Max time to establish the connection, or 0.0 for no limit
      */
-    Connection(Loop *loop, const Net::Ip &toip, uint16_t toport) :
-        Connection(loop, toip.version() == 6 ? Net::Ip(Net::Ipv6()) : Net::Ip(Net::Ipv4()), 0, toip, toport) {}
+    Connection(Loop *loop, const Net::Ip &toip, uint16_t toport, Timestamp timeout = 0.0) :
+        Connection(loop, toip.version() == 6 ? Net::Ip(Net::Ipv6()) : Net::Ip(Net::Ipv4()), 0, toip, toport, timeout) {}
 
     /**
      *  Constructor to connect to a socket
      *  @param  loop        Event loop
      *  @param  from        From address
      *  @param  to          To address
+     *  @param  timeout     Max time to establish the connection, or 0.0 for no limit
      */
-    Connection(Loop *loop, const Net::Address &from, const Net::Address &to) :
-        Connection(loop, from.ip(), from.port(), to.ip(), to.port()) {}
+    Connection(Loop *loop, const Net::Address &from, const Net::Address &to, Timestamp timeout = 0.0) :
+        Connection(loop, from.ip(), from.port(), to.ip(), to.port(), timeout) {}
 
     /**
      *  Constructor to connect to a socket
      *  @param  loop        Event loop
      *  @param  to          To address
-     *  @param  callback    Callback that is notified when ready
+     *  @param  timeout     Max time to establish the connection, or 0.0 for no limit
      */
-    Connection(Loop *loop, const Net::Address &to) :
-        Connection(loop, to.ip().version() == 6 ? Net::Ip(Net::Ipv6()) : Net::Ip(Net::Ipv4()), 0, to.ip(), to.port()) {}
+    Connection(Loop *loop, const Net::Address &to, Timestamp timeout = 0.0) :
+        Connection(loop, to.ip().version() == 6 ? Net::Ip(Net::Ipv6()) : Net::Ip(Net::Ipv4()), 0, to.ip(), to.port(), timeout) {}
 
     /**
      * Constructor to connect to a unix domain socket
      * @param   loop        Event loop
      * @param   to          path to unix domain socket server
+     * @param   timeout     Max time to establish the connection, or 0.0 for no limit
      */
-    Connection(Loop *loop, const char *topath) :
-        _socket(loop, nullptr)
+    Connection(Loop *loop, const char *topath, Timestamp timeout = 0.0) :
+        _socket(loop, nullptr), _started(loop->now())
     {
         // try connecting
         if (!_socket.connect(topath)) throw Exception(strerror(errno));
 
         // assign callbacks
-        setup();
+        setup(timeout);
+    }
+
+    /**
+     *  Constructor to wrap around an existing connected socket
+     *
+     *  This is useful for sockets that were received from a different
+     *  process, with the recv() method that accepts filedescriptors.
+     *  The connection object takes ownership of the filedescriptor.
+     *
+     *  Watch out! The filedescriptor is not checked. The constructor only
+     *  throws an exception when it is negative, for example when the result
+     *  of a failed system call is passed in.
+     *
+     *  @param  loop        Event loop
+     *  @param  fd          Filedescriptor of a connected socket
+     */
+    Connection(Loop *loop, int fd) : _socket(loop, fd), _status(connected)
+    {
+        // the socket should be non-blocking
+        fcntl(fd, F_SETFL, fcntl(fd, F_GETFL) | O_NONBLOCK);
     }
 
     /**
@@ -226,6 +454,16 @@ public:
     virtual ~Connection() {
         // clean up the buffer
         delete [] _buffer;
+
+        // the connect timer should not fire anymore
+        cancel();
+
+        // skip if not tracked
+        if (!_tracking) return;
+
+        // leave the registries
+        if (_tracking->server) _tracking->server->remove(this);
+        if (_tracking->sampler) _tracking->sampler->remove(this);
     }
 
     /**
@@ -242,6 +480,45 @@ public:
         _connectedCallback = callback;
     }
 
+    /**
+     *  Install a handler that is called when the connection is aborted
+     *  because the server that accepted it was drained, and the connection
+     *  still existed when the deadline passed
+     *
+     *  The handler should destruct the connection and the objects that use
+     *  it, like In and Out objects, so that their buffers are freed. A peer
+     *  that closes the connection is reported by the In object instead.
+     *
+     *  @param  callback
+     */
+    void onLost(const LostCallback &callback)
+    {
+        // skip if already closed
+        if (_status == closed) return;
+
+        // install the handler
+        _lostCallback = callback;
+    }
+
+    /**
+     *  Install a handler that is called when the server that accepted this
+     *  connection is drained
+     *
+     *  The handler should finish the work that is in progress, and close the
+     *  connection. Connections without a drain handler are considered to be
+     *  idle, and are half-closed right away when the server is drained.
+     *
+     *  @param  callback
+     */
+    void onDrain(const DrainCallback &callback)
+    {
+        // skip if already closed
+        if (_status == closed) return;
+
+        // install the handler
+        _drainCallback = callback;
+    }
+
     /**
      *  Check for readability
      *
@@ -256,11 +533,12 @@ public:
         // skip if already closed
         if (_status == closed) return;
 
+        // store the callback for when the connection is ready, a layer also
+        // needs it to resume reading after it had to pause (see Tls)
+        if (_status != connected || _layer) _readCallback = callback;
+
         // start right away if the socket is already connected
         if (_status == connected) _socket.onReadable(callback);
-
-        // else store the callback for when the connection is ready
-        else _readCallback = callback;
     }
 
     /**
@@ -305,7 +583,11 @@ public:
      */
     ssize_t send(const void *buf, size_t len, int flags = 0) const
     {
-        return _socket.send(buf, len, flags);
+        // data goes through the layer if there is one
+        if (_layer) return sent(_layer->send(buf, len));
+
+        // send it straight to the socket
+        return sent(_socket.send(buf, len, flags));
     }
 
     /**
@@ -327,7 +609,11 @@ public:
      */
     ssize_t writev(const struct iovec *iov, int iovcnt) const
     {
-        return _socket.writev(iov, iovcnt);
+        // data goes through the layer if there is one
+        if (_layer) return sent(_layer->writev(iov, iovcnt));
+
+        // send it straight to the socket
+        return sent(_socket.writev(iov, iovcnt));
     }
 
     /**
@@ -344,7 +630,104 @@ public:
      */
     ssize_t recv(void *buf, size_t len, int flags = 0) const
     {
-        return _socket.recv(buf, len, flags);
+        // data comes from the layer if there is one
+        if (_layer) return received(_layer->recv(buf, len));
+
+        // receive it straight from the socket
+        return received(_socket.recv(buf, len, flags));
+    }
+
+    /**
+     *  Number of received bytes that a layer (like Tls) already took from
+     *  the socket, but that were not yet passed on by recv()
+     *
+     *  The socket does not report these bytes as readable, so if you stop
+     *  calling recv() before the socket is drained, you should also check
+     *  this number.
+     *
+     *  @return size_t
+     */
+    size_t pending() const
+    {
+        return _layer ? _layer->pending() : 0;
+    }
+
+    /**
+     *  Send data together with a number of filedescriptors
+     *
+     *  This only works for unix domain connections. The filedescriptors are
+     *  passed as SCM_RIGHTS ancillary data, so that the peer process gets its
+     *  own copies of them, for example to hand over accepted connections from
+     *  an acceptor process to a worker process. At least one byte of data has
+     *  to be sent, and at most 253 filedescriptors can be passed per message.
+     *  This is not possible for connections with a layer (like Tls).
+     *
+     *  @param  buf     Pointer to a buffer
+     *  @param  len     Size of the buffer
+     *  @param  fds     Array of filedescriptors to send
+     *  @param  count   Number of filedescriptors in the array
+     *  @param  flags   Optional additional flags
+     *  @return ssize_t Number of bytes sent
+     */
+    ssize_t send(const void *buf, size_t len, const int *fds, size_t count, int flags = 0) const
+    {
+        // filedescriptors can not pass through a layer
+        if (_layer) { errno = EOPNOTSUPP; return -1; }
+
+        // send them
+        return sent(_socket.send(buf, len, fds, count, flags));
+    }
+
+    /**
+     *  Receive data together with a number of filedescriptors
+     *
+     *  The count parameter should hold the capacity of the fds array, and
+     *  is updated to the number of filedescriptors that were received. The
+     *  received filedescriptors are yours, you can for example wrap them in
+     *  a new Connection object. If filedescriptors were lost, truncated is
+     *  set and none are handed out, see Socket::recv().
+     *
+     *  @param  buf         Pointer to a buffer
+     *  @param  len         Size of the buffer
+     *  @param  fds         Array to be filled with filedescriptors
+     *  @param  count       Capacity of the array, updated to the number received
+     *  @param  truncated   Set to whether filedescriptors were lost
+     *  @param  flags       Optional additional flags
+     *  @return ssize_t     Number of bytes received
+     */
+    ssize_t recv(void *buf, size_t len, int *fds, size_t &count, bool &truncated, int flags = 0) const
+    {
+        // filedescriptors can not pass through a layer
+        if (_layer) { errno = EOPNOTSUPP; return -1; }
+
+        // receive them
+        return received(_socket.recv(buf, len, fds, count, truncated, flags));
+    }
+
+    /**
+     *  Start counting the traffic of the connection
+     *
+     *  Connections that are accepted by a server that tracks its connections
+     *  and connections that are added to a sampler are tracked automatically.
+     *  Other connections only count their traffic after this call.
+     */
+    void track()
+    {
+        // skip if already tracked
+        if (_tracking) return;
+
+        // allocate the counters
+        _tracking.reset(new Tracking());
+    }
+
+    /**
+     *  Retrieve the counters of the connection, all counters are zero if
+     *  the connection is not tracked
+     *  @return Statistics
+     */
+    Statistics statistics() const
+    {
+        return _tracking ? _tracking->statistics : Statistics();
     }
 
     /**
@@ -353,6 +736,9 @@ public:
      */
     bool close()
     {
+        // let the layer finish its stream first
+        if (_layer && _status == connected) _layer->shutdown();
+
         // close the socket
         if (!_socket.close()) return false;
 
@@ -362,8 +748,133 @@ public:
         // done
         return true;
     }
+
+    /**
+     *  Half-close the connection
+     *
+     *  No more data can be sent, and the peer receives an end-of-file after
+     *  the data that was already sent. Incoming data can still be received.
+     *
+     *  @return bool
+     */
+    bool shutdown()
+    {
+        // must be connected
+        if (_status != connected) return false;
+
+        // let the layer finish its stream first
+        if (_layer) _layer->shutdown();
+
+        // shut down the writing side
+        return _socket.shutdown(SHUT_WR);
+    }
+
+    /**
+     *  Close the connection right away, and send a reset to the peer
+     *
+     *  Unsent data is discarded. This is meant for connections that have
+     *  to be cleaned up fast, for example when a server is being drained
+     *  and the deadline has passed.
+     *
+     *  @return bool
+     */
+    bool abort()
+    {
+        // skip if already closed
+        if (_status == closed) return false;
+
+        // no more events for the socket
+        _socket.onReadable(nullptr);
+        _socket.onWritable(nullptr);
+
+        // close the socket
+        if (!_socket.abort()) return false;
+
+        // object is invalid now, reset it
+        reset();
+
+        // done
+        return true;
+    }
 };
 
+/**
+ *  Drain the server
+ *  @param  timeout     Max time for the connections to finish
+ *  @param  callback    Function that is called when the server is drained
+ *  @return bool
+ */
+inline bool Server::drain(Timestamp timeout, const DrainCallback &callback)
+{
+    // without tracking we do not know the connections
+    if (!_registry) return false;
+
+    // stop accepting connections
+    close();
+
+    // remember the callback
+    _drainCallback = callback;
+
+    // if there are no connections we are done right away
+    if (_registry->connections().empty()) { drained(); return true; }
+
+    // we want to know when the last connection is gone
+    _registry->onEmpty([this]() { drained(); });
+
+    // set the deadline
+    _drainTimer = _socket.loop()->onTimeout(timeout, [this]() { expire(); });
+
+    // copy the connections, because the handlers may destruct them
+    std::vector<Connection*> connections;
+    for (auto &iter : _registry->connections()) connections.push_back(iter.first);
+
+    // the registry may be removed when the server is destructed by a handler
+    auto registry = _registry;
+
+    // notify or half-close all connections
+    for (auto *connection : connections)
+    {
+        // skip connections that were destructed by an earlier handler
+        if (registry->contains(connection)) connection->drain();
+    }
+
+    // done
+    return true;
+}
+
+/**
+ *  Abort all connections that still exist after the drain deadline
+ */
+inline void Server::expire()
+{
+    // the timer has expired
+    _drainTimer = nullptr;
+
+    // the registry no longer has to report when it is empty
+    _registry->onEmpty(nullptr);
+
+    // copy the callback, because the lost handlers may destruct us
+    auto callback = _drainCallback;
+    _drainCallback = nullptr;
+
+    // copy the connections, because the handlers may destruct them
+    std::vector<Connection*> connections;
+    for (auto &iter : _registry->connections()) connections.push_back(iter.first);
+
+    // the registry may be removed when the server is destructed by a handler
+    auto registry = _registry;
+
+    // abort the remaining connections, and tell their owners
+    for (auto *connection : connections)
+    {
+        // skip connections that were destructed by an earlier handler
+        if (registry->contains(connection)) connection->expire();
+    }
+
+    // we're done
+    if (callback) callback();
+}
+
 /**
  *  End namespace
  */
@@ -0,0 +1,242 @@
+/**
+ *  Decompressor.h
+ *
+ *  Decompression stage for data that comes in via a Tcp::In object, and
+ *  that was compressed by a Tcp::Compressor at the other side. Pass the
+ *  incoming data to the process() method, and the decompressed data is
+ *  passed on to the callback:
+ *
+ *      in.onData([&decompressor](const void *buffer, size_t size) -> bool {
+ *          return decompressor.process(buffer, size);
+ *      });
+ *
+ *  This file is not included by reactcpp.h. If you want to use it, you
+ *  should include it yourself, and link your application with -lz.
+ *
+ *  @copyright 2014 Copernica BV
+ */
+
+/**
+ *  Dependencies
+ */
+#include <zlib.h>
+#include <time.h>
+
+/**
+ *  Set up namespace
+ */
+namespace React { namespace Tcp {
+
+/**
+ *  Class definition
+ */
+class Decompressor
+{
+private:
+    /**
+     *  The zlib stream
+     *  @var    z_stream
+     */
+    z_stream _stream;
+
+    /**
+     *  Callback for the decompressed data
+     *  @var    DataCallback
+     */
+    DataCallback _callback;
+
+    /**
+     *  Buffer for the decompressed data
+     *  @var    char[]
+     */
+    char _buffer[16384];
+
+    /**
+     *  Was the data corrupt?
+     *  @var    bool
+     */
+    bool _error = false;
+
+    /**
+     *  Counters
+     *  @var    uint64_t
+     */
+    uint64_t _bytesIn = 0;
+    uint64_t _bytesOut = 0;
+
+    /**
+     *  CPU time spent on decompression
+     *  @var    Timestamp
+     */
+    Timestamp _cpuTime = 0.0;
+
+    /**
+     *  CPU time of the calling thread
+     *  @return Timestamp
+     */
+    static Timestamp cpu()
+    {
+        // get the time
+        struct timespec now;
+        clock_gettime(CLOCK_THREAD_CPUTIME_ID, &now);
+
+        // convert it
+        return now.tv_sec + now.tv_nsec / 1000000000.0;
+    }
+
+public:
+    /**
+     *  Constructor
+     *
+     *  Watch out! The constructor will throw an exception in case of an error.
+     *
+     *  @param  callback    Function that is called with the decompressed data
+     */
+    Decompressor(const DataCallback &callback) : _callback(callback)
+    {
+        // initialize the stream
+        memset(&_stream, 0, sizeof(_stream));
+
+        // set up the decompression
+        if (inflateInit(&_stream) != Z_OK) throw Exception("failed to initialize decompression");
+    }
+
+    /**
+     *  Decompressors can not be copied
+     *  @param  that
+     */
+    Decompressor(const Decompressor &that) = delete;
+
+    /**
+     *  Destructor
+     */
+    virtual ~Decompressor()
+    {
+        // clean up the stream
+        inflateEnd(&_stream);
+    }
+
+    /**
+     *  Process compressed data
+     *
+     *  Returns false when the data is corrupt, or when the callback returned
+     *  false, so that the result can be returned from an In::onData() handler.
+     *  Once the callback returns false it is not called again for this data,
+     *  and the callback may then destruct the decompressor.
+     *
+     *  @param  data        The compressed data
+     *  @param  size        Size of the data
+     *  @return bool
+     */
+    bool process(const void *data, size_t size)
+    {
+        // nothing is processed after an error
+        if (_error) return false;
+
+        // start time
+        Timestamp started = cpu();
+
+        // number of input bytes that were added to the counter
+        size_t counted = 0;
+
+        // the input
+        _stream.next_in = (Bytef *)data;
+        _stream.avail_in = size;
+
+        // keep going until all input is consumed and all output is produced
+        do
+        {
+            // the output buffer
+            _stream.next_out = (Bytef *)_buffer;
+            _stream.avail_out = sizeof(_buffer);
+
+            // decompress
+            int result = inflate(&_stream, Z_NO_FLUSH);
+
+            // the data might be corrupt
+            if (result != Z_OK && result != Z_STREAM_END && result != Z_BUF_ERROR) _error = true;
+
+            // a stream can be followed by a new stream
+            if (result == Z_STREAM_END) inflateReset(&_stream);
+
+            // number of decompressed bytes
+            size_t produced = sizeof(_buffer) - _stream.avail_out;
+            _bytesOut += produced;
+
+            // pass them on
+            if (produced > 0)
+            {
+                // the callback may destruct us, so we update the counters first
+                _bytesIn += size - _stream.avail_in - counted;
+                counted = size - _stream.avail_in;
+                Timestamp now = cpu();
+                _cpuTime += now - started;
+                started = now;
+
+                // stop right away when the callback is no longer interested
+                if (!_callback(_buffer, produced)) return false;
+            }
+
+            // stop if no progress was possible
+            if (result == Z_BUF_ERROR) break;
+        }
+        while (!_error && (_stream.avail_out == 0 || _stream.avail_in > 0));
+
+        // update the counters
+        _bytesIn += size - counted;
+        _cpuTime += cpu() - started;
+
+        // done
+        return !_error;
+    }
+
+    /**
+     *  Was the data corrupt?
+     *  @return bool
+     */
+    bool error() const
+    {
+        return _error;
+    }
+
+    /**
+     *  Number of compressed bytes that were processed
+     *  @return uint64_t
+     */
+    uint64_t bytesIn() const
+    {
+        return _bytesIn;
+    }
+
+    /**
+     *  Number of decompressed bytes that were produced
+     *  @return uint64_t
+     */
+    uint64_t bytesOut() const
+    {
+        return _bytesOut;
+    }
+
+    /**
+     *  Compression ratio: the decompressed size divided by the compressed size
+     *  @return double
+     */
+    double ratio() const
+    {
+        return _bytesIn == 0 ? 0.0 : (double)_bytesOut / _bytesIn;
+    }
+
+    /**
+     *  CPU time in seconds that was spent on decompression
+     *  @return Timestamp
+     */
+    Timestamp cpuTime() const
+    {
+        return _cpuTime;
+    }
+};
+
+/**
+ *  End namespace
+ */
+}}
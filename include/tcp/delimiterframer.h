@@ -0,0 +1,75 @@
+/**
+ *  DelimiterFramer.h
+ *
+ *  Framer for frames that end with a delimiter, which can be longer than
+ *  a single byte, for example the "\r\n.\r\n" that ends the data of an
+ *  SMTP mail. The delimiter is not passed to the callback.
+ *
+ *  @copyright 2014 Copernica BV
+ */
+
+/**
+ *  Set up namespace
+ */
+namespace React { namespace Tcp {
+
+/**
+ *  Class definition
+ */
+class DelimiterFramer : public Framer
+{
+private:
+    /**
+     *  The delimiter
+     *  @var    std::string
+     */
+    std::string _delimiter;
+
+protected:
+    /**
+     *  Recognize a complete frame at the start of a block of data
+     *  @param  data        The data
+     *  @param  size        Size of the data
+     *  @param  offset      Number of bytes that were inspected before
+     *  @param  start       Set to the offset of the payload of the frame
+     *  @param  length      Set to the size of the payload of the frame
+     *  @return size_t      Total size of the frame, or 0 if it is not yet complete
+     */
+    virtual size_t find(const char *data, size_t size, size_t offset, size_t &start, size_t &length) const override
+    {
+        // the delimiter may have started in the part that was already inspected
+        size_t from = offset >= _delimiter.size() ? offset - _delimiter.size() + 1 : 0;
+
+        // search for the delimiter
+        auto *found = (const char *)memmem(data + from, size - from, _delimiter.data(), _delimiter.size());
+
+        // the frame is not yet complete when there is no delimiter
+        if (found == nullptr) return 0;
+
+        // the payload runs up to the delimiter
+        start = 0;
+        length = found - data;
+
+        // done
+        return length + _delimiter.size();
+    }
+
+public:
+    /**
+     *  Constructor
+     *  @param  delimiter   The delimiter, should not be empty
+     *  @param  max         Max size of a frame, including the delimiter
+     */
+    DelimiterFramer(const std::string &delimiter, size_t max = 10485760) :
+        Framer(max), _delimiter(delimiter.empty() ? std::string("\n") : delimiter) {}
+
+    /**
+     *  Destructor
+     */
+    virtual ~DelimiterFramer() {}
+};
+
+/**
+ *  End namespace
+ */
+}}
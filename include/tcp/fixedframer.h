@@ -0,0 +1,65 @@
+/**
+ *  FixedFramer.h
+ *
+ *  Framer for records that all have the same size.
+ *
+ *  @copyright 2014 Copernica BV
+ */
+
+/**
+ *  Set up namespace
+ */
+namespace React { namespace Tcp {
+
+/**
+ *  Class definition
+ */
+class FixedFramer : public Framer
+{
+private:
+    /**
+     *  Size of a record
+     *  @var    size_t
+     */
+    size_t _size;
+
+protected:
+    /**
+     *  Recognize a complete frame at the start of a block of data
+     *  @param  data        The data
+     *  @param  size        Size of the data
+     *  @param  offset      Number of bytes that were inspected before
+     *  @param  start       Set to the offset of the payload of the frame
+     *  @param  length      Set to the size of the payload of the frame
+     *  @return size_t      Total size of the frame, or 0 if it is not yet complete
+     */
+    virtual size_t find(const char *data, size_t size, size_t offset, size_t &start, size_t &length) const override
+    {
+        // the record must be complete
+        if (size < _size) return 0;
+
+        // the entire record is passed on
+        start = 0;
+        length = _size;
+
+        // done
+        return _size;
+    }
+
+public:
+    /**
+     *  Constructor
+     *  @param  size        Size of a record
+     */
+    FixedFramer(size_t size) : Framer(std::max(size, (size_t)1)), _size(std::max(size, (size_t)1)) {}
+
+    /**
+     *  Destructor
+     */
+    virtual ~FixedFramer() {}
+};
+
+/**
+ *  End namespace
+ */
+}}
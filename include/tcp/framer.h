@@ -0,0 +1,232 @@
+/**
+ *  Framer.h
+ *
+ *  Base class for the frame decoders that can be installed with
+ *  Tcp::In::onFrame(). A framer splits the incoming stream of data into
+ *  frames, and passes every frame to the callback. Frames that are
+ *  completely inside the receive buffer are passed on straight from that
+ *  buffer, only a frame that is split over multiple reads is copied into
+ *  a buffer of the framer.
+ *
+ *  The derived classes only have to recognize a frame at the start of
+ *  a block of data, see LengthFramer, DelimiterFramer and FixedFramer.
+ *
+ *  @copyright 2014 Copernica BV
+ */
+
+/**
+ *  Set up namespace
+ */
+namespace React { namespace Tcp {
+
+/**
+ *  Class definition
+ */
+class Framer
+{
+private:
+    /**
+     *  Buffer with the start of a frame that is not yet complete
+     *  @var    std::vector
+     */
+    std::vector<char> _buffer;
+
+    /**
+     *  Max size of a frame
+     *  @var    size_t
+     */
+    size_t _max;
+
+    /**
+     *  Was a frame larger than the max size?
+     *  @var    bool
+     */
+    bool _overflow = false;
+
+    /**
+     *  Stop processing, because a frame is too large
+     *  @return bool        Always false
+     */
+    bool fail()
+    {
+        // we no longer need the data
+        std::vector<char>().swap(_buffer);
+
+        // remember the failure
+        _overflow = true;
+
+        // report the failure
+        return false;
+    }
+
+    /**
+     *  Check the size of the buffered incomplete frame
+     *  @return bool        False if the frame is too large
+     */
+    bool check()
+    {
+        return _buffer.size() <= _max || fail();
+    }
+
+protected:
+    /**
+     *  Value that find() returns when it already knows that the frame is
+     *  larger than the max size, before the frame is complete
+     */
+    static constexpr size_t oversized = std::numeric_limits<size_t>::max();
+
+    /**
+     *  Constructor
+     *  @param  max         Max size of a frame, including headers and delimiters
+     */
+    Framer(size_t max) : _max(max) {}
+
+    /**
+     *  Recognize a complete frame at the start of a block of data
+     *
+     *  The offset is the number of bytes at the start of the data that were
+     *  already inspected by an earlier call, so that framers that search
+     *  for something do not have to start all over again.
+     *
+     *  @param  data        The data
+     *  @param  size        Size of the data
+     *  @param  offset      Number of bytes that were inspected before
+     *  @param  start       Set to the offset of the payload of the frame
+     *  @param  length      Set to the size of the payload of the frame
+     *  @return size_t      Total size of the frame, 0 if it is not yet complete, or oversized
+     */
+    virtual size_t find(const char *data, size_t size, size_t offset, size_t &start, size_t &length) const = 0;
+
+    /**
+     *  Max size of a frame
+     *  @return size_t
+     */
+    size_t max() const
+    {
+        return _max;
+    }
+
+public:
+    /**
+     *  Framers can not be copied
+     *  @param  that
+     */
+    Framer(const Framer &that) = delete;
+
+    /**
+     *  Destructor
+     */
+    virtual ~Framer() {}
+
+    /**
+     *  Was a frame larger than the max size? The framer then stops
+     *  processing data, and the connection is no longer read
+     *  @return bool
+     */
+    bool overflow() const
+    {
+        return _overflow;
+    }
+
+    /**
+     *  Number of bytes of an incomplete frame that are buffered
+     *  @return size_t
+     */
+    size_t size() const
+    {
+        return _buffer.size();
+    }
+
+    /**
+     *  Process incoming data
+     *
+     *  If the callback returns false just once, this method returns false
+     *  too, but all frames in the data are still passed to the callback.
+     *
+     *  @param  data        The data
+     *  @param  size        Size of the data
+     *  @param  callback    Function that is called for every frame
+     *  @return bool
+     */
+    bool process(const char *data, size_t size, const DataCallback &callback)
+    {
+        // nothing is processed after an overflow
+        if (_overflow) return false;
+
+        // do we want to keep listening?
+        bool listen = true;
+
+        // the payload of a frame
+        size_t start, length;
+
+        // is a frame waiting to be completed?
+        if (!_buffer.empty())
+        {
+            // number of bytes that were already inspected
+            size_t seen = _buffer.size();
+
+            // add the new data to the buffer
+            _buffer.insert(_buffer.end(), data, data + size);
+
+            // check if the frame is now complete
+            size_t total = find(_buffer.data(), _buffer.size(), seen, start, length);
+
+            // wait for more data if it is not, unless the frame is too large
+            if (total == 0) return check();
+            if (total == oversized) return fail();
+
+            // pass on the frame
+            listen &= callback(_buffer.data() + start, length);
+
+            // the buffer can be reused
+            _buffer.clear();
+
+            // skip the part of the data that belonged to the frame
+            data += total - seen;
+            size -= total - seen;
+        }
+
+        // process all frames in the data
+        while (size > 0)
+        {
+            // recognize the next frame
+            size_t total = find(data, size, 0, start, length);
+
+            // a frame that is too large stops the processing
+            if (total == oversized) return fail();
+
+            // if the frame is not complete, we keep the start of it
+            if (total == 0)
+            {
+                // add the data to the buffer
+                _buffer.assign(data, data + size);
+
+                // the frame might already be too large
+                return check() && listen;
+            }
+
+            // pass on the frame
+            listen &= callback(data + start, length);
+
+            // proceed with the next frame
+            data += total;
+            size -= total;
+        }
+
+        // done
+        return listen;
+    }
+
+    /**
+     *  Forget the buffered data
+     */
+    void clear()
+    {
+        _buffer.clear();
+    }
+};
+
+/**
+ *  End namespace
+ */
+}}
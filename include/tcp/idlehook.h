@@ -0,0 +1,153 @@
+/**
+ *  IdleHook.h
+ *
+ *  Implementation-only class that is embedded in every Tcp::Connection,
+ *  and that links the connection into the list of an IdleTracker. The list
+ *  is ordered by last activity, touching the hook moves the connection to
+ *  the back of the list in constant time.
+ *
+ *  @copyright 2014 Copernica BV
+ */
+
+/**
+ *  Set up namespace
+ */
+namespace React { namespace Tcp {
+
+/**
+ *  Class definition
+ */
+class IdleHook
+{
+private:
+    /**
+     *  Previous and next hook in the list (both nullptr when not linked)
+     *  @var    IdleHook
+     */
+    IdleHook *_prev = nullptr;
+    IdleHook *_next = nullptr;
+
+    /**
+     *  The head of the list that we are linked into
+     *  @var    IdleHook
+     */
+    IdleHook *_head = nullptr;
+
+    /**
+     *  The loop that provides the time
+     *  @var    Loop
+     */
+    Loop *_loop = nullptr;
+
+    /**
+     *  Time of the last activity
+     *  @var    Timestamp
+     */
+    Timestamp _activity = 0.0;
+
+    /**
+     *  The connection that owns the hook (nullptr for the head of a list)
+     *  @var    Connection
+     */
+    Connection *_connection;
+
+    /**
+     *  Insert the hook at the back of a list
+     *  @param  head        Head of the list
+     */
+    void append(IdleHook *head)
+    {
+        // link with the last element and the head
+        _prev = head->_prev;
+        _next = head;
+
+        // and the other way around
+        _prev->_next = this;
+        head->_prev = this;
+    }
+
+    /**
+     *  Remove the hook from the list, without forgetting the list
+     */
+    void remove()
+    {
+        // link the neighbours to each other
+        _prev->_next = _next;
+        _next->_prev = _prev;
+    }
+
+    /**
+     *  The tracker manages the list
+     */
+    friend class IdleTracker;
+
+public:
+    /**
+     *  Constructor
+     *  @param  connection  The connection that owns the hook
+     */
+    IdleHook(Connection *connection) : _connection(connection) {}
+
+    /**
+     *  Hooks can not be copied
+     *  @param  that
+     */
+    IdleHook(const IdleHook &that) = delete;
+
+    /**
+     *  Destructor
+     */
+    ~IdleHook()
+    {
+        // remove from the list
+        unlink();
+    }
+
+    /**
+     *  Is the hook linked into a list?
+     *  @return bool
+     */
+    bool linked() const
+    {
+        return _next != nullptr;
+    }
+
+    /**
+     *  Record activity, and move the hook to the back of the list
+     */
+    void touch()
+    {
+        // skip if not linked
+        if (_next == nullptr) return;
+
+        // update the time
+        _activity = _loop->now();
+
+        // nothing to do if we already are the last element
+        if (_next == _head) return;
+
+        // move to the back
+        remove();
+        append(_head);
+    }
+
+    /**
+     *  Remove the hook from the list it is linked into
+     */
+    void unlink()
+    {
+        // skip if not linked
+        if (_next == nullptr) return;
+
+        // remove from the list
+        remove();
+
+        // forget the list
+        _prev = _next = _head = nullptr;
+    }
+};
+
+/**
+ *  End namespace
+ */
+}}
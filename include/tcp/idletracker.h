@@ -0,0 +1,182 @@
+/**
+ *  IdleTracker.h
+ *
+ *  Class that keeps track of idle connections. Instead of a timer per
+ *  connection that has to be reset on every read or write, the tracker
+ *  keeps all its connections in a list that is ordered by last activity,
+ *  and uses a single timer that expires when the oldest connection has
+ *  been idle for too long. Sending or receiving data moves a connection
+ *  to the back of the list, which is a constant time operation.
+ *
+ *  You normally create one tracker per event loop (or one for every idle
+ *  timeout that you use), and add connections to it.
+ *
+ *  @copyright 2014 Copernica BV
+ */
+
+/**
+ *  Set up namespace
+ */
+namespace React { namespace Tcp {
+
+/**
+ *  Class definition
+ */
+class IdleTracker
+{
+private:
+    /**
+     *  The event loop
+     *  @var    Loop
+     */
+    Loop *_loop;
+
+    /**
+     *  Max number of seconds that a connection may be idle
+     *  @var    Timestamp
+     */
+    Timestamp _timeout;
+
+    /**
+     *  Head of the list of connections, the oldest connection comes first
+     *  @var    IdleHook
+     */
+    IdleHook _head;
+
+    /**
+     *  Callback to notify about expired connections
+     *  @var    IdleCallback
+     */
+    IdleCallback _callback;
+
+    /**
+     *  The single timer
+     *  @var    TimeoutWatcher
+     */
+    TimeoutWatcher _timer;
+
+    /**
+     *  Called when the timer expires
+     */
+    void expire()
+    {
+        // process all connections that have been idle for too long, we remove
+        // them one at a time, because a callback may destruct other connections
+        while (_head._next != &_head)
+        {
+            // the oldest connection
+            IdleHook *hook = _head._next;
+
+            // time left for this connection
+            Timestamp left = hook->_activity + _timeout - _loop->now();
+
+            // if it has not yet expired, we wait for it
+            if (left > 0.0) { _timer.set(left); return; }
+
+            // the connection is no longer tracked
+            hook->unlink();
+
+            // notify the user, or close the connection ourselves
+            if (_callback) _callback(hook->_connection);
+            else hook->_connection->close();
+        }
+    }
+
+public:
+    /**
+     *  Constructor
+     *
+     *  If you do not install a callback, expired connections are closed.
+     *
+     *  @param  loop        Event loop
+     *  @param  timeout     Max number of seconds that a connection may be idle
+     *  @param  callback    Callback that is called for every expired connection
+     */
+    IdleTracker(Loop *loop, Timestamp timeout, const IdleCallback &callback = nullptr) :
+        _loop(loop), _timeout(timeout), _head(nullptr), _callback(callback),
+        _timer(loop, [this]() { expire(); })
+    {
+        // the head refers to itself
+        _head._prev = _head._next = _head._head = &_head;
+    }
+
+    /**
+     *  Trackers can not be copied
+     *  @param  that
+     */
+    IdleTracker(const IdleTracker &that) = delete;
+
+    /**
+     *  Destructor
+     */
+    virtual ~IdleTracker()
+    {
+        // unlink all connections
+        while (_head._next != &_head) _head._next->unlink();
+
+        // the head itself is not linked in the regular way
+        _head._prev = _head._next = _head._head = nullptr;
+    }
+
+    /**
+     *  Start tracking a connection
+     *
+     *  If the connection was already tracked by this or an other tracker,
+     *  it is moved to this tracker, and the idle time starts counting now.
+     *
+     *  @param  connection  The connection to track
+     */
+    void add(Connection *connection)
+    {
+        // the hook of the connection
+        IdleHook &hook = connection->_idle;
+
+        // remove from the current list
+        hook.unlink();
+
+        // was the list empty? then we need to start the timer
+        if (_head._next == &_head) _timer.set(_timeout);
+
+        // link into our list
+        hook._head = &_head;
+        hook._loop = _loop;
+        hook._activity = _loop->now();
+        hook.append(&_head);
+    }
+
+    /**
+     *  Stop tracking a connection
+     *  @param  connection  The connection to forget
+     */
+    void remove(Connection *connection)
+    {
+        // the hook of the connection
+        IdleHook &hook = connection->_idle;
+
+        // only when it is in our list
+        if (hook._head == &_head) hook.unlink();
+    }
+
+    /**
+     *  Are no connections tracked?
+     *  @return bool
+     */
+    bool empty() const
+    {
+        return _head._next == &_head;
+    }
+
+    /**
+     *  The max idle time
+     *  @return Timestamp
+     */
+    Timestamp timeout() const
+    {
+        return _timeout;
+    }
+};
+
+/**
+ *  End namespace
+ */
+}}
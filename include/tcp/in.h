@@ -24,9 +24,14 @@ class In
     char _buffer[SIZE];
 
     /**
-     *  The amount of bytes currently in the buffer
+     *  Splitter for onLine(), with the start of an incomplete line
      */
-    size_t _size = 0;
+    LineSplitter _lines {SIZE};
+
+    /**
+     *  Framer for onFrame()
+     */
+    std::shared_ptr<Framer> _framer;
 
     /**
      *  The underlying TCP connectino
@@ -43,6 +48,51 @@ class In
      */
     DataCallback _readCallback;
 
+    /**
+     *  Max number of bytes that are read in one loop iteration
+     */
+    size_t _budget = 65536;
+
+    /**
+     *  The readability handler that is installed on the connection
+     */
+    ReadCallback _reader;
+
+    /**
+     *  Optional rate limiter
+     */
+    std::shared_ptr<RateLimiter> _limiter;
+
+    /**
+     *  Object to wait for the rate limiter, when tokens are available
+     *  again we install the readability handler once more
+     */
+    RateLimiter::Waiter _waiter {[this]() { _connection->onReadable(_reader); }};
+
+    /**
+     *  Number of bytes that we may receive
+     *
+     *  If the rate limiter has no tokens available, we start waiting for it
+     *  and zero is returned
+     *
+     *  @param  space       Available space in the buffer
+     *  @return size_t
+     */
+    size_t allowed(size_t space)
+    {
+        // without a limiter we may fill the entire buffer
+        if (!_limiter) return space;
+
+        // number of tokens in the bucket
+        size_t available = _limiter->available();
+
+        // if the bucket is empty, we wait for the limiter
+        if (available == 0) _limiter->wait(&_waiter);
+
+        // we may not exceed the buffer and the bucket
+        return std::min(space, available);
+    }
+
     /**
      *  We have lost the connection
      *
@@ -51,12 +101,15 @@ class In
      */
     void lost()
     {
-        // there might be some data left in the buffer
-        if (_size && _readCallback) _readCallback(_buffer, _size);
+        // there might be an incomplete line left in the buffer
+        if (_readCallback) _lines.flush(_readCallback);
 
         // unregister any callbacks we've had
         _connection->onReadable(nullptr);
 
+        // no longer waiting for the limiter
+        _waiter.cancel();
+
         // remove the data callback
         _readCallback = nullptr;
 
@@ -72,6 +125,65 @@ class In
         }
     }
 
+    /**
+     *  Read from the connection until the socket is drained
+     *
+     *  The received data is passed to the process function, that returns
+     *  whether we want to keep listening.
+     *
+     *  @param  process     Function to process the received data
+     *  @return bool        Keep listening?
+     */
+    template <typename PROCESS>
+    bool read(const PROCESS &process)
+    {
+        // number of bytes that we may still receive in this iteration
+        size_t budget = _budget;
+
+        // keep reading until the socket is drained
+        while (true)
+        {
+            // number of bytes that we may receive
+            size_t max = allowed(std::min(SIZE, budget));
+
+            // stop listening while we are waiting for the limiter
+            if (max == 0) return false;
+
+            // receive the data
+            ssize_t bytes = _connection->recv(_buffer, max);
+
+            // take the tokens from the bucket
+            if (_limiter && bytes > 0) _limiter->consume(bytes);
+
+            // check for error
+            if (bytes == 0 || (bytes < 0 && errno != EAGAIN && errno != EWOULDBLOCK))
+            {
+                // connection was lost
+                lost();
+
+                // we know enough
+                return false;
+            }
+
+            // should be zero or more
+            if (bytes < 0) return true;
+
+            // process the data, and stop if the user is no longer interested
+            if (!process(_buffer, bytes)) return false;
+
+            // the budget is partially spent
+            budget -= bytes;
+
+            // if less data came in than we asked for the socket is drained
+            if ((size_t)bytes < max) return true;
+
+            // if the budget is spent we give other connections a chance, but
+            // data that a layer already took from the socket is read anyway,
+            // because the socket does not report it as readable
+            if (budget == 0 && (budget = _connection->pending()) == 0) return true;
+        }
+    }
+
 public:
     /**
      *  Constructor
@@ -93,6 +205,48 @@ public:
         _lostCallback = callback;
     }
 
+    /**
+     *  Limit the throughput of the connection
+     *
+     *  The limiter can be shared with other objects, so that the limit applies
+     *  to all of them together. While the limiter has no tokens available, the
+     *  connection is not checked for readability, so that the kernel buffer
+     *  fills up and the peer slows down. Pass nullptr to remove the limit.
+     *
+     *  @param  limiter
+     */
+    void limit(const std::shared_ptr<RateLimiter> &limiter)
+    {
+        // store the limiter
+        _limiter = limiter;
+
+        // if we were waiting for the old limiter, we resume reading
+        if (!_waiter.waiting()) return;
+
+        // stop waiting
+        _waiter.cancel();
+
+        // install the handler again
+        _connection->onReadable(_reader);
+    }
+
+    /**
+     *  Set the read budget
+     *
+     *  When the connection is readable, we keep receiving data until the
+     *  socket is drained, so that a large burst of data does not need a loop
+     *  iteration for each buffer. To prevent that one busy connection starves
+     *  the other connections on the same loop, we stop after the budget is
+     *  spent and wait for the next iteration. A budget of SIZE or less means
+     *  that only one buffer is received per iteration.
+     *
+     *  @param  bytes       Max number of bytes per loop iteration
+     */
+    void budget(size_t bytes)
+    {
+        _budget = std::max(bytes, (size_t)1);
+    }
+
     /**
      *  Check for data to come in
      *
@@ -107,37 +261,19 @@ public:
         // store the data callback
         _readCallback = callback;
 
-        // install a readability handler
-        _connection->onReadable([this]() -> bool {
+        // a new handler is installed right away
+        _waiter.cancel();
 
-            // is there any data remaining in the buffer
-            if (_size)
-            {
-                // send to the callback immediately
-                _readCallback(_buffer, _size);
-                _size = 0;
-            }
-
-            // receive the data
-            ssize_t bytes = _connection->recv(_buffer, SIZE);
-
-            // check for error
-            if (bytes == 0 || (bytes < 0 && errno != EAGAIN && errno != EWOULDBLOCK))
-            {
-                // connection was lost
-                lost();
+        // install a readability handler
+        _connection->onReadable(_reader = [this]() -> bool {
 
-                // we know enough
-                return false;
-            }
-            else
-            {
-                // should be zero or more
-                if (bytes <= 0) return true;
+            // is there an incomplete line remaining in the buffer
+            _lines.flush(_readCallback);
 
-                // report
-                return _readCallback(_buffer, bytes);
-            }
+            // read the data and pass it on
+            return read([this](const char *buffer, size_t size) -> bool {
+                return _readCallback(buffer, size);
+            });
         });
     }
 
@@ -145,79 +281,65 @@ public:
      *  Check for lines to come in
      *
      *  This method is called for every line that comes in via the connection.
-     *  If you set a data hander, the onReadable handler that you've set before
-     *  will be overridden.
+     *  Lines can be terminated by either CRLF or LF, the terminator is not
+     *  passed to the callback. An incomplete line is buffered until the rest
+     *  comes in, but when it grows beyond the max line length, it is passed
+     *  to the callback in pieces. If you set a data hander, the onReadable
+     *  handler that you've set before will be overridden.
      *
      *  @param  callback
+     *  @param  max         Max line length
      */
-    void onLine(const DataCallback &callback)
+    void onLine(const DataCallback &callback, size_t max = SIZE)
     {
         // store the data callback
         _readCallback = callback;
 
+        // set the max line length
+        _lines.max(max);
+
+        // a new handler is installed right away
+        _waiter.cancel();
+
         // install a readability handler
-        _connection->onReadable([this]() -> bool {
+        _connection->onReadable(_reader = [this]() -> bool {
 
-            // receive the data
-            ssize_t bytes = _connection->recv(_buffer + _size, SIZE - _size);
+            // read the data and split it into lines
+            return read([this](const char *buffer, size_t size) -> bool {
+                return _lines.process(buffer, size, _readCallback);
+            });
+        });
+    }
 
-            // check for error
-            if (bytes == 0 || (bytes < 0 && errno != EAGAIN && errno != EWOULDBLOCK))
-            {
-                // connection was lost
-                lost();
+    /**
+     *  Check for frames to come in
+     *
+     *  The framer splits the incoming data into frames, see for example
+     *  LengthFramer, DelimiterFramer and FixedFramer. Every frame is passed
+     *  to the callback. Frames that fit in the receive buffer are passed on
+     *  without copying them, so the data is only valid during the callback.
+     *  When a frame exceeds the max size of the framer, the connection is
+     *  no longer read, and Framer::overflow() returns true.
+     *
+     *  @param  framer      The framer
+     *  @param  callback
+     */
+    void onFrame(const std::shared_ptr<Framer> &framer, const DataCallback &callback)
+    {
+        // store the data callback and the framer
+        _readCallback = callback;
+        _framer = framer;
 
-                // we know enough
-                return false;
-            }
-            else
-            {
-                // should be zero or more
-                if (bytes <= 0) return true;
-
-                // increment number of bytes in the buffer
-                _size += bytes;
-
-                // are we overflowing with data
-                if (_size == SIZE)
-                {
-                    // give all data to the callback
-                    _readCallback(_buffer, SIZE);
-
-                    // no more data remains
-                    _size = 0;
-
-                    // but we want to keep listening
-                    return true;
-                }
-
-                // if the callback returns false just once we want to stop listening
-                // but we do want to get all data out before the listener is stopped
-                bool listen = true;
-
-                // the starting point of each chunk
-                char *start;
-
-                // process all lines in the data
-                for (start = _buffer; auto *newline = (char*)std::memchr(start, '\r', _size + _buffer - start); start = newline + 2)
-                {
-                    // execute the callback
-                    listen &= _readCallback(start, newline - start);
-                }
-
-                // any data left?
-                if (start < _buffer + _size)
-                {
-                    // update number of bytes in buffer
-                    _size += _buffer - start;
-
-                    //  move the remaining bytes to the beginning
-                    std::memmove(_buffer, start, _size);
-                }
-
-                // do we want to keep listening?
-                return listen;
-            }
+        // a new handler is installed right away
+        _waiter.cancel();
+
+        // install a readability handler
+        _connection->onReadable(_reader = [this]() -> bool {
+
+            // read the data and split it into frames
+            return read([this](const char *buffer, size_t size) -> bool {
+                return _framer->process(buffer, size, _readCallback);
+            });
         });
     }
 };
@@ -0,0 +1,101 @@
+/**
+ *  Inherited.h
+ *
+ *  Helper class that refers to a listening socket that was inherited from
+ *  an other process. This can be used for restarting a server without
+ *  dropping connections: the old process exposes its listening sockets to
+ *  the new process (via an environment variable when the new process is
+ *  started with exec(), or via a unix domain connection), and the new
+ *  process constructs its Tcp::Server objects around the inherited
+ *  sockets, without binding or listening.
+ *
+ *  @copyright 2014 Copernica BV
+ */
+
+/**
+ *  Set up namespace
+ */
+namespace React { namespace Tcp {
+
+/**
+ *  Class definition
+ */
+class Inherited
+{
+private:
+    /**
+     *  The inherited filedescriptor
+     *  @var    int
+     */
+    int _fd = -1;
+
+public:
+    /**
+     *  Constructor for a filedescriptor that was passed in a different way,
+     *  for example over a unix domain connection
+     *  @param  fd          The filedescriptor
+     */
+    explicit Inherited(int fd) : _fd(fd) {}
+
+    /**
+     *  Constructor for a filedescriptor that was exposed via an environment
+     *  variable with Server::expose(). The variable holds a comma separated
+     *  list of filedescriptors, and the index selects one of them.
+     *
+     *  @param  variable    Name of the environment variable
+     *  @param  index       Index in the list of filedescriptors
+     */
+    explicit Inherited(const char *variable, size_t index = 0)
+    {
+        // get the value
+        const char *value = getenv(variable);
+
+        // skip if not set
+        if (value == nullptr) return;
+
+        // skip the preceding filedescriptors
+        for (size_t i = 0; i < index && value; i++) if ((value = strchr(value, ','))) value++;
+
+        // the filedescriptor should be there
+        if (value == nullptr || !isdigit((unsigned char)*value)) return;
+
+        // parse the filedescriptor
+        _fd = atoi(value);
+    }
+
+    /**
+     *  Destructor
+     */
+    virtual ~Inherited() {}
+
+    /**
+     *  Retrieve the filedescriptor
+     *  @return int
+     */
+    int fd() const
+    {
+        return _fd;
+    }
+
+    /**
+     *  Is the filedescriptor a socket that is listening for connections?
+     *  @return bool
+     */
+    bool valid() const
+    {
+        // filedescriptor must be valid
+        if (_fd < 0) return false;
+
+        // check if the socket is listening
+        int listening = 0;
+        socklen_t size = sizeof(int);
+
+        // ask the kernel
+        return getsockopt(_fd, SOL_SOCKET, SO_ACCEPTCONN, &listening, &size) == 0 && listening;
+    }
+};
+
+/**
+ *  End namespace
+ */
+}}
@@ -0,0 +1,69 @@
+/**
+ *  Layer.h
+ *
+ *  Base class for a layer that sits between a connection and its socket,
+ *  like the Tcp::Tls layer. When a layer is installed on a connection, all
+ *  data that is sent and received via the connection passes through the
+ *  layer, so that the Tcp::In and Tcp::Out classes work just the same.
+ *
+ *  @copyright 2014 Copernica BV
+ */
+
+/**
+ *  Set up namespace
+ */
+namespace React { namespace Tcp {
+
+/**
+ *  Class definition
+ */
+class Layer
+{
+public:
+    /**
+     *  Destructor
+     */
+    virtual ~Layer() {}
+
+    /**
+     *  Send data, with the same semantics as the ::send() system call
+     *  @param  buf     Pointer to a buffer
+     *  @param  len     Size of the buffer
+     *  @return ssize_t Number of bytes sent
+     */
+    virtual ssize_t send(const void *buf, size_t len) = 0;
+
+    /**
+     *  Send data, with the same semantics as the ::writev() system call
+     *  @param  iov     Array of struct iovec objects
+     *  @param  iovcnt  Number of items in the array
+     *  @return ssize_t Number of bytes sent
+     */
+    virtual ssize_t writev(const struct iovec *iov, int iovcnt) = 0;
+
+    /**
+     *  Receive data, with the same semantics as the ::recv() system call
+     *  @param  buf     Pointer to a buffer
+     *  @param  len     Size of the buffer
+     *  @return ssize_t Number of bytes received
+     */
+    virtual ssize_t recv(void *buf, size_t len) = 0;
+
+    /**
+     *  Number of received bytes that the layer already took from the socket,
+     *  but that were not yet passed on. The socket does not report these
+     *  bytes as readable, so they have to be read before we stop reading.
+     *  @return size_t
+     */
+    virtual size_t pending() const = 0;
+
+    /**
+     *  Called right before the writing side of the connection is shut down
+     */
+    virtual void shutdown() = 0;
+};
+
+/**
+ *  End namespace
+ */
+}}
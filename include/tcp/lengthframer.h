@@ -0,0 +1,73 @@
+/**
+ *  LengthFramer.h
+ *
+ *  Framer for frames that start with their length, as a big-endian
+ *  integer of type T (usually uint16_t or uint32_t). The length prefix
+ *  is not passed to the callback. A frame that announces a length above
+ *  the max size is rejected as soon as the prefix is in, so that the
+ *  framer never buffers its payload.
+ *
+ *  @copyright 2014 Copernica BV
+ */
+
+/**
+ *  Set up namespace
+ */
+namespace React { namespace Tcp {
+
+/**
+ *  Class definition
+ */
+template <typename T>
+class LengthFramer : public Framer
+{
+protected:
+    /**
+     *  Recognize a complete frame at the start of a block of data
+     *  @param  data        The data
+     *  @param  size        Size of the data
+     *  @param  offset      Number of bytes that were inspected before
+     *  @param  start       Set to the offset of the payload of the frame
+     *  @param  length      Set to the size of the payload of the frame
+     *  @return size_t      Total size of the frame, 0 if it is not yet complete, or oversized
+     */
+    virtual size_t find(const char *data, size_t size, size_t offset, size_t &start, size_t &length) const override
+    {
+        // the length prefix must be complete
+        if (size < sizeof(T)) return 0;
+
+        // decode the big-endian length
+        T value = 0;
+        for (size_t i = 0; i < sizeof(T); ++i) value = (value << 8) | (unsigned char)data[i];
+
+        // the frame should fit, this is written so that it can not wrap around
+        if (max() < sizeof(T) || value > max() - sizeof(T)) return oversized;
+
+        // the payload must be complete too
+        if (size - sizeof(T) < value) return 0;
+
+        // the payload follows the prefix
+        start = sizeof(T);
+        length = value;
+
+        // done
+        return sizeof(T) + value;
+    }
+
+public:
+    /**
+     *  Constructor
+     *  @param  max         Max size of a frame, including the prefix, the default is 1MB
+     */
+    LengthFramer(size_t max = 1048576) : Framer(max) {}
+
+    /**
+     *  Destructor
+     */
+    virtual ~LengthFramer() {}
+};
+
+/**
+ *  End namespace
+ */
+}}
@@ -0,0 +1,186 @@
+/**
+ *  LineSplitter.h
+ *
+ *  Splits a stream of incoming data into lines. Lines may be terminated by
+ *  either CRLF or a bare LF, the terminator is not passed to the callback.
+ *  Complete lines are passed on straight from the receive buffer, only
+ *  a line that is split over multiple reads is copied into a buffer that
+ *  grows until the max line length is reached. Longer lines are passed on
+ *  in pieces.
+ *
+ *  Both CRLF and LF end with a line feed, so we only have to scan for a
+ *  single byte. This is done with memchr(), which the C library already
+ *  implements with the widest vector instructions that the CPU supports.
+ *
+ *  @copyright 2014 Copernica BV
+ */
+
+/**
+ *  Set up namespace
+ */
+namespace React { namespace Tcp {
+
+/**
+ *  Class definition
+ */
+class LineSplitter
+{
+private:
+    /**
+     *  Buffer with the start of a line that is not yet complete
+     *  @var    std::vector
+     */
+    std::vector<char> _buffer;
+
+    /**
+     *  Max line length
+     *  @var    size_t
+     */
+    size_t _max;
+
+public:
+    /**
+     *  Constructor
+     *  @param  max         Max line length
+     */
+    LineSplitter(size_t max) : _max(std::max(max, (size_t)1)) {}
+
+    /**
+     *  Destructor
+     */
+    virtual ~LineSplitter() {}
+
+    /**
+     *  Find the line feed that ends the first line in a block of data
+     *  @param  data        The data
+     *  @param  size        Size of the data
+     *  @return const char* Pointer to the line feed, or nullptr if there is none
+     */
+    static const char *find(const char *data, size_t size)
+    {
+        return (const char *)std::memchr(data, '\n', size);
+    }
+
+    /**
+     *  Length of a line without the carriage return before the line feed
+     *  @param  line        Start of the line
+     *  @param  size        Size of the line up to the line feed
+     *  @return size_t
+     */
+    static size_t strip(const char *line, size_t size)
+    {
+        return size > 0 && line[size - 1] == '\r' ? size - 1 : size;
+    }
+
+    /**
+     *  Change the max line length
+     *  @param  max
+     */
+    void max(size_t max)
+    {
+        _max = std::max(max, (size_t)1);
+    }
+
+    /**
+     *  Number of bytes of an incomplete line that are buffered
+     *  @return size_t
+     */
+    size_t size() const
+    {
+        return _buffer.size();
+    }
+
+    /**
+     *  Process incoming data
+     *
+     *  If the callback returns false just once, this method returns false
+     *  too, but all lines in the data are still passed to the callback.
+     *
+     *  @param  data        The data
+     *  @param  size        Size of the data
+     *  @param  callback    Function that is called for every line
+     *  @return bool
+     */
+    bool process(const char *data, size_t size, const DataCallback &callback)
+    {
+        // do we want to keep listening?
+        bool listen = true;
+
+        // the end of the data
+        const char *end = data + size;
+
+        // process all lines in the data
+        while (data < end)
+        {
+            // find the end of the line
+            const char *newline = find(data, end - data);
+
+            // is the line not yet complete?
+            if (newline == nullptr)
+            {
+                // keep the data until the rest of the line comes in
+                _buffer.insert(_buffer.end(), data, end);
+
+                // if the line is too long, we pass on what we have now
+                if (_buffer.size() >= _max) listen &= flush(callback);
+
+                // done
+                return listen;
+            }
+
+            // if no data was buffered, the line is passed on straight away
+            if (_buffer.empty()) listen &= callback(data, strip(data, newline - data));
+
+            // otherwise the line is completed in the buffer
+            else
+            {
+                // add the rest of the line
+                _buffer.insert(_buffer.end(), data, newline);
+
+                // pass on the line
+                listen &= callback(_buffer.data(), strip(_buffer.data(), _buffer.size()));
+
+                // the buffer can be reused
+                _buffer.clear();
+            }
+
+            // proceed with the next line
+            data = newline + 1;
+        }
+
+        // done
+        return listen;
+    }
+
+    /**
+     *  Pass the buffered data to the callback, even when the line is not complete
+     *  @param  callback
+     *  @return bool
+     */
+    bool flush(const DataCallback &callback)
+    {
+        // skip if there is nothing buffered
+        if (_buffer.empty()) return true;
+
+        // take the data out of the buffer, because the callback might
+        // destruct the object
+        std::vector<char> buffer;
+        buffer.swap(_buffer);
+
+        // pass it on
+        return callback(buffer.data(), buffer.size());
+    }
+
+    /**
+     *  Forget the buffered data
+     */
+    void clear()
+    {
+        _buffer.clear();
+    }
+};
+
+/**
+ *  End namespace
+ */
+}}
@@ -49,12 +49,59 @@ private:
      */
     CloseCallback _closeCallback;
 
+    /**
+     *  Should only the writing side be closed when the buffer is empty?
+     *  @var    bool
+     */
+    bool _halfclose = false;
+
     /**
      *  Callback that is called when connection is really writable (and no longer buffered)
      *  @var    WriteCallback
      */
     WriteCallback _writeCallback;
 
+    /**
+     *  Optional rate limiter
+     *  @var    RateLimiter
+     */
+    std::shared_ptr<RateLimiter> _limiter;
+
+    /**
+     *  Object to wait for the rate limiter
+     *  @var    RateLimiter::Waiter
+     */
+    RateLimiter::Waiter _waiter {[this]() { checkWritable(); }};
+
+    /**
+     *  Send data from the buffer, but not more than a certain number of bytes
+     *  @param  allowed     Max number of bytes to send
+     *  @return ssize_t
+     */
+    ssize_t flush(size_t allowed)
+    {
+        // if we may send everything, we pass the iovecs of the buffer as they are
+        if (allowed >= _buffer.size()) return _connection->writev(_buffer.iovec(), _buffer.count());
+
+        // copy of the iovecs that we are going to truncate
+        struct iovec iov[128];
+        int count = 0;
+
+        // copy the iovecs until we have enough
+        for (auto *current = _buffer.iovec(); count < _buffer.count() && count < 128 && allowed > 0; ++count, ++current)
+        {
+            // copy the iovec
+            iov[count].iov_base = current->iov_base;
+            iov[count].iov_len = std::min(allowed, current->iov_len);
+
+            // fewer bytes are allowed
+            allowed -= iov[count].iov_len;
+        }
+
+        // send the data
+        return _connection->writev(iov, count);
+    }
+
     /**
      *  Install a handler
      */
@@ -66,12 +113,21 @@ private:
             // do we still have a buffer?
             if (_buffer.size() > 0)
             {
+                // number of bytes that we may send
+                size_t allowed = _limiter ? _limiter->available() : _buffer.size();
+
+                // if the bucket is empty, we stop watching and wait for the limiter
+                if (allowed == 0) { _limiter->wait(&_waiter); return false; }
+
                 // send more data to the buffer
-                ssize_t result = _connection->writev(_buffer.iovec(), _buffer.count());
+                ssize_t result = flush(allowed);
 
                 // forget errors
                 if (result < 0) result = 0;
 
+                // take the tokens from the bucket
+                if (_limiter) _limiter->consume(result);
+
                 // shrink the buffer
                 _buffer.shrink(result);
 
@@ -82,8 +138,9 @@ private:
             }
             else if (_status == status_closing)
             {
-                // close the tcp connection
-                _connection->close();
+                // close the tcp connection, or only the writing side of it
+                if (_halfclose) _connection->shutdown();
+                else _connection->close();
 
                 // copy the close callback (because it might destruct the object)
                 auto callback = _closeCallback;
@@ -130,6 +187,9 @@ private:
         // unregister any callbacks we've had
         _connection->onWritable(nullptr);
 
+        // no longer waiting for the limiter
+        _waiter.cancel();
+
         // empty buffer
         _buffer.clear();
 
@@ -137,6 +197,9 @@ private:
         _closeCallback = nullptr;
         _writeCallback = nullptr;
 
+        // no longer closing
+        _halfclose = false;
+
         // change status
         _status = status_closed;
     }
@@ -160,6 +223,35 @@ public:
         _connection->onWritable(nullptr);
     }
 
+    /**
+     *  Limit the throughput of the connection
+     *
+     *  The limiter can be shared with other objects, so that the limit applies
+     *  to all of them together. Data that exceeds the limit is buffered, and
+     *  the connection is not checked for writability while the limiter has
+     *  no tokens available. Pass nullptr to remove the limit.
+     *
+     *  @param  limiter
+     */
+    void limit(const std::shared_ptr<RateLimiter> &limiter)
+    {
+        // no longer wait for the old limiter
+        if (_waiter.waiting())
+        {
+            // stop waiting
+            _waiter.cancel();
+
+            // check the buffer with the new limiter
+            _limiter = limiter;
+            checkWritable();
+        }
+        else
+        {
+            // store the limiter
+            _limiter = limiter;
+        }
+    }
+
     /**
      *  Install a handler for writability
      *
@@ -202,10 +294,28 @@ public:
         if (_status != status_active) return 0;
 
         // do we already have a buffer?
-        if (_buffer.size() > 0) return _buffer.add(data, size);
+        if (_buffer.size() > 0)
+        {
+            // add the data to the buffer
+            size_t added = _buffer.add(data, size);
+
+            // keep track of the peak buffer size
+            if (_connection->_tracking) _connection->_tracking->statistics.buffered(_buffer.size());
+
+            // done
+            return added;
+        }
+
+        // number of bytes that we may send right away
+        size_t allowed = _limiter ? std::min(size, _limiter->available()) : size;
 
         // try sending it to the connection
-        ssize_t result = _connection->send(data, size);
+        ssize_t result = allowed > 0 ? _connection->send(data, allowed) : 0;
+
+        // take the tokens from the bucket
+        if (_limiter && result > 0) _limiter->consume(result);
+
+        // was everything sent?
         if (result >= 0 && (size_t)result >= size) return result;
 
         // check if socket is in an error sate
@@ -225,6 +335,9 @@ public:
             // add remaining bytes to buffer
             _buffer.add((const char*)data + result, size - result);
 
+            // keep track of the peak buffer size
+            if (_connection->_tracking) _connection->_tracking->statistics.buffered(_buffer.size());
+
             // check for writability
             checkWritable();
 
@@ -262,6 +375,29 @@ public:
         // done
         return true;
     }
+
+    /**
+     *  Half-close the connection
+     *
+     *  This works like close(), but after all buffers were sent only the
+     *  writing side of the connection is shut down. The peer receives an
+     *  end-of-file, while incoming data can still be received, for example
+     *  to wait for the peer to close the connection at its side.
+     *
+     *  @param  callback    Called when the writing side is closed
+     *  @return bool
+     */
+    bool shutdown(const CloseCallback &callback = nullptr)
+    {
+        // start closing
+        if (!close(callback)) return false;
+
+        // but only the writing side
+        _halfclose = true;
+
+        // done
+        return true;
+    }
 };
 
 /**
@@ -0,0 +1,310 @@
+/**
+ *  PooledIn.h
+ *
+ *  Input buffer for socket connections that works just like Tcp::In, but
+ *  that does not have a buffer of its own. Data is received in the scratch
+ *  buffer of a Tcp::ReceivePool that is shared by all connections on the
+ *  same loop. Only when a partial line remains after the data was processed,
+ *  a block is taken from the pool to hold on to it. This makes a difference
+ *  for servers with many mostly idle connections.
+ *
+ *  @copyright 2014 Copernica BV
+ */
+
+/**
+ *  Set up namespace
+ */
+namespace React { namespace Tcp {
+
+/**
+ *  Class definition
+ */
+class PooledIn
+{
+private:
+    /**
+     *  The pool with the shared buffers
+     *  @var    ReceivePool
+     */
+    std::shared_ptr<ReceivePool> _pool;
+
+    /**
+     *  Block with incomplete data, if there is any
+     *  @var    char
+     */
+    char *_tail = nullptr;
+
+    /**
+     *  The amount of bytes in the tail block
+     *  @var    size_t
+     */
+    size_t _size = 0;
+
+    /**
+     *  The underlying TCP connection
+     *  @var    Connection
+     */
+    Connection *_connection;
+
+    /**
+     *  Callback to execute when the connection drops
+     *  @var    LostCallback
+     */
+    LostCallback _lostCallback;
+
+    /**
+     *  The callback to inform once data arrives
+     *  @var    DataCallback
+     */
+    DataCallback _readCallback;
+
+    /**
+     *  Store the incomplete data at the end of the received data
+     *  @param  data        Pointer to the data
+     *  @param  size        Size of the data, smaller than a block
+     */
+    void keep(const char *data, size_t size)
+    {
+        // if nothing remains, the block can go back to the pool
+        if (size == 0) return release();
+
+        // we need a block
+        if (_tail == nullptr) _tail = _pool->allocate();
+
+        // copy the data
+        std::memcpy(_tail, data, _size = size);
+    }
+
+    /**
+     *  Give the tail block back to the pool
+     */
+    void release()
+    {
+        // skip if we have no block
+        if (_tail == nullptr) return;
+
+        // return the block
+        _pool->release(_tail);
+
+        // forget the block
+        _tail = nullptr;
+        _size = 0;
+    }
+
+    /**
+     *  Pass the data in the tail block to the callback
+     */
+    void flush()
+    {
+        // skip if there is no data
+        if (_size == 0) return;
+
+        // copy the data to the scratch buffer, so that we can release the block
+        size_t size = _size;
+        std::memcpy(_pool->scratch(), _tail, size);
+
+        // release the block
+        release();
+
+        // pass on the data
+        _readCallback(_pool->scratch(), size);
+    }
+
+    /**
+     *  We have lost the connection
+     *
+     *  Callbacks may have captured variables
+     *  which need to be destroyed.
+     */
+    void lost()
+    {
+        // there might be some data left in the buffer
+        if (_readCallback) flush();
+
+        // no longer interested in the block
+        release();
+
+        // unregister any callbacks we've had
+        _connection->onReadable(nullptr);
+
+        // remove the data callback
+        _readCallback = nullptr;
+
+        // copy the lost callback (if it is there)
+        if (_lostCallback)
+        {
+            // copy and remove
+            auto callback = _lostCallback;
+            _lostCallback = nullptr;
+
+            // execute the callback
+            callback();
+        }
+    }
+
+    /**
+     *  Receive data in the scratch buffer
+     *  @param  offset      Offset in the scratch buffer
+     *  @return ssize_t     Number of bytes received, or -1 when the connection was lost
+     */
+    ssize_t receive(size_t offset)
+    {
+        // receive the data
+        ssize_t bytes = _connection->recv(_pool->scratch() + offset, _pool->size() - offset);
+
+        // check for error
+        if (bytes > 0 || (bytes < 0 && (errno == EAGAIN || errno == EWOULDBLOCK))) return std::max(bytes, (ssize_t)0);
+
+        // connection was lost
+        lost();
+
+        // report the failure
+        return -1;
+    }
+
+public:
+    /**
+     *  Constructor
+     *
+     *  Wraps the class around the connection
+     *
+     *  @param  connection  the connection to wrap around
+     *  @param  pool        the pool with the shared buffers
+     */
+    PooledIn(Connection *connection, const std::shared_ptr<ReceivePool> &pool) :
+        _pool(pool), _connection(connection) {}
+
+    /**
+     *  Objects can not be copied
+     *  @param  that
+     */
+    PooledIn(const PooledIn &that) = delete;
+
+    /**
+     *  Destructor
+     */
+    virtual ~PooledIn()
+    {
+        // give the block back
+        release();
+    }
+
+    /**
+     *  Check if the connection is lost
+     *
+     *  @param  callback
+     */
+    void onLost(const LostCallback &callback)
+    {
+        // install the callback
+        _lostCallback = callback;
+    }
+
+    /**
+     *  Check for data to come in
+     *
+     *  This method is called for all data that comes in via the connection.
+     *  The data is only valid during the callback, because the buffer is
+     *  shared with other connections.
+     *
+     *  @param  callback
+     */
+    void onData(const DataCallback &callback)
+    {
+        // store the data callback
+        _readCallback = callback;
+
+        // install a readability handler
+        _connection->onReadable([this]() -> bool {
+
+            // is there any data remaining in the buffer
+            flush();
+
+            // receive the data
+            ssize_t bytes = receive(0);
+
+            // stop on errors, and wait for more if there was no data
+            if (bytes < 0) return false;
+            if (bytes == 0) return true;
+
+            // report
+            return _readCallback(_pool->scratch(), bytes);
+        });
+    }
+
+    /**
+     *  Check for lines to come in
+     *
+     *  This method is called for every line that comes in via the connection.
+     *  Lines can be terminated by either CRLF or LF. Complete lines are always passed on as a whole, but an incomplete
+     *  line that is longer than a block of the pool is passed to the
+     *  callback in pieces.
+     *
+     *  @param  callback
+     */
+    void onLine(const DataCallback &callback)
+    {
+        // store the data callback
+        _readCallback = callback;
+
+        // install a readability handler
+        _connection->onReadable([this]() -> bool {
+
+            // the buffer in which we receive, and the size of the block
+            char *buffer = _pool->scratch();
+            size_t block = _pool->block();
+
+            // the incomplete line from the previous call goes in front
+            size_t size = _size;
+            if (size > 0) std::memcpy(buffer, _tail, size);
+
+            // receive the data
+            ssize_t bytes = receive(size);
+
+            // stop on errors, and wait for more if there was no data
+            if (bytes < 0) return false;
+            if (bytes == 0) return true;
+
+            // the end of the data
+            char *end = buffer + size + bytes;
+
+            // if the callback returns false just once we want to stop listening
+            // but we do want to get all data out before the listener is stopped
+            bool listen = true;
+
+            // the starting point of each line
+            char *start = buffer;
+
+            // process all complete lines in the data
+            while (auto *newline = (char *)LineSplitter::find(start, end - start))
+            {
+                // execute the callback
+                listen &= _readCallback(start, LineSplitter::strip(start, newline - start));
+
+                // proceed with the next line
+                start = newline + 1;
+            }
+
+            // lines that do not fit in a block are passed on in pieces
+            while (end - start >= (ssize_t)block)
+            {
+                // execute the callback
+                listen &= _readCallback(start, block);
+
+                // proceed with the next piece
+                start += block;
+            }
+
+            // keep the incomplete line
+            keep(start, end - start);
+
+            // do we want to keep listening?
+            return listen;
+        });
+    }
+};
+
+/**
+ *  End namespace
+ */
+}}
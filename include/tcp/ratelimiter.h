@@ -0,0 +1,319 @@
+/**
+ *  RateLimiter.h
+ *
+ *  Token bucket that can be used to throttle the throughput of Tcp::Out
+ *  and Tcp::In objects. A single limiter can be shared by a group of
+ *  connections (for example all connections to the same destination), in
+ *  which case the rate applies to the group as a whole.
+ *
+ *  When the bucket is empty, the objects stop watching their connection
+ *  and wait for the limiter. The limiter uses a single timer to resume the
+ *  waiting objects once the bucket has been refilled, so no timers are
+ *  needed per connection.
+ *
+ *  @copyright 2014 Copernica BV
+ */
+
+/**
+ *  Set up namespace
+ */
+namespace React { namespace Tcp {
+
+/**
+ *  Class definition
+ */
+class RateLimiter
+{
+public:
+    /**
+     *  Object that can wait for the limiter
+     */
+    class Waiter
+    {
+    private:
+        /**
+         *  The limiter that we are waiting for
+         *  @var    RateLimiter
+         */
+        RateLimiter *_limiter = nullptr;
+
+        /**
+         *  Position in the list of waiters
+         *  @var    std::list::iterator
+         */
+        std::list<Waiter*>::iterator _position;
+
+        /**
+         *  Callback to call when tokens are available again
+         *  @var    std::function
+         */
+        std::function<void()> _callback;
+
+        /**
+         *  The limiter manages the members
+         */
+        friend class RateLimiter;
+
+    public:
+        /**
+         *  Constructor
+         *  @param  callback    Function to call when tokens are available again
+         */
+        Waiter(const std::function<void()> &callback) : _callback(callback) {}
+
+        /**
+         *  Waiters can not be copied
+         *  @param  that
+         */
+        Waiter(const Waiter &that) = delete;
+
+        /**
+         *  Destructor
+         */
+        virtual ~Waiter()
+        {
+            // stop waiting
+            cancel();
+        }
+
+        /**
+         *  Is the object waiting?
+         *  @return bool
+         */
+        bool waiting() const
+        {
+            return _limiter != nullptr;
+        }
+
+        /**
+         *  Stop waiting
+         */
+        void cancel()
+        {
+            // skip if not waiting
+            if (_limiter == nullptr) return;
+
+            // remove from the list
+            _limiter->_waiters.erase(_position);
+
+            // no longer waiting
+            _limiter = nullptr;
+        }
+    };
+
+private:
+    /**
+     *  The event loop
+     *  @var    Loop
+     */
+    Loop *_loop;
+
+    /**
+     *  Number of bytes per second
+     *  @var    double
+     */
+    double _rate;
+
+    /**
+     *  Max number of tokens in the bucket
+     *  @var    double
+     */
+    double _burst;
+
+    /**
+     *  Current number of tokens in the bucket
+     *  @var    double
+     */
+    double _tokens;
+
+    /**
+     *  Time of the last refill
+     *  @var    Timestamp
+     */
+    Timestamp _updated;
+
+    /**
+     *  The objects that are waiting for tokens
+     *  @var    std::list
+     */
+    std::list<Waiter*> _waiters;
+
+    /**
+     *  Are we busy resuming the waiting objects?
+     *  @var    bool
+     */
+    bool _resuming = false;
+
+    /**
+     *  The single timer that resumes the waiting objects
+     *  @var    TimeoutWatcher
+     */
+    TimeoutWatcher _timer;
+
+    /**
+     *  Refill the bucket for the time that has passed
+     */
+    void refill()
+    {
+        // current time
+        Timestamp now = _loop->now();
+
+        // add the tokens
+        _tokens = std::min(_burst, _tokens + (now - _updated) * _rate);
+
+        // remember the time
+        _updated = now;
+    }
+
+    /**
+     *  Number of tokens that should be available before waiting objects are
+     *  resumed, we wait for at least a hundredth of a second worth of data
+     *  so that we do not resume all objects for just a couple of bytes
+     *  @return double
+     */
+    double threshold() const
+    {
+        return std::min(_burst, std::max(_rate / 100.0, 1.0));
+    }
+
+    /**
+     *  Set the timer to expire when enough tokens are available
+     */
+    void schedule()
+    {
+        // the number of tokens that we miss
+        double missing = threshold() - _tokens;
+
+        // set the timer
+        _timer.set(missing > 0.0 ? missing / _rate : 0.0);
+    }
+
+    /**
+     *  Called when the timer expires
+     */
+    void expire()
+    {
+        // fill the bucket
+        refill();
+
+        // the waiting objects may now take tokens
+        _resuming = true;
+
+        // resume the waiting objects in order, as long as there are tokens
+        while (!_waiters.empty() && _tokens >= 1.0)
+        {
+            // the first waiter
+            Waiter *waiter = _waiters.front();
+
+            // remove it from the list
+            waiter->cancel();
+
+            // tell the waiter to proceed
+            waiter->_callback();
+        }
+
+        // new objects have to line up again
+        _resuming = false;
+
+        // if objects are still waiting, we need the timer again
+        if (!_waiters.empty()) schedule();
+    }
+
+public:
+    /**
+     *  Constructor
+     *  @param  loop        Event loop
+     *  @param  rate        Number of bytes per second
+     *  @param  burst       Max number of bytes that can be sent or received at once
+     */
+    RateLimiter(Loop *loop, size_t rate, size_t burst) :
+        _loop(loop), _rate(std::max(rate, (size_t)1)), _burst(std::max(burst, (size_t)1)),
+        _tokens(_burst), _updated(loop->now()),
+        _timer(loop, [this]() { expire(); }) {}
+
+    /**
+     *  Limiters can not be copied
+     *  @param  that
+     */
+    RateLimiter(const RateLimiter &that) = delete;
+
+    /**
+     *  Destructor
+     */
+    virtual ~RateLimiter()
+    {
+        // forget all waiters
+        while (!_waiters.empty()) _waiters.front()->cancel();
+    }
+
+    /**
+     *  Number of bytes that may be processed right now
+     *  @return size_t
+     */
+    size_t available()
+    {
+        // fill the bucket
+        refill();
+
+        // objects that are waiting go first
+        if (!_waiters.empty() && !_resuming) return 0;
+
+        // we only hand out whole tokens
+        return _tokens < 1.0 ? 0 : (size_t)_tokens;
+    }
+
+    /**
+     *  Consume a number of tokens
+     *  @param  bytes       Number of bytes that were processed
+     */
+    void consume(size_t bytes)
+    {
+        _tokens -= bytes;
+    }
+
+    /**
+     *  Wait until tokens are available again
+     *  @param  waiter      The object that waits
+     */
+    void wait(Waiter *waiter)
+    {
+        // skip if already waiting
+        if (waiter->_limiter == this) return;
+
+        // stop waiting for an other limiter
+        waiter->cancel();
+
+        // add to the list
+        waiter->_limiter = this;
+        waiter->_position = _waiters.insert(_waiters.end(), waiter);
+
+        // if this is the first waiter, we need the timer
+        if (_waiters.size() == 1) schedule();
+    }
+
+    /**
+     *  Change the rate
+     *  @param  rate        Number of bytes per second
+     *  @param  burst       Max number of bytes that can be sent or received at once
+     */
+    void set(size_t rate, size_t burst)
+    {
+        // fill the bucket with the old rate
+        refill();
+
+        // store the new settings
+        _rate = std::max(rate, (size_t)1);
+        _burst = std::max(burst, (size_t)1);
+
+        // the bucket may not exceed the new size
+        _tokens = std::min(_tokens, _burst);
+
+        // the waiters may have to be resumed at an other time
+        if (!_waiters.empty()) schedule();
+    }
+};
+
+/**
+ *  End namespace
+ */
+}}
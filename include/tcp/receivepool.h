@@ -0,0 +1,164 @@
+/**
+ *  ReceivePool.h
+ *
+ *  Memory that is shared by all Tcp::PooledIn objects on the same event
+ *  loop. Incoming data is received in a single scratch buffer, and only
+ *  the incomplete data at the end (for example a partial line) is copied
+ *  into a small block that is taken from a freelist. Idle connections
+ *  therefore do not take up any buffer space at all.
+ *
+ *  The pool is not thread safe, every loop should have its own pool.
+ *
+ *  @copyright 2014 Copernica BV
+ */
+
+/**
+ *  Set up namespace
+ */
+namespace React { namespace Tcp {
+
+/**
+ *  Class definition
+ */
+class ReceivePool
+{
+private:
+    /**
+     *  The scratch buffer in which all data is received
+     *  @var    std::vector
+     */
+    std::vector<char> _scratch;
+
+    /**
+     *  Size of the blocks for incomplete data
+     *  @var    size_t
+     */
+    size_t _block;
+
+    /**
+     *  Max number of unused blocks that are kept
+     *  @var    size_t
+     */
+    size_t _spare;
+
+    /**
+     *  Blocks that are not in use
+     *  @var    std::vector
+     */
+    std::vector<char*> _free;
+
+    /**
+     *  Number of blocks in use
+     *  @var    size_t
+     */
+    size_t _used = 0;
+
+public:
+    /**
+     *  Constructor
+     *  @param  size        Size of the scratch buffer
+     *  @param  block       Size of the blocks for incomplete data
+     *  @param  spare       Max number of unused blocks to keep
+     */
+    ReceivePool(size_t size = 65536, size_t block = 1536, size_t spare = 1024) :
+        _scratch(std::max(size, block * 2)), _block(block), _spare(spare) {}
+
+    /**
+     *  Pools can not be copied
+     *  @param  that
+     */
+    ReceivePool(const ReceivePool &that) = delete;
+
+    /**
+     *  Destructor
+     */
+    virtual ~ReceivePool()
+    {
+        // free the unused blocks
+        for (auto *block : _free) delete [] block;
+    }
+
+    /**
+     *  The scratch buffer
+     *  @return char*
+     */
+    char *scratch()
+    {
+        return _scratch.data();
+    }
+
+    /**
+     *  Size of the scratch buffer
+     *  @return size_t
+     */
+    size_t size() const
+    {
+        return _scratch.size();
+    }
+
+    /**
+     *  Size of a block
+     *  @return size_t
+     */
+    size_t block() const
+    {
+        return _block;
+    }
+
+    /**
+     *  Take a block from the pool
+     *  @return char*
+     */
+    char *allocate()
+    {
+        // one more block in use
+        _used += 1;
+
+        // allocate a new block if there are no free blocks
+        if (_free.empty()) return new char[_block];
+
+        // take the last free block
+        char *result = _free.back();
+        _free.pop_back();
+
+        // done
+        return result;
+    }
+
+    /**
+     *  Return a block to the pool
+     *  @param  block
+     */
+    void release(char *block)
+    {
+        // one block less in use
+        _used -= 1;
+
+        // keep the block for later, unless we already have enough of them
+        if (_free.size() < _spare) _free.push_back(block);
+        else delete [] block;
+    }
+
+    /**
+     *  Number of blocks in use
+     *  @return size_t
+     */
+    size_t used() const
+    {
+        return _used;
+    }
+
+    /**
+     *  Number of unused blocks that are kept in the pool
+     *  @return size_t
+     */
+    size_t spare() const
+    {
+        return _free.size();
+    }
+};
+
+/**
+ *  End namespace
+ */
+}}
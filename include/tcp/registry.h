@@ -0,0 +1,141 @@
+/**
+ *  Registry.h
+ *
+ *  Implementation-only class that holds a set of connections, for example
+ *  all connections that were accepted by a server. The registry is shared
+ *  between the owner and the connections, so that it does not matter
+ *  which of them is destructed first. Connections remove themselves from
+ *  the registry when they are destructed, and leave their statistics
+ *  behind in the totals.
+ *
+ *  @copyright 2014 Copernica BV
+ */
+
+/**
+ *  Set up namespace
+ */
+namespace React { namespace Tcp {
+
+/**
+ *  Class definition
+ */
+class Registry
+{
+private:
+    /**
+     *  The connections and their statistics
+     *  @var    std::map
+     */
+    std::map<Connection*, const Statistics*> _connections;
+
+    /**
+     *  Aggregated statistics of the connections that were removed
+     *  @var    Statistics
+     */
+    Statistics _totals;
+
+    /**
+     *  Callback that is called when the last connection is removed
+     *  @var    std::function
+     */
+    std::function<void()> _emptyCallback;
+
+public:
+    /**
+     *  Constructor
+     */
+    Registry() {}
+
+    /**
+     *  Destructor
+     */
+    virtual ~Registry() {}
+
+    /**
+     *  Add a connection
+     *  @param  connection      The connection to add
+     *  @param  statistics      Statistics of the connection
+     */
+    void add(Connection *connection, const Statistics *statistics)
+    {
+        _connections[connection] = statistics;
+    }
+
+    /**
+     *  Remove a connection
+     *  @param  connection      The connection to remove
+     */
+    void remove(Connection *connection)
+    {
+        // find the connection
+        auto iter = _connections.find(connection);
+        if (iter == _connections.end()) return;
+
+        // remember its statistics
+        _totals += *iter->second;
+
+        // forget the connection
+        _connections.erase(iter);
+
+        // skip if there are still connections, or if nobody is interested
+        if (!_connections.empty() || !_emptyCallback) return;
+
+        // copy the callback, because calling it might destruct the owner
+        auto callback = _emptyCallback;
+
+        // the callback is only called once
+        _emptyCallback = nullptr;
+
+        // report that all connections are gone
+        callback();
+    }
+
+    /**
+     *  Is a connection registered?
+     *  @param  connection
+     *  @return bool
+     */
+    bool contains(Connection *connection) const
+    {
+        return _connections.find(connection) != _connections.end();
+    }
+
+    /**
+     *  Install a handler that is called once, when the last connection is removed
+     *  @param  callback
+     */
+    void onEmpty(const std::function<void()> &callback)
+    {
+        _emptyCallback = callback;
+    }
+
+    /**
+     *  The registered connections
+     *  @return std::map
+     */
+    const std::map<Connection*, const Statistics*> &connections() const
+    {
+        return _connections;
+    }
+
+    /**
+     *  Aggregated statistics of all current and former connections
+     *  @return Statistics
+     */
+    Statistics statistics() const
+    {
+        // start with the totals of the former connections
+        Statistics result(_totals);
+
+        // add the current connections
+        for (auto &iter : _connections) result += *iter.second;
+
+        // done
+        return result;
+    }
+};
+
+/**
+ *  End namespace
+ */
+}}
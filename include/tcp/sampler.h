@@ -0,0 +1,174 @@
+/**
+ *  Sampler.h
+ *
+ *  Class that periodically asks the kernel for the TCP_INFO of a set of
+ *  connections (round trip time, congestion window and retransmits), and
+ *  stores it in the statistics of the connections. This makes it possible
+ *  to find out which peers are slow without external tools.
+ *
+ *  @copyright 2014 Copernica BV
+ */
+
+/**
+ *  Set up namespace
+ */
+namespace React { namespace Tcp {
+
+/**
+ *  Class definition
+ */
+class Sampler
+{
+private:
+    /**
+     *  The sampled connections
+     *  @var    Registry
+     */
+    std::shared_ptr<Registry> _registry = std::make_shared<Registry>();
+
+    /**
+     *  Callback that is called after a connection was sampled
+     *  @var    SampleCallback
+     */
+    SampleCallback _callback;
+
+    /**
+     *  The timer
+     *  @var    IntervalWatcher
+     */
+    IntervalWatcher _timer;
+
+    /**
+     *  Sample a single connection
+     *  @param  connection  The connection to sample
+     *  @return bool
+     */
+    static bool sample(Connection *connection)
+    {
+        // structure to fill
+        struct tcp_info info;
+        socklen_t size = sizeof(struct tcp_info);
+
+        // ask the kernel (this fails for unix domain connections)
+        if (getsockopt(connection->_socket.fd(), IPPROTO_TCP, TCP_INFO, &info, &size) != 0) return false;
+
+        // store the information
+        connection->_tracking->statistics.sample(info);
+
+        // done
+        return true;
+    }
+
+    /**
+     *  Sample all connections
+     */
+    void sample()
+    {
+        // without a callback we can simply process all connections
+        if (!_callback)
+        {
+            // sample the connections
+            for (auto &iter : _registry->connections()) sample(iter.first);
+        }
+        else
+        {
+            // the callback may destruct connections, so we work on a copy
+            std::vector<Connection*> connections;
+            connections.reserve(_registry->connections().size());
+
+            // copy the connections
+            for (auto &iter : _registry->connections()) connections.push_back(iter.first);
+
+            // keep a reference to the registry, the callback may destruct us
+            auto registry = _registry;
+
+            // process all connections
+            for (auto *connection : connections)
+            {
+                // skip connections that are gone
+                if (registry->connections().count(connection) == 0) continue;
+
+                // sample it and report it
+                if (sample(connection)) _callback(connection);
+
+                // leap out if the sampler was destructed
+                if (registry.use_count() == 1) return;
+            }
+        }
+    }
+
+public:
+    /**
+     *  Constructor
+     *  @param  loop        Event loop
+     *  @param  interval    Number of seconds between samples
+     *  @param  callback    Optional callback that is called for every sampled connection
+     */
+    Sampler(Loop *loop, Timestamp interval, const SampleCallback &callback = nullptr) :
+        _callback(callback),
+        _timer(loop, interval, [this]() -> bool { sample(); return true; }) {}
+
+    /**
+     *  Samplers can not be copied
+     *  @param  that
+     */
+    Sampler(const Sampler &that) = delete;
+
+    /**
+     *  Destructor
+     */
+    virtual ~Sampler()
+    {
+        // the connections no longer have to remember the registry
+        for (auto &iter : _registry->connections()) iter.first->_tracking->sampler = nullptr;
+    }
+
+    /**
+     *  Start sampling a connection
+     *  @param  connection  The connection to sample
+     */
+    void add(Connection *connection)
+    {
+        // sampled connections are tracked
+        connection->track();
+
+        // skip if already sampled by us
+        auto &tracking = *connection->_tracking;
+        if (tracking.sampler == _registry) return;
+
+        // remove from an other sampler
+        if (tracking.sampler) tracking.sampler->remove(connection);
+
+        // add to our registry
+        tracking.sampler = _registry;
+        _registry->add(connection, &tracking.statistics);
+    }
+
+    /**
+     *  Stop sampling a connection
+     *  @param  connection  The connection to forget
+     */
+    void remove(Connection *connection)
+    {
+        // skip if not sampled by us
+        if (!connection->_tracking || connection->_tracking->sampler != _registry) return;
+
+        // remove from the registry
+        _registry->remove(connection);
+        connection->_tracking->sampler = nullptr;
+    }
+
+    /**
+     *  Aggregated statistics of all connections that are or were sampled
+     *  @return Statistics
+     */
+    Statistics statistics() const
+    {
+        return _registry->statistics();
+    }
+};
+
+/**
+ *  End namespace
+ */
+}}
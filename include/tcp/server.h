@@ -23,11 +23,85 @@ private:
      */
     Socket _socket;
 
+    /**
+     *  Registry of the accepted connections, only when they are tracked
+     *  @var    Registry
+     */
+    std::shared_ptr<Registry> _registry;
+
+    /**
+     *  Timer for the deadline when the server is being drained
+     *  @var    TimeoutWatcher
+     */
+    std::shared_ptr<TimeoutWatcher> _drainTimer;
+
+    /**
+     *  Callback to call when the server is fully drained
+     *  @var    DrainCallback
+     */
+    DrainCallback _drainCallback;
+
     /**
      *  The Connection class is a friend
      */
     friend class Connection;
 
+    /**
+     *  Prepare an inherited socket before the server takes it over
+     *
+     *  Watch out! This method throws an exception if the socket is not
+     *  listening, the socket is then not closed.
+     *
+     *  @param  inherited   The inherited listening socket
+     *  @return int         The filedescriptor
+     */
+    static int prepare(const Inherited &inherited)
+    {
+        // the socket must be listening
+        if (!inherited.valid()) throw Exception("not a listening socket");
+
+        // the socket is probably blocking, but an other process may accept
+        // a pending connection before we do, so accepting should not block
+        int flags = fcntl(inherited.fd(), F_GETFL);
+        if (flags < 0 || fcntl(inherited.fd(), F_SETFL, flags | O_NONBLOCK) < 0) throw Exception(strerror(errno));
+
+        // the socket should not leak into processes that we start ourselves
+        fcntl(inherited.fd(), F_SETFD, FD_CLOEXEC);
+
+        // done
+        return inherited.fd();
+    }
+
+    /**
+     *  Abort all connections that still exist after the drain deadline
+     *
+     *  This method is implemented in connection.h, because it needs the
+     *  full definition of the Connection class
+     */
+    void expire();
+
+    /**
+     *  Called when draining is complete
+     */
+    void drained()
+    {
+        // no longer interested in the connections
+        if (_registry) _registry->onEmpty(nullptr);
+
+        // stop the timer
+        if (_drainTimer) _drainTimer->cancel();
+        _drainTimer = nullptr;
+
+        // copy the callback, because calling it might destruct the object
+        auto callback = _drainCallback;
+
+        // forget the callback
+        _drainCallback = nullptr;
+
+        // report that we're done
+        if (callback) callback();
+    }
+
 public:
     /**
      *  Constructor to listen to a specific port on a specific IP
@@ -78,10 +152,33 @@ public:
     Server(Loop *loop) :
         Server(loop, Net::Ip(), 0) {}
 
+    /**
+     *  Constructor to take over a listening socket from an other process
+     *
+     *  The socket is already bound and listening, so the server can accept
+     *  connections right away. Connections that were waiting in the backlog
+     *  of the socket are not lost. The socket is made non-blocking, because
+     *  an other process that shares it may accept a connection before we do.
+     *
+     *  Watch out! The constructor will throw an exception in case of an error.
+     *
+     *  @param  loop        Event loop
+     *  @param  inherited   The inherited listening socket
+     */
+    Server(Loop *loop, const Inherited &inherited) :
+        _socket(loop, prepare(inherited)) {}
+
     /**
      *  Destructor
      */
-    virtual ~Server() {}
+    virtual ~Server()
+    {
+        // connections that are destructed later should not notify us
+        if (_registry) _registry->onEmpty(nullptr);
+
+        // stop the drain timer
+        if (_drainTimer) _drainTimer->cancel();
+    }
 
     /**
      *  Install connect handler
@@ -95,6 +192,124 @@ public:
         _socket.onReadable(callback);
     }
 
+    /**
+     *  Stop accepting connections and close the listening socket
+     *
+     *  When the socket was exposed to an other process, that process can
+     *  still accept connections on it.
+     *
+     *  @return bool
+     */
+    bool close()
+    {
+        // no longer interested in incoming connections
+        _socket.onReadable(nullptr);
+
+        // close the socket
+        return _socket.close();
+    }
+
+    /**
+     *  Keep track of the connections that are accepted from now on
+     *
+     *  Tracked connections count their traffic and register with the server,
+     *  which is needed for connections(), statistics() and drain(). This costs
+     *  an allocation per connection, so servers do not do this by default.
+     */
+    void track()
+    {
+        // skip if already tracking
+        if (_registry) return;
+
+        // create the registry
+        _registry = std::make_shared<Registry>();
+    }
+
+    /**
+     *  Drain the server
+     *
+     *  The server stops accepting connections, and the tracked connections
+     *  (see track()) are wound down. Connections with a drain handler (installed
+     *  with Connection::onDrain()) are notified so that they can finish their
+     *  work, the other connections are considered idle and are half-closed
+     *  all at once. Connections that still exist when the timeout expires are
+     *  aborted, to free their filedescriptors and buffers fast.
+     *
+     *  The callback is called when all connections are destructed, or when
+     *  the timeout expires, whatever comes first.
+     *
+     *  A server that does not track its connections does not know what to
+     *  drain. The method then returns false, and does nothing at all.
+     *
+     *  This method is implemented in connection.h, because it needs the
+     *  full definition of the Connection class
+     *
+     *  @param  timeout     Max time for the connections to finish
+     *  @param  callback    Function that is called when the server is drained
+     *  @return bool
+     */
+    bool drain(Timestamp timeout, const DrainCallback &callback = nullptr);
+
+    /**
+     *  Retrieve the filedescriptor of the listening socket
+     *
+     *  You can use this to pass the socket to an other process over a unix
+     *  domain connection, see Connection::send().
+     *
+     *  @return int
+     */
+    int fd() const
+    {
+        return _socket.fd();
+    }
+
+    /**
+     *  Expose the listening socket to processes that are started with exec()
+     *
+     *  The close-on-exec flag is removed from the socket, and the filedescriptor
+     *  is appended to a comma separated list in an environment variable. The
+     *  new process can take over the socket by constructing a server with
+     *  Tcp::Inherited(variable, index).
+     *
+     *  @param  variable    Name of the environment variable
+     *  @return bool
+     */
+    bool expose(const char *variable) const
+    {
+        // the socket should survive an exec() call
+        if (fcntl(_socket.fd(), F_SETFD, 0) != 0) return false;
+
+        // the current value
+        const char *current = getenv(variable);
+
+        // construct the new value
+        std::string value(current ? current : "");
+        if (!value.empty()) value.append(",");
+        value.append(std::to_string(_socket.fd()));
+
+        // update the environment
+        return setenv(variable, value.c_str(), 1) == 0;
+    }
+
+    /**
+     *  Number of tracked connections that still exist
+     *  @return size_t
+     */
+    size_t connections() const
+    {
+        return _registry ? _registry->connections().size() : 0;
+    }
+
+    /**
+     *  Aggregated statistics of all tracked connections that were accepted by
+     *  this server, including the connections that no longer exist
+     *  @return Statistics
+     */
+    Statistics statistics() const
+    {
+        return _registry ? _registry->statistics() : Statistics();
+    }
+
     /**
      *  Retrieve the address to which the server is listening
      *  @return Net::Address
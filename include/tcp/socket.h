@@ -10,6 +10,8 @@
  *  Dependencies
  */
 #include <sys/un.h>
+#include <sys/socket.h>
+#include <sys/uio.h>
 
 /**
  *  Set up namespace
@@ -22,6 +24,12 @@ namespace React { namespace Tcp {
 class Socket : public Fd
 {
 private:
+    /**
+     *  Max number of filedescriptors that can be passed in a single message
+     *  (this is the SCM_MAX_FD limit of the linux kernel)
+     */
+    static constexpr size_t maxfds = 253;
+
     /**
      *  Helper method to bind the socket to an IPv4 address and port
      *  @param  ip          IP to bind to
@@ -174,6 +182,12 @@ public:
         // really apply to unix domain sockets in any case
     }
 
+    /**
+     *  The Connection and Server classes may wrap existing sockets
+     */
+    friend class Connection;
+    friend class Server;
+
     /**
      *  Sockets can not be copied
      *  @param  socket
@@ -208,6 +222,32 @@ public:
         return PeerAddress(_fd).valid();
     }
 
+    /**
+     *  The pending error on the socket
+     *
+     *  After a non-blocking connect() the socket becomes writable when the
+     *  connection was established or when the attempt failed. This method
+     *  returns the errno value of the failed attempt, or zero on success.
+     *  Note that reading the error also clears it.
+     *
+     *  @return int
+     */
+    int error() const
+    {
+        // filedescriptor must be valid
+        if (_fd < 0) return EBADF;
+
+        // the error code and its size
+        int result = 0;
+        socklen_t size = sizeof(result);
+
+        // fetch the error from the socket
+        if (getsockopt(_fd, SOL_SOCKET, SO_ERROR, &result, &size) < 0) return errno;
+
+        // done
+        return result;
+    }
+
     /**
      *  Connect the socket to a remote IPv4 address
      *  @param  ip
@@ -373,6 +413,155 @@ public:
         return ::recv(_fd, buf, len, flags);
     }
 
+    /**
+     *  Send data together with a number of filedescriptors
+     *
+     *  This only works for unix domain sockets. The filedescriptors are sent
+     *  as SCM_RIGHTS ancillary data together with the data, so that the
+     *  receiving process gets its own copies of them. At least one byte of
+     *  data has to be sent, and at most 253 filedescriptors per message.
+     *
+     *  @param  buf     Pointer to a buffer
+     *  @param  len     Size of the buffer
+     *  @param  fds     Array of filedescriptors to send
+     *  @param  count   Number of filedescriptors in the array
+     *  @param  flags   Optional additional flags
+     *  @return ssize_t Number of bytes sent
+     */
+    ssize_t send(const void *buf, size_t len, const int *fds, size_t count, int flags = 0) const
+    {
+        // check the number of filedescriptors
+        if (count > maxfds) { errno = EINVAL; return -1; }
+
+        // buffer for the ancillary data, aligned for a cmsghdr
+        union {
+            char buffer[CMSG_SPACE(sizeof(int) * maxfds)];
+            struct cmsghdr align;
+        } control;
+
+        // the data to send
+        struct iovec iov;
+        iov.iov_base = const_cast<void *>(buf);
+        iov.iov_len = len;
+
+        // the message header
+        struct msghdr header;
+        memset(&header, 0, sizeof(struct msghdr));
+        header.msg_iov = &iov;
+        header.msg_iovlen = 1;
+
+        // is there something to pass?
+        if (count > 0)
+        {
+            // set up the ancillary data
+            header.msg_control = control.buffer;
+            header.msg_controllen = CMSG_SPACE(sizeof(int) * count);
+
+            // fill the message with the filedescriptors
+            auto *cmsg = CMSG_FIRSTHDR(&header);
+            cmsg->cmsg_level = SOL_SOCKET;
+            cmsg->cmsg_type = SCM_RIGHTS;
+            cmsg->cmsg_len = CMSG_LEN(sizeof(int) * count);
+            memcpy(CMSG_DATA(cmsg), fds, sizeof(int) * count);
+        }
+
+        // send the message
+        return ::sendmsg(_fd, &header, flags | MSG_NOSIGNAL);
+    }
+
+    /**
+     *  Receive data together with a number of filedescriptors
+     *
+     *  The counterpart of the send() method that passes filedescriptors. The
+     *  count parameter should hold the capacity of the array when the method
+     *  is called, and is updated to the number of received filedescriptors.
+     *  The received filedescriptors have the close-on-exec flag set, and it
+     *  is your own responsibility to close them.
+     *
+     *  The truncated parameter is set when not all filedescriptors that were
+     *  passed could be handed out: because they did not fit in the array, or
+     *  because the kernel had to drop some of them (for example because
+     *  credentials were passed too). The filedescriptors are then all closed
+     *  and count is set to zero, but the data is received as usual, so that
+     *  the stream stays in sync.
+     *
+     *  @param  buf         Pointer to a buffer
+     *  @param  len         Size of the buffer
+     *  @param  fds         Array to be filled with filedescriptors
+     *  @param  count       Capacity of the array, updated to the number received
+     *  @param  truncated   Set to whether filedescriptors were lost
+     *  @param  flags       Optional additional flags
+     *  @return ssize_t     Number of bytes received
+     */
+    ssize_t recv(void *buf, size_t len, int *fds, size_t &count, bool &truncated, int flags = 0) const
+    {
+        // buffer for the ancillary data, aligned for a cmsghdr
+        union {
+            char buffer[CMSG_SPACE(sizeof(int) * maxfds)];
+            struct cmsghdr align;
+        } control;
+
+        // the buffer to fill
+        struct iovec iov;
+        iov.iov_base = buf;
+        iov.iov_len = len;
+
+        // the message header
+        struct msghdr header;
+        memset(&header, 0, sizeof(struct msghdr));
+        header.msg_iov = &iov;
+        header.msg_iovlen = 1;
+        header.msg_control = control.buffer;
+        header.msg_controllen = sizeof(control.buffer);
+
+        // capacity of the array
+        size_t capacity = count;
+
+        // nothing received so far
+        count = 0;
+        truncated = false;
+
+        // receive the message
+        ssize_t result = ::recvmsg(_fd, &header, flags | MSG_CMSG_CLOEXEC);
+        if (result < 0) return result;
+
+        // loop through the ancillary data
+        for (auto *cmsg = CMSG_FIRSTHDR(&header); cmsg; cmsg = CMSG_NXTHDR(&header, cmsg))
+        {
+            // we only care about passed filedescriptors
+            if (cmsg->cmsg_level != SOL_SOCKET || cmsg->cmsg_type != SCM_RIGHTS) continue;
+
+            // number of filedescriptors in this message
+            size_t received = (cmsg->cmsg_len - CMSG_LEN(0)) / sizeof(int);
+
+            // process all filedescriptors
+            for (size_t i = 0; i < received; i++)
+            {
+                // get the filedescriptor
+                int fd;
+                memcpy(&fd, CMSG_DATA(cmsg) + i * sizeof(int), sizeof(int));
+
+                // store it when there is room, otherwise we close it right away
+                if (count < capacity) fds[count++] = fd;
+                else { ::close(fd); truncated = true; }
+            }
+        }
+
+        // the kernel may have dropped filedescriptors too
+        if (header.msg_flags & MSG_CTRUNC) truncated = true;
+
+        // done if the set of filedescriptors is complete
+        if (!truncated) return result;
+
+        // an incomplete set is not handed out, but the data was taken off
+        // the stream, so it is still returned
+        for (size_t i = 0; i < count; i++) ::close(fds[i]);
+        count = 0;
+
+        // done
+        return result;
+    }
+
     /**
      *  Close the socket
      *  @return bool
@@ -389,6 +578,43 @@ public:
         return true;
     }
 
+    /**
+     *  Shut down the connection, or one direction of it
+     *
+     *  With SHUT_WR the peer receives an end-of-file once the data that
+     *  was already sent has arrived, while data can still be received.
+     *
+     *  @param  how     SHUT_RD, SHUT_WR or SHUT_RDWR
+     *  @return bool
+     */
+    bool shutdown(int how = SHUT_WR) const
+    {
+        return ::shutdown(_fd, how) == 0;
+    }
+
+    /**
+     *  Close the socket right away, and reset the connection
+     *
+     *  Data that was not yet sent is discarded and the peer receives a reset
+     *  instead of an orderly end-of-file. The socket does not linger in the
+     *  TIME_WAIT state, so its resources are freed immediately.
+     *
+     *  @return bool
+     */
+    bool abort()
+    {
+        // linger with a zero timeout, so that close() sends a reset
+        struct linger value;
+        value.l_onoff = 1;
+        value.l_linger = 0;
+
+        // set the option, this fails when the socket is already closed
+        setsockopt(_fd, SOL_SOCKET, SO_LINGER, &value, sizeof(value));
+
+        // close the socket
+        return close();
+    }
+
 };
 
 /**
@@ -0,0 +1,294 @@
+/**
+ *  Statistics.h
+ *
+ *  Counters that are kept for a tracked Tcp::Connection (see
+ *  Connection::track() and Server::track()). They are cheap to maintain
+ *  (a couple of increments per system call), and can be aggregated per
+ *  server. The round trip time, congestion window and
+ *  retransmits are only filled when the connection is added to a
+ *  Tcp::Sampler, which reads them from the kernel with TCP_INFO.
+ *
+ *  @copyright 2014 Copernica BV
+ */
+
+/**
+ *  Dependencies
+ */
+#include <netinet/tcp.h>
+
+/**
+ *  Set up namespace
+ */
+namespace React { namespace Tcp {
+
+/**
+ *  Class definition
+ */
+class Statistics
+{
+private:
+    /**
+     *  Number of bytes received and sent
+     *  @var    uint64_t
+     */
+    uint64_t _bytesIn = 0;
+    uint64_t _bytesOut = 0;
+
+    /**
+     *  Number of receive and send system calls
+     *  @var    uint64_t
+     */
+    uint64_t _recvCalls = 0;
+    uint64_t _sendCalls = 0;
+
+    /**
+     *  Number of receive and send system calls that failed with EAGAIN
+     *  @var    uint64_t
+     */
+    uint64_t _recvAgain = 0;
+    uint64_t _sendAgain = 0;
+
+    /**
+     *  Number of seconds it took to set up the connection
+     *  @var    Timestamp
+     */
+    Timestamp _connectTime = 0.0;
+
+    /**
+     *  Max number of bytes that were buffered in a Tcp::Out object
+     *  @var    size_t
+     */
+    size_t _peakBuffer = 0;
+
+    /**
+     *  Smoothed round trip time and its variance, in microseconds
+     *  @var    uint32_t
+     */
+    uint32_t _rtt = 0;
+    uint32_t _rttVariance = 0;
+
+    /**
+     *  Congestion window, in segments
+     *  @var    uint32_t
+     */
+    uint32_t _cwnd = 0;
+
+    /**
+     *  Total number of retransmitted segments
+     *  @var    uint32_t
+     */
+    uint32_t _retransmits = 0;
+
+    /**
+     *  Record the result of a receive system call
+     *  @param  result      Return value of the system call
+     */
+    void received(ssize_t result)
+    {
+        // one more call
+        _recvCalls += 1;
+
+        // update the counters
+        if (result > 0) _bytesIn += result;
+        else if (result < 0 && (errno == EAGAIN || errno == EWOULDBLOCK)) _recvAgain += 1;
+    }
+
+    /**
+     *  Record the result of a send system call
+     *  @param  result      Return value of the system call
+     */
+    void sent(ssize_t result)
+    {
+        // one more call
+        _sendCalls += 1;
+
+        // update the counters
+        if (result > 0) _bytesOut += result;
+        else if (result < 0 && (errno == EAGAIN || errno == EWOULDBLOCK)) _sendAgain += 1;
+    }
+
+    /**
+     *  Record the size of an output buffer
+     *  @param  size        Number of bytes buffered
+     */
+    void buffered(size_t size)
+    {
+        // update the peak
+        if (size > _peakBuffer) _peakBuffer = size;
+    }
+
+    /**
+     *  Record information that was retrieved from the kernel
+     *  @param  info        The TCP_INFO structure
+     */
+    void sample(const struct tcp_info &info)
+    {
+        // copy the relevant members
+        _rtt = info.tcpi_rtt;
+        _rttVariance = info.tcpi_rttvar;
+        _cwnd = info.tcpi_snd_cwnd;
+        _retransmits = info.tcpi_total_retrans;
+    }
+
+    /**
+     *  The classes that update the counters
+     */
+    friend class Connection;
+    friend class Out;
+    friend class Sampler;
+
+public:
+    /**
+     *  Constructor
+     */
+    Statistics() {}
+
+    /**
+     *  Destructor
+     */
+    virtual ~Statistics() {}
+
+    /**
+     *  Add the counters of an other object, this can be used to aggregate the
+     *  statistics of multiple connections. Counters and retransmits are summed,
+     *  the connect time, the peak buffer size and the rtt, rtt variance and
+     *  congestion window are set to the max of both objects.
+     *
+     *  @param  that        The statistics to add
+     *  @return Statistics
+     */
+    Statistics &operator+=(const Statistics &that)
+    {
+        // sum the counters
+        _bytesIn += that._bytesIn;
+        _bytesOut += that._bytesOut;
+        _recvCalls += that._recvCalls;
+        _sendCalls += that._sendCalls;
+        _recvAgain += that._recvAgain;
+        _sendAgain += that._sendAgain;
+        _retransmits += that._retransmits;
+
+        // use the max for the other members
+        _connectTime = std::max(_connectTime, that._connectTime);
+        _peakBuffer = std::max(_peakBuffer, that._peakBuffer);
+        _rtt = std::max(_rtt, that._rtt);
+        _rttVariance = std::max(_rttVariance, that._rttVariance);
+        _cwnd = std::max(_cwnd, that._cwnd);
+
+        // done
+        return *this;
+    }
+
+    /**
+     *  Number of bytes received
+     *  @return uint64_t
+     */
+    uint64_t bytesIn() const
+    {
+        return _bytesIn;
+    }
+
+    /**
+     *  Number of bytes sent
+     *  @return uint64_t
+     */
+    uint64_t bytesOut() const
+    {
+        return _bytesOut;
+    }
+
+    /**
+     *  Number of receive system calls
+     *  @return uint64_t
+     */
+    uint64_t recvCalls() const
+    {
+        return _recvCalls;
+    }
+
+    /**
+     *  Number of send system calls
+     *  @return uint64_t
+     */
+    uint64_t sendCalls() const
+    {
+        return _sendCalls;
+    }
+
+    /**
+     *  Number of receive system calls that failed with EAGAIN
+     *  @return uint64_t
+     */
+    uint64_t recvAgain() const
+    {
+        return _recvAgain;
+    }
+
+    /**
+     *  Number of send system calls that failed with EAGAIN
+     *  @return uint64_t
+     */
+    uint64_t sendAgain() const
+    {
+        return _sendAgain;
+    }
+
+    /**
+     *  Number of seconds it took to connect (zero for accepted connections)
+     *  @return Timestamp
+     */
+    Timestamp connectTime() const
+    {
+        return _connectTime;
+    }
+
+    /**
+     *  Max number of bytes that were buffered in the output buffer
+     *  @return size_t
+     */
+    size_t peakBuffer() const
+    {
+        return _peakBuffer;
+    }
+
+    /**
+     *  Smoothed round trip time in microseconds
+     *  @return uint32_t
+     */
+    uint32_t rtt() const
+    {
+        return _rtt;
+    }
+
+    /**
+     *  Variance of the round trip time in microseconds
+     *  @return uint32_t
+     */
+    uint32_t rttVariance() const
+    {
+        return _rttVariance;
+    }
+
+    /**
+     *  Congestion window in segments
+     *  @return uint32_t
+     */
+    uint32_t cwnd() const
+    {
+        return _cwnd;
+    }
+
+    /**
+     *  Total number of retransmitted segments
+     *  @return uint32_t
+     */
+    uint32_t retransmits() const
+    {
+        return _retransmits;
+    }
+};
+
+/**
+ *  End namespace
+ */
+}}
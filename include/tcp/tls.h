@@ -0,0 +1,572 @@
+/**
+ *  Tls.h
+ *
+ *  TLS layer for a Tcp::Connection. Construct it on a connection that is
+ *  connected, and the handshake starts right away. This can be a connection
+ *  that was just set up, or a connection that already exchanged plain text,
+ *  like an SMTP connection after the STARTTLS command. Make sure that the
+ *  Tcp::In and Tcp::Out objects do not hold any plain text data anymore.
+ *
+ *  The handlers that were installed on the connection are removed when the
+ *  handshake starts. Handlers that are installed during the handshake (for
+ *  example by Tcp::In and Tcp::Out objects) become active when it completes.
+ *  After the handshake all data that is sent and received via the connection
+ *  is encrypted, so that the Tcp::In and Tcp::Out classes work just the same.
+ *
+ *  OpenSSL reads and writes the socket itself. When the kernel supports TLS
+ *  (the "tls" module) and the cipher allows it, OpenSSL moves the encryption
+ *  into the kernel after the handshake. Outgoing data is then written to the
+ *  socket straight from the output buffer, without being copied.
+ *
+ *  This file is not included by reactcpp.h. If you want to use it, you
+ *  should include it yourself after tlscontext.h, and link your application
+ *  with -lssl and -lcrypto.
+ *
+ *  @copyright 2014 Copernica BV
+ */
+
+/**
+ *  Set up namespace
+ */
+namespace React { namespace Tcp {
+
+/**
+ *  Class definition
+ */
+class Tls : public Layer
+{
+private:
+    /**
+     *  The connection
+     *  @var    Connection
+     */
+    Connection *_connection;
+
+    /**
+     *  The shared settings
+     *  @var    TlsContext
+     */
+    std::shared_ptr<TlsContext> _context;
+
+    /**
+     *  The OpenSSL connection
+     *  @var    SSL
+     */
+    SSL *_ssl = nullptr;
+
+    /**
+     *  Callback for when the handshake is done
+     *  @var    ConnectedCallback
+     */
+    ConnectedCallback _callback;
+
+    /**
+     *  Is the handshake completed?
+     *  @var    bool
+     */
+    bool _secured = false;
+
+    /**
+     *  Does the kernel encrypt the outgoing data?
+     *  @var    bool
+     */
+    bool _offloaded = false;
+
+    /**
+     *  Buffer to combine small blocks of data into a single record
+     *  @var    char[]
+     */
+    char _record[16384];
+
+    /**
+     *  Watcher for room in the socket, when a read has to write first
+     *  @var    WriteWatcher
+     */
+    std::shared_ptr<WriteWatcher> _retry;
+
+    /**
+     *  Translate a failed OpenSSL call into a system call result
+     *  @param  result      Return value of the OpenSSL call
+     *  @param  writing     Was data being written?
+     *  @return ssize_t     Zero for end-of-file, -1 with errno set otherwise
+     */
+    ssize_t failure(int result, bool writing) const
+    {
+        // check the reason
+        switch (SSL_get_error(_ssl, result)) {
+        case SSL_ERROR_WANT_READ:
+        case SSL_ERROR_WANT_WRITE:
+            // try again later
+            errno = EAGAIN;
+            return -1;
+
+        case SSL_ERROR_ZERO_RETURN:
+            // the peer closed the stream
+            if (!writing) return 0;
+            errno = EPIPE;
+            return -1;
+
+        case SSL_ERROR_SYSCALL:
+            // errno is already set, unless the connection was simply gone
+            if (errno == 0 || errno == EAGAIN) errno = ECONNRESET;
+            return -1;
+
+        default:
+            // the stream is corrupt
+            errno = EPROTO;
+            return -1;
+        }
+    }
+
+    /**
+     *  Wait for room in the socket, because OpenSSL has to write before it
+     *  can read on (for example to answer a key update)
+     */
+    void wait()
+    {
+        // skip if already waiting
+        if (_retry) return;
+
+        // the socket stays readable, so we stop reading to prevent a busy loop
+        Socket &socket = _connection->_socket;
+        socket.onReadable(nullptr);
+
+        // retry the read once there is room
+        _retry = socket.loop()->onWritable(socket.fd(), [this]() -> bool { retry(); return false; });
+    }
+
+    /**
+     *  Retry a read that had to wait for room in the socket
+     */
+    void retry()
+    {
+        // the watcher is done
+        _retry = nullptr;
+
+        // the handler that reads from the connection
+        auto callback = _connection->_readCallback;
+        if (!callback || _connection->_status != Connection::connected) return;
+
+        // watch for readability again
+        auto watcher = _connection->_socket.onReadable(callback);
+
+        // decrypted data does not make the socket readable, so we read right
+        // away, this may destruct us, but our reference keeps the watcher
+        if (!callback()) watcher->cancel();
+    }
+
+    /**
+     *  Description of the error that made the handshake fail
+     *  @param  result      Return value of the OpenSSL call
+     *  @return const char*
+     */
+    const char *reason(int result) const
+    {
+        // check the error queue of OpenSSL
+        const char *reason = ERR_reason_error_string(ERR_peek_last_error());
+        if (reason) return reason;
+
+        // the system call might have failed
+        if (SSL_get_error(_ssl, result) == SSL_ERROR_SYSCALL && errno != 0) return strerror(errno);
+
+        // we have no details
+        return "tls handshake failed";
+    }
+
+    /**
+     *  Take the next step in the handshake
+     */
+    void handshake()
+    {
+        // start with a clean error queue, so that we get the right errors
+        ERR_clear_error();
+
+        // take the step
+        int result = SSL_do_handshake(_ssl);
+
+        // are we done?
+        if (result == 1) return complete();
+
+        // the socket that we're waiting for
+        Socket &socket = _connection->_socket;
+
+        // check what we're waiting for
+        switch (SSL_get_error(_ssl, result)) {
+        case SSL_ERROR_WANT_READ:
+            // wait for the next message
+            socket.onWritable(nullptr);
+            socket.onReadable([this]() -> bool { handshake(); return false; });
+            return;
+
+        case SSL_ERROR_WANT_WRITE:
+            // wait for room in the socket
+            socket.onReadable(nullptr);
+            socket.onWritable([this]() -> bool { handshake(); return false; });
+            return;
+
+        default:
+            // the handshake failed
+            return failed(reason(result));
+        }
+    }
+
+    /**
+     *  The handshake is completed
+     */
+    void complete()
+    {
+        // the stream is secure
+        _secured = true;
+
+        // does the kernel do the encryption from now on?
+        _offloaded = BIO_get_ktls_send(SSL_get_wbio(_ssl));
+
+        // the socket and the connection
+        Socket &socket = _connection->_socket;
+        Connection *connection = _connection;
+
+        // the connection can be used again
+        connection->_status = Connection::connected;
+
+        // install the handlers that were assigned during the handshake
+        socket.onReadable(connection->_readCallback);
+        socket.onWritable(connection->_writeCallback);
+
+        // we no longer need the cached write handler, the read handler is
+        // kept because a read may have to wait for room in the socket
+        connection->_writeCallback = nullptr;
+
+        // copy the callback, because calling it might destruct the object
+        auto callback = _callback;
+
+        // the callback is called only once
+        _callback = nullptr;
+
+        // report to the callback
+        if (callback) callback(nullptr);
+    }
+
+    /**
+     *  The handshake failed
+     *  @param  error       Description of the error
+     */
+    void failed(const char *error)
+    {
+        // copy the callback, because calling it might destruct the object
+        auto callback = _callback;
+
+        // the callback is called only once
+        _callback = nullptr;
+
+        // stop the handshake
+        _connection->_socket.onReadable(nullptr);
+        _connection->_socket.onWritable(nullptr);
+
+        // the connection can not be used anymore
+        _connection->_layer = nullptr;
+        _connection->close();
+
+        // report the error to the callback
+        if (callback) callback(error);
+    }
+
+public:
+    /**
+     *  Constructor
+     *
+     *  Whether the handshake is done as client or as server depends on the
+     *  context. Clients should pass the name of the server, which is sent to
+     *  the server, checked against its certificate, and used to find the
+     *  session of a previous connection to resume.
+     *
+     *  Watch out! The constructor will throw an exception in case of an error.
+     *
+     *  @param  connection  Connected connection
+     *  @param  context     Shared settings
+     *  @param  callback    Function that is called when the handshake is done
+     *  @param  name        Host name of the server (only for clients)
+     */
+    Tls(Connection *connection, const std::shared_ptr<TlsContext> &context, const ConnectedCallback &callback, const char *name = nullptr) :
+        _connection(connection), _context(context), _callback(callback)
+    {
+        // the connection should be connected, and not have a layer yet
+        if (connection->_status != Connection::connected || connection->_layer) throw Exception("connection is not ready for tls");
+
+        // create the OpenSSL connection
+        _ssl = SSL_new(context->handle());
+
+        // check for errors
+        if (_ssl == nullptr) throw Exception("failed to create tls connection");
+
+        // OpenSSL uses the socket directly
+        SSL_set_fd(_ssl, connection->_socket.fd());
+
+        // the role depends on the context
+        if (context->server()) SSL_set_accept_state(_ssl);
+        else SSL_set_connect_state(_ssl);
+
+        // clients send the name of the server, and check it
+        if (!context->server() && name)
+        {
+            // send it, and check it against the certificate
+            SSL_set_tlsext_host_name(_ssl, name);
+            SSL_set1_host(_ssl, name);
+
+            // offer the session of a previous connection
+            SSL_SESSION *session = context->session(name);
+            if (session) SSL_set_session(_ssl, session);
+        }
+
+        // all data passes through us, but only after the handshake
+        connection->_layer = this;
+        connection->_status = Connection::securing;
+
+        // start the handshake
+        handshake();
+    }
+
+    /**
+     *  Tls objects can not be copied
+     *  @param  that
+     */
+    Tls(const Tls &that) = delete;
+
+    /**
+     *  Destructor
+     *
+     *  The connection can not be used without the layer, so if it is still
+     *  open it is closed. This is done without telling the peer that the
+     *  stream ends, use Connection::close() or Out::close() for that.
+     */
+    virtual ~Tls()
+    {
+        // a read no longer has to be retried
+        if (_retry) _retry->cancel();
+
+        // is the connection still using us?
+        if (_connection->_layer == this)
+        {
+            // stop the handshake, if it was still busy
+            if (!_secured) _connection->_socket.onReadable(nullptr);
+            if (!_secured) _connection->_socket.onWritable(nullptr);
+
+            // forget the layer
+            _connection->_layer = nullptr;
+
+            // close the connection
+            if (_connection->_status != Connection::closed) _connection->close();
+        }
+
+        // OpenSSL only resumes sessions of streams that were closed properly,
+        // which is the case when the peer ended the stream
+        if (SSL_get_shutdown(_ssl) & SSL_RECEIVED_SHUTDOWN) SSL_set_shutdown(_ssl, SSL_SENT_SHUTDOWN | SSL_RECEIVED_SHUTDOWN);
+
+        // free the OpenSSL connection
+        SSL_free(_ssl);
+    }
+
+    /**
+     *  Send data
+     *  @param  buf     Pointer to a buffer
+     *  @param  len     Size of the buffer
+     *  @return ssize_t Number of bytes sent
+     */
+    virtual ssize_t send(const void *buf, size_t len) override
+    {
+        // no data can be sent during the handshake
+        if (!_secured) { errno = EAGAIN; return -1; }
+
+        // the kernel might encrypt the data
+        if (_offloaded) return _connection->_socket.send(buf, len);
+
+        // nothing to send
+        if (len == 0) return 0;
+
+        // start with a clean error queue, so that we get the right errors
+        ERR_clear_error();
+
+        // encrypt and send the data
+        size_t bytes;
+        int result = SSL_write_ex(_ssl, buf, len, &bytes);
+
+        // check the result
+        return result == 1 ? bytes : failure(result, true);
+    }
+
+    /**
+     *  Send data from multiple buffers
+     *
+     *  Small buffers are combined into a single record, because each record
+     *  costs a system call and adds a header and an authentication tag.
+     *
+     *  @param  iov     Array of struct iovec objects
+     *  @param  iovcnt  Number of items in the array
+     *  @return ssize_t Number of bytes sent
+     */
+    virtual ssize_t writev(const struct iovec *iov, int iovcnt) override
+    {
+        // no data can be sent during the handshake
+        if (!_secured) { errno = EAGAIN; return -1; }
+
+        // the kernel might encrypt the data
+        if (_offloaded) return _connection->_socket.writev(iov, iovcnt);
+
+        // nothing to send
+        if (iovcnt == 0) return 0;
+
+        // a single buffer, or a first buffer that fills a record, is sent as is
+        if (iovcnt == 1 || iov[0].iov_len >= sizeof(_record)) return send(iov[0].iov_base, iov[0].iov_len);
+
+        // fill the record with as many buffers as fit
+        size_t size = 0;
+        for (int i = 0; i < iovcnt && size < sizeof(_record); ++i)
+        {
+            // number of bytes to copy from this buffer
+            size_t bytes = std::min(iov[i].iov_len, sizeof(_record) - size);
+
+            // copy them
+            memcpy(_record + size, iov[i].iov_base, bytes);
+            size += bytes;
+        }
+
+        // send the record
+        return send(_record, size);
+    }
+
+    /**
+     *  Receive data
+     *
+     *  The buffer is filled as far as possible, so that a short read means
+     *  that both the socket and the layer are drained.
+     *
+     *  @param  buf     Pointer to a buffer
+     *  @param  len     Size of the buffer
+     *  @return ssize_t Number of bytes received
+     */
+    virtual ssize_t recv(void *buf, size_t len) override
+    {
+        // no data can be received during the handshake
+        if (!_secured) { errno = EAGAIN; return -1; }
+
+        // number of bytes received so far
+        size_t total = 0;
+
+        // keep going until the buffer is full
+        while (total < len)
+        {
+            // start with a clean error queue, so that we get the right errors
+            ERR_clear_error();
+
+            // receive and decrypt data
+            size_t bytes;
+            int result = SSL_read_ex(_ssl, (char *)buf + total, len - total, &bytes);
+
+            // on success we try to get more
+            if (result == 1) { total += bytes; continue; }
+
+            // when OpenSSL has to write first, the socket has to become
+            // writable before the read can go on
+            if (SSL_get_error(_ssl, result) == SSL_ERROR_WANT_WRITE) wait();
+
+            // report the data that we have, an error shows up again next time
+            return total > 0 ? total : failure(result, false);
+        }
+
+        // the buffer is full
+        return total;
+    }
+
+    /**
+     *  Number of decrypted bytes that were not yet received
+     *  @return size_t
+     */
+    virtual size_t pending() const override
+    {
+        return _secured ? SSL_pending(_ssl) : 0;
+    }
+
+    /**
+     *  Called right before the writing side of the connection is shut down
+     */
+    virtual void shutdown() override
+    {
+        // skip if there is no secure stream yet
+        if (!_secured) return;
+
+        // start with a clean error queue, so that we get the right errors
+        ERR_clear_error();
+
+        // tell the peer that the stream ends here, this is not repeated
+        // when the socket is full, because the connection closes anyway
+        SSL_shutdown(_ssl);
+    }
+
+    /**
+     *  Is the handshake completed?
+     *  @return bool
+     */
+    bool secured() const
+    {
+        return _secured;
+    }
+
+    /**
+     *  Was the session of a previous connection resumed?
+     *  @return bool
+     */
+    bool resumed() const
+    {
+        return SSL_session_reused(_ssl) == 1;
+    }
+
+    /**
+     *  Does the kernel encrypt the outgoing data?
+     *  @return bool
+     */
+    bool kernelSend() const
+    {
+        return _offloaded;
+    }
+
+    /**
+     *  Does the kernel decrypt the incoming data?
+     *  @return bool
+     */
+    bool kernelReceive() const
+    {
+        return _secured && BIO_get_ktls_recv(SSL_get_rbio(_ssl));
+    }
+
+    /**
+     *  The protocol version, like "TLSv1.3"
+     *  @return const char*
+     */
+    const char *protocol() const
+    {
+        return SSL_get_version(_ssl);
+    }
+
+    /**
+     *  Name of the cipher, or nullptr during the handshake
+     *  @return const char*
+     */
+    const char *cipher() const
+    {
+        return _secured ? SSL_get_cipher_name(_ssl) : nullptr;
+    }
+
+    /**
+     *  The underlying OpenSSL connection, for example to inspect the
+     *  certificate of the peer
+     *  @return SSL
+     */
+    SSL *handle() const
+    {
+        return _ssl;
+    }
+};
+
+/**
+ *  End namespace
+ */
+}}
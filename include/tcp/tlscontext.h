@@ -0,0 +1,328 @@
+/**
+ *  TlsContext.h
+ *
+ *  Settings that are shared by a group of Tcp::Tls connections: the mode
+ *  (client or server), the certificate, the trusted authorities and the
+ *  session cache. Share one context between all connections of the same
+ *  kind, so that sessions can be resumed and the handshakes are cheaper.
+ *
+ *  Servers resume sessions with the cache and the session tickets that
+ *  are built into OpenSSL. Clients keep the last session of each server
+ *  name, and offer it the next time they connect to the same name.
+ *
+ *  This file is not included by reactcpp.h. If you want to use it, you
+ *  should include it yourself, and link your application with -lssl and
+ *  -lcrypto.
+ *
+ *  @copyright 2014 Copernica BV
+ */
+
+/**
+ *  Dependencies
+ */
+#include <openssl/ssl.h>
+#include <openssl/err.h>
+#include <unordered_map>
+
+/**
+ *  Set up namespace
+ */
+namespace React { namespace Tcp {
+
+/**
+ *  Class definition
+ */
+class TlsContext
+{
+private:
+    /**
+     *  A cached client session together with the name of the server
+     */
+    struct Session
+    {
+        /**
+         *  Name of the server
+         *  @var    std::string
+         */
+        std::string name;
+
+        /**
+         *  The session
+         *  @var    SSL_SESSION
+         */
+        SSL_SESSION *session;
+
+        /**
+         *  Constructor
+         *  @param  name        Name of the server
+         *  @param  session     The session
+         */
+        Session(const std::string &name, SSL_SESSION *session) :
+            name(name), session(session) {}
+    };
+
+    /**
+     *  Iterators in the list of sessions, by server name
+     */
+    using Index = std::unordered_map<std::string, std::list<Session>::iterator>;
+
+    /**
+     *  The OpenSSL context
+     *  @var    SSL_CTX
+     */
+    SSL_CTX *_context;
+
+    /**
+     *  Is this a context for the server side?
+     *  @var    bool
+     */
+    bool _server;
+
+    /**
+     *  Cached client sessions, the one that was used most recently comes first
+     *  @var    std::list
+     */
+    std::list<Session> _sessions;
+
+    /**
+     *  Index of the sessions by server name
+     *  @var    Index
+     */
+    Index _index;
+
+    /**
+     *  Max number of cached client sessions
+     *  @var    size_t
+     */
+    size_t _capacity = 1024;
+
+    /**
+     *  Forget the session that was used least recently
+     */
+    void evict()
+    {
+        // free the session
+        SSL_SESSION_free(_sessions.back().session);
+
+        // remove it from the index and the list
+        _index.erase(_sessions.back().name);
+        _sessions.pop_back();
+    }
+
+    /**
+     *  Called by OpenSSL when a client receives a new session
+     *  @param  ssl         The connection
+     *  @param  session     The new session
+     *  @return int         1 if we took ownership of the session
+     */
+    static int store(SSL *ssl, SSL_SESSION *session)
+    {
+        // the server name is the key in the cache
+        const char *name = SSL_get_servername(ssl, TLSEXT_NAMETYPE_host_name);
+
+        // without a name the session can not be found later
+        if (name == nullptr) return 0;
+
+        // the context object
+        auto *context = (TlsContext *)SSL_CTX_get_app_data(SSL_get_SSL_CTX(ssl));
+
+        // find the current session for this name
+        auto iter = context->_index.find(name);
+
+        // the new session replaces the old one, and becomes the most recent
+        if (iter != context->_index.end())
+        {
+            SSL_SESSION_free(iter->second->session);
+            iter->second->session = session;
+            context->_sessions.splice(context->_sessions.begin(), context->_sessions, iter->second);
+            return 1;
+        }
+
+        // skip if the cache is disabled
+        if (context->_capacity == 0) return 0;
+
+        // if the cache is full we make room, sessions are cheap to set up again
+        if (context->_sessions.size() >= context->_capacity) context->evict();
+
+        // store the session
+        context->_sessions.emplace_front(name, session);
+        context->_index.emplace(name, context->_sessions.begin());
+
+        // we took ownership
+        return 1;
+    }
+
+public:
+    /**
+     *  Constructor
+     *
+     *  Client contexts verify the certificate of the server against the
+     *  default trusted authorities of the system. Server contexts need a
+     *  certificate, see the certificate() method.
+     *
+     *  Watch out! The constructor will throw an exception in case of an error.
+     *
+     *  @param  server      Is this a context for the server side?
+     */
+    TlsContext(bool server) :
+        _context(SSL_CTX_new(server ? TLS_server_method() : TLS_client_method())),
+        _server(server)
+    {
+        // check for errors
+        if (_context == nullptr) throw Exception("failed to create tls context");
+
+        // remember ourselves, for the session callback
+        SSL_CTX_set_app_data(_context, this);
+
+        // old protocol versions and renegotiation are not supported
+        SSL_CTX_set_min_proto_version(_context, TLS1_2_VERSION);
+        SSL_CTX_set_options(_context, SSL_OP_NO_RENEGOTIATION);
+
+        // let the kernel do the encryption when the cipher allows it
+        SSL_CTX_set_options(_context, SSL_OP_ENABLE_KTLS);
+
+        // writes may be retried with a different buffer that holds the same data
+        SSL_CTX_set_mode(_context, SSL_MODE_ENABLE_PARTIAL_WRITE | SSL_MODE_ACCEPT_MOVING_WRITE_BUFFER);
+
+        // the rest of the setup is different for servers and clients
+        if (server)
+        {
+            // sessions can only be resumed within the same id context
+            SSL_CTX_set_session_id_context(_context, (const unsigned char *)"reactcpp", 8);
+        }
+        else
+        {
+            // verify the server against the default authorities
+            SSL_CTX_set_verify(_context, SSL_VERIFY_PEER, nullptr);
+            SSL_CTX_set_default_verify_paths(_context);
+
+            // we keep the sessions ourselves, indexed by server name
+            SSL_CTX_set_session_cache_mode(_context, SSL_SESS_CACHE_CLIENT | SSL_SESS_CACHE_NO_INTERNAL_STORE);
+            SSL_CTX_sess_set_new_cb(_context, &TlsContext::store);
+        }
+    }
+
+    /**
+     *  Contexts can not be copied
+     *  @param  that
+     */
+    TlsContext(const TlsContext &that) = delete;
+
+    /**
+     *  Destructor
+     */
+    virtual ~TlsContext()
+    {
+        // forget the cached sessions
+        for (auto &iter : _sessions) SSL_SESSION_free(iter.session);
+
+        // free the context
+        SSL_CTX_free(_context);
+    }
+
+    /**
+     *  Is this a context for the server side?
+     *  @return bool
+     */
+    bool server() const
+    {
+        return _server;
+    }
+
+    /**
+     *  Load the certificate chain and the private key from PEM files
+     *  @param  chain       File with the certificate, followed by the intermediates
+     *  @param  key         File with the private key
+     *  @return bool
+     */
+    bool certificate(const char *chain, const char *key)
+    {
+        // load both files, and check that they belong together
+        if (SSL_CTX_use_certificate_chain_file(_context, chain) != 1) return false;
+        if (SSL_CTX_use_PrivateKey_file(_context, key, SSL_FILETYPE_PEM) != 1) return false;
+        return SSL_CTX_check_private_key(_context) == 1;
+    }
+
+    /**
+     *  Trust the authorities in a PEM file, for verifying the peer
+     *  @param  file        File with one or more certificates
+     *  @return bool
+     */
+    bool authority(const char *file)
+    {
+        return SSL_CTX_load_verify_locations(_context, file, nullptr) == 1;
+    }
+
+    /**
+     *  Should the peer be verified?
+     *
+     *  Clients verify the server by default. Servers that enable verification
+     *  require a certificate from the client.
+     *
+     *  @param  verify
+     */
+    void verify(bool verify)
+    {
+        // servers want a certificate, clients check the one they get
+        int mode = _server ? SSL_VERIFY_PEER | SSL_VERIFY_FAIL_IF_NO_PEER_CERT : SSL_VERIFY_PEER;
+
+        // install the mode
+        SSL_CTX_set_verify(_context, verify ? mode : SSL_VERIFY_NONE, nullptr);
+    }
+
+    /**
+     *  Change the max number of cached client sessions, zero disables the cache
+     *  @param  capacity
+     */
+    void capacity(size_t capacity)
+    {
+        // remember the setting
+        _capacity = capacity;
+
+        // forget the sessions that were used least recently
+        while (_sessions.size() > _capacity) evict();
+    }
+
+    /**
+     *  The cached client session for a server name, which then becomes the
+     *  most recently used session
+     *  @param  name        Name of the server
+     *  @return SSL_SESSION The session, or nullptr if there is none
+     */
+    SSL_SESSION *session(const char *name)
+    {
+        // look up the session
+        auto iter = _index.find(name);
+        if (iter == _index.end()) return nullptr;
+
+        // move it to the front
+        _sessions.splice(_sessions.begin(), _sessions, iter->second);
+
+        // done
+        return iter->second->session;
+    }
+
+    /**
+     *  Number of cached client sessions
+     *  @return size_t
+     */
+    size_t sessions() const
+    {
+        return _sessions.size();
+    }
+
+    /**
+     *  The underlying OpenSSL context, for settings that are not covered
+     *  by this class, like the allowed ciphers
+     *  @return SSL_CTX
+     */
+    SSL_CTX *handle() const
+    {
+        return _context;
+    }
+};
+
+/**
+ *  End namespace
+ */
+}}
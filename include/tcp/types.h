@@ -25,6 +25,9 @@ using ConnectCallback   =   std::function<bool(Server *server)>;
 using ConnectedCallback =   std::function<void(const char *error)>;
 using DataCallback      =   std::function<bool(const void *buf, size_t size)>;
 using CloseCallback     =   std::function<void()>;
+using IdleCallback      =   std::function<void(Connection *connection)>;
+using SampleCallback    =   std::function<void(Connection *connection)>;
+using DrainCallback     =   std::function<void()>;
 
 /**
  *  End namespace
@@ -0,0 +1,133 @@
+/**
+ *  Datagram.h
+ *
+ *  A single datagram that was received by a Udp::Socket. The object does
+ *  not own the data, it points into the receive buffer of the socket, and
+ *  is therefore only valid for as long as the datagram callback runs.
+ *
+ *  @copyright 2014 Copernica BV
+ */
+
+/**
+ *  Set up namespace
+ */
+namespace React { namespace Udp {
+
+/**
+ *  Class definition
+ */
+class Datagram
+{
+private:
+    /**
+     *  Pointer to the payload
+     *  @var    const char *
+     */
+    const char *_data;
+
+    /**
+     *  Size of the payload
+     *  @var    size_t
+     */
+    size_t _size;
+
+    /**
+     *  Address of the sender
+     *  @var    sockaddr_storage
+     */
+    const struct sockaddr_storage *_address;
+
+    /**
+     *  Was the datagram cut off because it did not fit in the receive slot?
+     *  @var    bool
+     */
+    bool _truncated;
+
+public:
+    /**
+     *  Constructor
+     *
+     *  You normally don't construct Datagram objects yourself, they are
+     *  passed to the callback that was installed with Socket::onDatagrams()
+     *
+     *  @param  data        pointer to the payload
+     *  @param  size        size of the payload
+     *  @param  address     address of the sender
+     *  @param  truncated   was the datagram cut off?
+     */
+    Datagram(const char *data, size_t size, const struct sockaddr_storage *address, bool truncated = false) :
+        _data(data), _size(size), _address(address), _truncated(truncated) {}
+
+    /**
+     *  Destructor
+     */
+    virtual ~Datagram() {}
+
+    /**
+     *  Retrieve the payload
+     *  @return const char *
+     */
+    const char *data() const
+    {
+        return _data;
+    }
+
+    /**
+     *  Size of the payload
+     *  @return size_t
+     */
+    size_t size() const
+    {
+        return _size;
+    }
+
+    /**
+     *  Was the datagram cut off?
+     *
+     *  This happens when the datagram is bigger than the size of the receive
+     *  slots of the socket. The payload is then incomplete.
+     *
+     *  @return bool
+     */
+    bool truncated() const
+    {
+        return _truncated;
+    }
+
+    /**
+     *  Address of the sender
+     *
+     *  The address is only constructed when you ask for it, so that callers
+     *  that do not care about the sender do not pay for it.
+     *
+     *  @return Net::Address
+     */
+    Net::Address address() const
+    {
+        // check the family
+        switch (_address->ss_family) {
+        case AF_INET: {
+            // cast to an ipv4 address
+            auto *info = reinterpret_cast<const struct sockaddr_in *>(_address);
+
+            // construct the address
+            return Net::Address(Net::Ip(info->sin_addr), ntohs(info->sin_port));
+        }
+        case AF_INET6: {
+            // cast to an ipv6 address
+            auto *info = reinterpret_cast<const struct sockaddr_in6 *>(_address);
+
+            // construct the address
+            return Net::Address(Net::Ip(info->sin6_addr), ntohs(info->sin6_port));
+        }
+        default:
+            // unknown family
+            return Net::Address();
+        }
+    }
+};
+
+/**
+ *  End namespace
+ */
+}}
@@ -0,0 +1,35 @@
+/**
+ *  Exception.h
+ *
+ *  Exception thrown by the Udp module
+ *
+ *  @copyright 2014 Copernica BV
+ */
+
+/**
+ *  Set up namespace
+ */
+namespace React { namespace Udp {
+
+/**
+ *  Class definition
+ */
+class Exception : public React::Exception
+{
+public:
+    /**
+     *  Constructor
+     *  @param  message
+     */
+    Exception(const char *message) : React::Exception(message) {}
+    
+    /**
+     *  Destructor
+     */
+    virtual ~Exception() {}
+};
+
+/**
+ *  End namespace
+ */
+}}
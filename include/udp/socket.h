@@ -0,0 +1,721 @@
+/**
+ *  Socket.h
+ *
+ *  UDP socket implementation. Incoming datagrams are received in batches
+ *  with recvmmsg() into a slab of memory that is allocated once, and
+ *  outgoing datagrams can be queued and sent in batches with sendmmsg().
+ *
+ *  @copyright 2014 Copernica BV
+ */
+
+/**
+ *  Dependencies
+ */
+#include <sys/socket.h>
+#include <sys/uio.h>
+#include <netinet/udp.h>
+
+/**
+ *  Set up namespace
+ */
+namespace React { namespace Udp {
+
+/**
+ *  Class definition
+ */
+class Socket : public Fd
+{
+private:
+    /**
+     *  Datagram that is queued for sending
+     */
+    struct Pending
+    {
+        /**
+         *  Address of the receiver
+         *  @var    sockaddr_storage
+         */
+        struct sockaddr_storage address;
+
+        /**
+         *  Size of the address (or zero for connected sockets)
+         *  @var    socklen_t
+         */
+        socklen_t length;
+
+        /**
+         *  Offset of the payload in the output buffer
+         *  @var    size_t
+         */
+        size_t offset;
+
+        /**
+         *  Size of the payload
+         *  @var    size_t
+         */
+        size_t size;
+    };
+
+    /**
+     *  Number of datagrams that are received with a single system call
+     *  @var    size_t
+     */
+    size_t _count;
+
+    /**
+     *  Size of a single slot in the receive slab
+     *  @var    size_t
+     */
+    size_t _size;
+
+    /**
+     *  The slab of memory in which datagrams are received
+     *  @var    char[]
+     */
+    std::unique_ptr<char[]> _slab;
+
+    /**
+     *  Message headers, iovecs and addresses for recvmmsg()
+     *  @var    std::vector
+     */
+    std::vector<struct mmsghdr> _headers;
+    std::vector<struct iovec> _iovecs;
+    std::vector<struct sockaddr_storage> _addresses;
+
+    /**
+     *  Buffer for ancillary data (only in use when GRO is enabled)
+     *  @var    char[]
+     */
+    std::unique_ptr<char[]> _controls;
+
+    /**
+     *  The datagrams that are passed to the callback
+     *  @var    Datagrams
+     */
+    Datagrams _datagrams;
+
+    /**
+     *  Buffer holding the payload of all queued datagrams
+     *  @var    std::vector
+     */
+    std::vector<char> _output;
+
+    /**
+     *  Datagrams that are queued, but not yet sent
+     *  @var    std::vector
+     */
+    std::vector<Pending> _pending;
+
+    /**
+     *  Are we waiting for the socket to become writable?
+     *  @var    bool
+     */
+    bool _waiting = false;
+
+    /**
+     *  Size of the ancillary data per message
+     */
+#ifdef UDP_GRO
+    static constexpr size_t control = CMSG_SPACE(sizeof(int));
+#else
+    static constexpr size_t control = 0;
+#endif
+
+    /**
+     *  Size of the slots that is needed to hold the datagrams that the
+     *  kernel coalesces when GRO is enabled
+     */
+    static constexpr size_t coalesced = 65535;
+
+    /**
+     *  Helper method to fill a socket address structure
+     *  @param  ip          IP address
+     *  @param  port        Port number
+     *  @param  info        Structure to fill
+     *  @return socklen_t   Size of the filled structure, or zero on failure
+     */
+    static socklen_t fill(const Net::Ip &ip, uint16_t port, struct sockaddr_storage *info)
+    {
+        // check the version
+        switch (ip.version()) {
+        case 4: {
+            // cast to the appropriate type
+            auto *v4 = reinterpret_cast<struct sockaddr_in *>(info);
+
+            // fill the members
+            v4->sin_family = AF_INET;
+            v4->sin_port = htons(port);
+
+            // copy address
+            memcpy(&v4->sin_addr, ip.v4().internal(), sizeof(struct in_addr));
+
+            // done
+            return sizeof(struct sockaddr_in);
+        }
+        case 6: {
+            // cast to the appropriate type
+            auto *v6 = reinterpret_cast<struct sockaddr_in6 *>(info);
+
+            // fill the members
+            v6->sin6_family = AF_INET6;
+            v6->sin6_port = htons(port);
+            v6->sin6_flowinfo = 0;
+            v6->sin6_scope_id = 0;
+
+            // copy the address
+            memcpy(&v6->sin6_addr, ip.v6().internal(), sizeof(struct in6_addr));
+
+            // done
+            return sizeof(struct sockaddr_in6);
+        }
+        default:
+            // unsupported version
+            return 0;
+        }
+    }
+
+    /**
+     *  Prepare the message headers for the next call to recvmmsg()
+     */
+    void prepare()
+    {
+        // loop through all the slots
+        for (size_t i = 0; i < _count; i++)
+        {
+            // the header to reset
+            auto &header = _headers[i].msg_hdr;
+
+            // the kernel overwrites the sizes, so they have to be reset
+            header.msg_namelen = sizeof(struct sockaddr_storage);
+            header.msg_controllen = _controls ? control : 0;
+            header.msg_flags = 0;
+        }
+    }
+
+    /**
+     *  Process a received message and turn it into one or more datagrams
+     *  @param  index       Index of the slot
+     *  @param  size        Number of bytes received in the slot
+     */
+    void process(size_t index, size_t size)
+    {
+        // pointer to the data and the sender
+        const char *data = _slab.get() + index * _size;
+        const struct sockaddr_storage *address = &_addresses[index];
+
+        // size of the individual segments, when the kernel coalesced datagrams
+        size_t segment = size;
+
+#ifdef UDP_GRO
+        // check the ancillary data for a segment size
+        if (_controls)
+        {
+            // the header holding the ancillary data
+            auto *header = &_headers[index].msg_hdr;
+
+            // loop through the messages
+            for (auto *cmsg = CMSG_FIRSTHDR(header); cmsg; cmsg = CMSG_NXTHDR(header, cmsg))
+            {
+                // skip other messages
+                if (cmsg->cmsg_level != SOL_UDP || cmsg->cmsg_type != UDP_GRO) continue;
+
+                // the kernel reports the size of each segment
+                int value;
+                memcpy(&value, CMSG_DATA(cmsg), sizeof(int));
+
+                // store the segment size
+                if (value > 0) segment = value;
+            }
+        }
+#endif
+
+        // if the message did not fit in the slot, the last datagram is incomplete
+        bool truncated = _headers[index].msg_hdr.msg_flags & MSG_TRUNC;
+
+        // split the data into datagrams (the last one may be shorter)
+        for (size_t offset = 0; offset < size; offset += segment)
+        {
+            // size of this datagram
+            size_t length = std::min(segment, size - offset);
+
+            // add a datagram
+            _datagrams.emplace_back(data + offset, length, address, truncated && offset + length == size);
+        }
+
+        // empty datagrams are valid too
+        if (size == 0) _datagrams.emplace_back(data, 0, address, truncated);
+    }
+
+    /**
+     *  Install a handler that sends out the queued datagrams once the
+     *  socket becomes writable again
+     */
+    void checkWritable()
+    {
+        // skip if we are already waiting
+        if (_waiting) return;
+
+        // remember that we are waiting
+        _waiting = true;
+
+        // wait for the socket to become writable
+        onWritable([this]() -> bool {
+
+            // send out the datagrams
+            flush();
+
+            // do we still have to wait?
+            return _waiting = _pending.size() > 0;
+        });
+    }
+
+public:
+    /**
+     *  Constructor to bind the socket to an IP and port
+     *
+     *  The count and size parameters determine the size of the slab of memory
+     *  that is allocated for receiving datagrams: count datagrams of at most
+     *  size bytes each are received with a single system call. If you are going
+     *  to enable GRO with the coalesce() method, you should set the size to
+     *  65535 bytes, because the kernel then delivers multiple datagrams in a
+     *  single slot.
+     *
+     *  Watch out! The constructor will throw an exception in case of an error.
+     *
+     *  @param  loop        Event loop
+     *  @param  ip          IP address to bind to
+     *  @param  port        Port number to bind to (or 0 to use a random port)
+     *  @param  count       Max number of datagrams received per system call
+     *  @param  size        Max size of a datagram
+     */
+    Socket(Loop *loop, const Net::Ip &ip = Net::Ip(), uint16_t port = 0, size_t count = 32, size_t size = 2048) :
+        Fd(loop, socket(ip.version() == 6 ? AF_INET6 : AF_INET, SOCK_DGRAM | SOCK_NONBLOCK, 0)),
+        _count(std::max(count, (size_t)1)), _size(std::max(size, (size_t)1)),
+        _slab(new char[_count * _size]),
+        _headers(_count), _iovecs(_count), _addresses(_count)
+    {
+        // this should succeed
+        if (_fd < 0) throw Exception(strerror(errno));
+
+        // the address to bind to
+        struct sockaddr_storage info;
+        socklen_t length = fill(ip, port, &info);
+
+        // bind the socket
+        if (length == 0 || ::bind(_fd, (struct sockaddr *)&info, length) != 0)
+        {
+            // the destructor does not run, so we close the socket ourselves
+            int error = length == 0 ? EINVAL : errno;
+            ::close(_fd);
+
+            // report the failure
+            throw Exception(strerror(error));
+        }
+
+        // we never need more datagrams than slots, unless the kernel coalesces them
+        _datagrams.reserve(_count);
+
+        // link the headers to the slab
+        for (size_t i = 0; i < _count; i++)
+        {
+            // the iovec points to the slot in the slab
+            _iovecs[i].iov_base = _slab.get() + i * _size;
+            _iovecs[i].iov_len = _size;
+
+            // the header refers to the iovec and the address
+            memset(&_headers[i], 0, sizeof(struct mmsghdr));
+            _headers[i].msg_hdr.msg_name = &_addresses[i];
+            _headers[i].msg_hdr.msg_iov = &_iovecs[i];
+            _headers[i].msg_hdr.msg_iovlen = 1;
+        }
+    }
+
+    /**
+     *  Constructor to bind the socket to a local address
+     *
+     *  Watch out! The constructor will throw an exception in case of an error.
+     *
+     *  @param  loop        Event loop
+     *  @param  address     Local address to bind to
+     *  @param  count       Max number of datagrams received per system call
+     *  @param  size        Max size of a datagram
+     */
+    Socket(Loop *loop, const Net::Address &address, size_t count = 32, size_t size = 2048) :
+        Socket(loop, address.ip(), address.port(), count, size) {}
+
+    /**
+     *  Sockets can not be copied or moved
+     *  @param  socket
+     */
+    Socket(const Socket &socket) = delete;
+    Socket(Socket &&socket) = delete;
+
+    /**
+     *  Destructor
+     */
+    virtual ~Socket()
+    {
+        // close the filedescriptor
+        close();
+    }
+
+    /**
+     *  Connect the socket to a remote address
+     *
+     *  After the socket is connected, you can use the send() and queue()
+     *  methods without an address, and only datagrams from the remote
+     *  address will be received.
+     *
+     *  @param  ip
+     *  @param  port
+     *  @return bool
+     */
+    bool connect(const Net::Ip &ip, uint16_t port) const
+    {
+        // the address to connect to
+        struct sockaddr_storage info;
+        socklen_t length = fill(ip, port, &info);
+
+        // connect
+        return length > 0 && ::connect(_fd, (struct sockaddr *)&info, length) == 0;
+    }
+
+    /**
+     *  Connect the socket to a remote address
+     *  @param  address
+     *  @return bool
+     */
+    bool connect(const Net::Address &address) const
+    {
+        return connect(address.ip(), address.port());
+    }
+
+    /**
+     *  Retrieve the address to which the socket is bound
+     *  @return Net::Address
+     */
+    Net::Address address() const
+    {
+        return Tcp::SocketAddress(_fd);
+    }
+
+    /**
+     *  Enable generic segmentation offload (UDP_SEGMENT)
+     *
+     *  With GSO enabled, every buffer that is passed to send() or queue() is
+     *  split by the kernel into datagrams of the given size, so that many
+     *  datagrams to the same receiver cost only a single trip through the
+     *  network stack. Pass zero to disable it again.
+     *
+     *  @param  size        Size of the individual datagrams
+     *  @return bool
+     */
+    bool segment(uint16_t size) const
+    {
+#ifdef UDP_SEGMENT
+        // the option takes an int
+        int value = size;
+
+        // set the option
+        return setsockopt(_fd, SOL_UDP, UDP_SEGMENT, &value, sizeof(int)) == 0;
+#else
+        // not supported on this platform
+        return false;
+#endif
+    }
+
+    /**
+     *  Enable generic receive offload (UDP_GRO)
+     *
+     *  With GRO enabled, the kernel may deliver multiple datagrams from the
+     *  same sender in one slot. They are split again before they are passed
+     *  to the callback, so this is transparent for the user.
+     *
+     *  GRO can only be enabled when the socket was constructed with slots of
+     *  at least 65535 bytes, because smaller slots would silently lose the
+     *  datagrams that do not fit.
+     *
+     *  @param  enable      Should GRO be enabled?
+     *  @return bool
+     */
+    bool coalesce(bool enable = true)
+    {
+        // the slots must be big enough for the coalesced datagrams
+        if (enable && _size < coalesced) return false;
+
+#ifdef UDP_GRO
+        // the option takes an int
+        int value = enable ? 1 : 0;
+
+        // set the option
+        if (setsockopt(_fd, SOL_UDP, UDP_GRO, &value, sizeof(int)) != 0) return false;
+
+        // when disabled we no longer need buffers for the ancillary data
+        if (!enable) _controls.reset();
+
+        // allocate buffers for the ancillary data
+        else if (!_controls) _controls.reset(new char[_count * control]);
+
+        // link the headers to the buffers
+        for (size_t i = 0; i < _count; i++) _headers[i].msg_hdr.msg_control = _controls ? _controls.get() + i * control : nullptr;
+
+        // done
+        return true;
+#else
+        // not supported on this platform
+        return !enable;
+#endif
+    }
+
+    /**
+     *  Install a handler for incoming datagrams
+     *
+     *  Every time the socket becomes readable, a batch of datagrams is
+     *  received with a single call to recvmmsg() and passed to the callback.
+     *  The datagrams point into the receive slab of the socket, so you should
+     *  copy the data if you need it after the callback has returned. The
+     *  callback should return true if it wants to receive more datagrams.
+     *
+     *  Note that this handler overrides a handler that you had installed
+     *  before with onReadable().
+     *
+     *  @param  callback
+     */
+    void onDatagrams(const DatagramCallback &callback)
+    {
+        // remove the handler
+        if (!callback) { onReadable(nullptr); return; }
+
+        // install a readability handler
+        onReadable([this, callback]() -> bool {
+
+            // reset the message headers
+            prepare();
+
+            // receive a batch of datagrams
+            int count = recvmmsg(_fd, _headers.data(), _count, MSG_DONTWAIT, nullptr);
+
+            // errors are not fatal for datagram sockets (a connected socket
+            // might for example report ECONNREFUSED), we just keep listening
+            if (count <= 0) return true;
+
+            // forget the previous datagrams
+            _datagrams.clear();
+
+            // process the messages
+            for (int i = 0; i < count; i++) process(i, _headers[i].msg_len);
+
+            // report the batch to the callback
+            return callback(_datagrams);
+        });
+    }
+
+    /**
+     *  Send a datagram to a connected socket
+     *
+     *  This method is directly forwarded to the ::send() system call.
+     *
+     *  @param  data        Data to send
+     *  @param  size        Size of the data
+     *  @return ssize_t     Number of bytes sent
+     */
+    ssize_t send(const void *data, size_t size) const
+    {
+        return ::send(_fd, data, size, 0);
+    }
+
+    /**
+     *  Send a datagram to a remote address
+     *
+     *  This method is directly forwarded to the ::sendto() system call.
+     *
+     *  @param  address     Address of the receiver
+     *  @param  data        Data to send
+     *  @param  size        Size of the data
+     *  @return ssize_t     Number of bytes sent
+     */
+    ssize_t send(const Net::Address &address, const void *data, size_t size) const
+    {
+        // the address to send to
+        struct sockaddr_storage info;
+        socklen_t length = fill(address.ip(), address.port(), &info);
+
+        // address must be valid
+        if (length == 0) return -1;
+
+        // send the datagram
+        return ::sendto(_fd, data, size, 0, (struct sockaddr *)&info, length);
+    }
+
+    /**
+     *  Queue a datagram for a connected socket
+     *
+     *  The datagram is copied into an internal buffer, and sent together with
+     *  other queued datagrams with a single sendmmsg() call when you call
+     *  flush(). Nothing is sent before that.
+     *
+     *  @param  data        Data to send
+     *  @param  size        Size of the data
+     */
+    void queue(const void *data, size_t size)
+    {
+        // construct a pending datagram without address
+        Pending pending;
+        pending.length = 0;
+        pending.offset = _output.size();
+        pending.size = size;
+
+        // copy the data
+        _output.insert(_output.end(), (const char *)data, (const char *)data + size);
+
+        // store the datagram
+        _pending.push_back(pending);
+    }
+
+    /**
+     *  Queue a datagram for a remote address
+     *  @param  address     Address of the receiver
+     *  @param  data        Data to send
+     *  @param  size        Size of the data
+     *  @return bool
+     */
+    bool queue(const Net::Address &address, const void *data, size_t size)
+    {
+        // construct a pending datagram
+        Pending pending;
+        pending.length = fill(address.ip(), address.port(), &pending.address);
+        pending.offset = _output.size();
+        pending.size = size;
+
+        // address must be valid
+        if (pending.length == 0) return false;
+
+        // copy the data
+        _output.insert(_output.end(), (const char *)data, (const char *)data + size);
+
+        // store the datagram
+        _pending.push_back(pending);
+
+        // done
+        return true;
+    }
+
+    /**
+     *  Send out all queued datagrams
+     *
+     *  The datagrams are sent with as few sendmmsg() calls as possible. If the
+     *  socket is not writable, the remaining datagrams stay queued and are
+     *  automatically sent when the socket becomes writable again. Datagrams
+     *  that the kernel refuses (for example because they are too big) are
+     *  dropped.
+     *
+     *  @return size_t      Number of datagrams sent
+     */
+    size_t flush()
+    {
+        // number of datagrams processed and sent
+        size_t processed = 0, sent = 0;
+
+        // iovecs and headers for sendmmsg
+        std::vector<struct iovec> iovecs(std::min(_pending.size(), (size_t)UIO_MAXIOV));
+        std::vector<struct mmsghdr> headers(iovecs.size());
+
+        // keep going while there are datagrams
+        while (processed < _pending.size())
+        {
+            // number of datagrams to send in this call
+            size_t count = std::min(_pending.size() - processed, iovecs.size());
+
+            // prepare the headers
+            for (size_t i = 0; i < count; i++)
+            {
+                // the datagram to send
+                auto &pending = _pending[processed + i];
+
+                // set up the iovec
+                iovecs[i].iov_base = _output.data() + pending.offset;
+                iovecs[i].iov_len = pending.size;
+
+                // set up the header
+                memset(&headers[i], 0, sizeof(struct mmsghdr));
+                headers[i].msg_hdr.msg_name = pending.length > 0 ? &pending.address : nullptr;
+                headers[i].msg_hdr.msg_namelen = pending.length;
+                headers[i].msg_hdr.msg_iov = &iovecs[i];
+                headers[i].msg_hdr.msg_iovlen = 1;
+            }
+
+            // send the batch
+            int result = sendmmsg(_fd, headers.data(), count, MSG_DONTWAIT);
+
+            // on success we move on
+            if (result > 0) { processed += result; sent += result; continue; }
+
+            // socket is not writable, we try again later
+            if (errno == EAGAIN || errno == EWOULDBLOCK || errno == EINTR) break;
+
+            // the first datagram in the batch is refused, we drop it
+            processed += 1;
+        }
+
+        // all datagrams were processed
+        if (processed == _pending.size())
+        {
+            // forget all the data
+            _pending.clear();
+            _output.clear();
+        }
+        else if (processed > 0)
+        {
+            // offset of the first datagram that was not yet sent
+            size_t offset = _pending[processed].offset;
+
+            // remove the sent datagrams
+            _pending.erase(_pending.begin(), _pending.begin() + processed);
+            _output.erase(_output.begin(), _output.begin() + offset);
+
+            // update the offsets
+            for (auto &pending : _pending) pending.offset -= offset;
+
+            // wait for the socket to become writable
+            checkWritable();
+        }
+        else if (_pending.size() > 0)
+        {
+            // wait for the socket to become writable
+            checkWritable();
+        }
+
+        // done
+        return sent;
+    }
+
+    /**
+     *  Number of datagrams that are queued but not yet sent
+     *  @return size_t
+     */
+    size_t pending() const
+    {
+        return _pending.size();
+    }
+
+    /**
+     *  Close the socket
+     *  @return bool
+     */
+    bool close()
+    {
+        // try to close
+        if (::close(_fd) < 0 && errno != EBADF) return false;
+
+        // forget the filedescriptor
+        _fd = -1;
+
+        // done
+        return true;
+    }
+};
+
+/**
+ *  End namespace
+ */
+}}
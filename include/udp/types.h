@@ -0,0 +1,32 @@
+/**
+ *  Types.h
+ *
+ *  Types and callbacks in use by the UDP module
+ *
+ *  @copyright 2014 Copernica BV
+ */
+
+/**
+ *  Set up namespace
+ */
+namespace React { namespace Udp {
+
+/**
+ *  Forward declarations
+ */
+class Datagram;
+
+/**
+ *  Types
+ */
+using Datagrams         =   std::vector<Datagram>;
+
+/**
+ *  Callbacks
+ */
+using DatagramCallback  =   std::function<bool(const Datagrams &datagrams)>;
+
+/**
+ *  End namespace
+ */
+}}
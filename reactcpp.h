@@ -14,6 +14,7 @@
 #include <ev.h>
 #include <ares.h>
 #include <arpa/inet.h>
+#include <arpa/nameser.h>
 #include <string.h>
 #include <unistd.h>
 #include <fcntl.h>
@@ -27,7 +28,10 @@
 #include <stdexcept>
 #include <iostream>
 #include <list>
+#include <deque>
+#include <vector>
 #include <cstring>
+#include <limits>
 
 /**
  *  Other include files
@@ -60,23 +64,53 @@
 #include <reactcpp/net/ip.h>
 #include <reactcpp/net/address.h>
 #include <reactcpp/dns/iprecord.h>
+#include <reactcpp/dns/parser.h>
 #include <reactcpp/dns/mxrecord.h>
 #include <reactcpp/dns/mxresult.h>
+#include <reactcpp/dns/txtrecord.h>
+#include <reactcpp/dns/txtresult.h>
+#include <reactcpp/dns/ptrrecord.h>
+#include <reactcpp/dns/ptrresult.h>
+#include <reactcpp/dns/srvrecord.h>
+#include <reactcpp/dns/srvresult.h>
+#include <reactcpp/dns/tlsarecord.h>
+#include <reactcpp/dns/tlsaresult.h>
 #include <reactcpp/dns/channel.h>
 #include <reactcpp/dns/types.h>
+#include <reactcpp/dns/sharedcache.h>
 #include <reactcpp/dns/base.h>
+#include <reactcpp/dns/bulk.h>
 #include <reactcpp/dns/resolver.h>
 #include <reactcpp/tcp/exception.h>
 #include <reactcpp/tcp/types.h>
 #include <reactcpp/tcp/address.h>
 #include <reactcpp/tcp/socketaddress.h>
 #include <reactcpp/tcp/peeraddress.h>
+#include <reactcpp/tcp/statistics.h>
+#include <reactcpp/tcp/registry.h>
 #include <reactcpp/tcp/socket.h>
+#include <reactcpp/tcp/inherited.h>
 #include <reactcpp/tcp/server.h>
+#include <reactcpp/tcp/idlehook.h>
+#include <reactcpp/tcp/layer.h>
 #include <reactcpp/tcp/connection.h>
+#include <reactcpp/tcp/idletracker.h>
+#include <reactcpp/tcp/sampler.h>
+#include <reactcpp/tcp/ratelimiter.h>
+#include <reactcpp/tcp/linesplitter.h>
+#include <reactcpp/tcp/framer.h>
+#include <reactcpp/tcp/lengthframer.h>
+#include <reactcpp/tcp/delimiterframer.h>
+#include <reactcpp/tcp/fixedframer.h>
 #include <reactcpp/tcp/buffer.h>
 #include <reactcpp/tcp/out.h>
 #include <reactcpp/tcp/in.h>
+#include <reactcpp/tcp/receivepool.h>
+#include <reactcpp/tcp/pooledin.h>
+#include <reactcpp/udp/exception.h>
+#include <reactcpp/udp/types.h>
+#include <reactcpp/udp/datagram.h>
+#include <reactcpp/udp/socket.h>
 
 /**
  *  End if
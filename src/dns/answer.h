@@ -0,0 +1,190 @@
+/**
+ *  Answer.h
+ *
+ *  Implementation-only class that holds a copy of an answer in wire format,
+ *  so that it can be stored in the cache and parsed again later. Failures
+ *  are cached too, the status tells which failure it was.
+ *
+ *  Answers do not change after they are constructed, so the same answer can
+ *  be used by the caches of resolvers in different threads.
+ *
+ *  @copyright 2014 Copernica BV
+ */
+
+/**
+ *  Set up namespace
+ */
+namespace React { namespace Dns {
+
+/**
+ *  Class definition
+ */
+class Answer
+{
+private:
+    /**
+     *  Status of the query
+     *  @var    int
+     */
+    int _status;
+
+    /**
+     *  The answer in wire format
+     *  @var    std::vector
+     */
+    std::vector<unsigned char> _buffer;
+
+    /**
+     *  Time at which the answer expires
+     *  @var    Timestamp
+     */
+    Timestamp _expires;
+
+    /**
+     *  Time from which the answer should be refreshed if it is hot
+     *  @var    Timestamp
+     */
+    Timestamp _refresh;
+
+    /**
+     *  Did a resolver already start refreshing the answer?
+     *  @var    std::atomic<bool>
+     */
+    mutable std::atomic<bool> _claimed;
+
+public:
+    /**
+     *  Constructor
+     *  @param  status      Status of the query
+     *  @param  buffer      The answer in wire format
+     *  @param  len         Size of the answer
+     *  @param  expires     Time at which the answer expires
+     *  @param  refresh     Time from which the answer should be refreshed
+     */
+    Answer(int status, const unsigned char *buffer, int len, Timestamp expires, Timestamp refresh) :
+        _status(status), _buffer(buffer, buffer + len), _expires(expires), _refresh(refresh), _claimed(false) {}
+
+    /**
+     *  Destructor
+     */
+    virtual ~Answer() {}
+
+    /**
+     *  Status of the query
+     *  @return int
+     */
+    int status() const
+    {
+        return _status;
+    }
+
+    /**
+     *  The answer in wire format
+     *  @return const unsigned char *
+     */
+    const unsigned char *data() const
+    {
+        return _buffer.data();
+    }
+
+    /**
+     *  Size of the answer
+     *  @return int
+     */
+    int size() const
+    {
+        return _buffer.size();
+    }
+
+    /**
+     *  Time at which the answer expires
+     *  @return Timestamp
+     */
+    Timestamp expires() const
+    {
+        return _expires;
+    }
+
+    /**
+     *  Time from which the answer should be refreshed if it is hot
+     *  @return Timestamp
+     */
+    Timestamp refresh() const
+    {
+        return _refresh;
+    }
+
+    /**
+     *  Claim the refresh of the answer, this succeeds only once, so that
+     *  resolvers that share the answer do not all send a query for it
+     *  @return bool        Should the caller refresh the answer?
+     */
+    bool claim() const
+    {
+        return !_claimed.exchange(true);
+    }
+
+    /**
+     *  The lowest TTL of the records in the answer section, this includes
+     *  the CNAME records that lead to the final records
+     *  @param  buffer      The answer in wire format
+     *  @param  len         Size of the answer
+     *  @return int         The TTL in seconds, or -1 if there are no records
+     */
+    static int ttl(const unsigned char *buffer, int len)
+    {
+        // the lowest ttl
+        int result = -1;
+
+        // walk over the records
+        Parser parser(buffer, len);
+        while (parser.next())
+        {
+            // only the answer section counts
+            if (parser.section() != Parser::answer) break;
+
+            // remember the lowest
+            if (result < 0 || parser.ttl() < result) result = parser.ttl();
+        }
+
+        // done
+        return parser.valid() ? result : -1;
+    }
+
+    /**
+     *  The TTL of a negative answer, which is the lowest of the TTL and the
+     *  minimum field of the SOA record in the authority section (RFC 2308)
+     *  @param  buffer      The answer in wire format
+     *  @param  len         Size of the answer
+     *  @return int         The TTL in seconds, or -1 if there is no SOA record
+     */
+    static int minimum(const unsigned char *buffer, int len)
+    {
+        // walk over the records
+        Parser parser(buffer, len);
+        while (parser.next())
+        {
+            // only SOA records in the authority section count
+            if (parser.section() == Parser::additional) break;
+            if (parser.section() != Parser::authority || parser.type() != ns_t_soa) continue;
+
+            // skip the names of the primary server and the mailbox
+            int pos = parser.data() - buffer;
+            if (!Parser::skip(buffer, len, pos) || !Parser::skip(buffer, len, pos)) return -1;
+
+            // the serial, refresh, retry and expire fields come before the minimum
+            if (pos + 20 > parser.data() - buffer + parser.length()) return -1;
+
+            // the lowest of both
+            return std::min(parser.ttl(), Parser::readTtl(buffer + pos + 16));
+        }
+
+        // no SOA record
+        return -1;
+    }
+};
+
+/**
+ *  End namespace
+ */
+}}
@@ -10,15 +10,97 @@
  */
 namespace React { namespace Dns {
 
+/**
+ *  Callback method that is called when a query completed
+ *  @param  data    User-supplied-data (pointer to the resolver-request)
+ *  @param  status  Status of the resolver
+ *  @param  timeout Number of times that a query timed out
+ *  @param  buffer  The answer buffer
+ *  @param  len     Length of the answer buffer
+ */
+static void callback(void *data, int status, int timeout, unsigned char *buffer, int len)
+{
+    // retrieve pointer to the request
+    auto request = static_cast<Request*>(data);
+
+    // new requests for the same name no longer wait for this one
+    request->cache()->detach(request);
+
+    // remember the result for the next time, the cache knows which failures to keep
+    request->cache()->store(request->name(), request->type(), status, buffer, len);
+
+    // the callbacks may destroy the resolver, the channel should stay alive
+    // until the ares library is done with it
+    auto channel = request->channel();
+
+    // report the result to the request and the ones that waited for it, and free them
+    request->complete(status, buffer, len);
+
+    // if the resolver is still there, it keeps the channel alive
+    if (channel.use_count() > 1) return;
+
+    // otherwise the channel is destroyed in the next iteration
+    channel->loop()->onTimeout(0.0, [channel]() {});
+}
+
+/**
+ *  Send a request to the ares library
+ *  @param  channel     the channel that runs the query
+ *  @param  request     the request, which is freed when it is answered
+ */
+static void send(Channel *channel, Request *request)
+{
+    // tell the ares library to run the query
+    ares_query(*channel, request->name().c_str(), ns_c_in, request->type(), callback, request);
+
+    // set a new timeout
+    channel->setTimeout();
+}
+
 /**
  *  Constructor
  *  @param  loop        Loop in which the resolver is activated
  */
-Base::Base(Loop *loop) : _loop(loop), _channel(new Channel(loop))
+Base::Base(Loop *loop) : _loop(loop), _channel(new Channel(loop)), _pool(std::make_shared<Pool>()), _cache(std::make_shared<Cache>(loop))
 {}
 
+/**
+ *  Answer a request from the cache, attach it to an identical request that
+ *  was already sent, or send it to the ares library
+ *  @param  request     the request, which is freed when it is done
+ *  @return bool
+ */
+bool Base::query(Request *request)
+{
+    // should the answer from the cache be refreshed?
+    bool refresh = false;
+
+    // answers that we already know are reported in the next iteration
+    if (_cache->answer(request, refresh))
+    {
+        // skip if the answer is not hot or not about to expire
+        if (!refresh) return true;
+
+        // ask for the answer again, lookups that miss in the meantime wait for it
+        auto *prefetch = _pool->allocate<RefreshRequest>(this, request->name(), request->type());
+        _cache->attach(prefetch);
+        send(_channel.get(), prefetch);
+
+        // done
+        return true;
+    }
+
+    // if the same query was already sent we wait for its answer
+    if (_cache->attach(request)) return true;
+
+    // send the query
+    send(_channel.get(), request);
+
+    // done
+    return true;
+}
+
 /**
  *  End namespace
  */
 }}
-
@@ -0,0 +1,140 @@
+/**
+ *  Bulk.cpp
+ *
+ *  @copyright 2014 Copernica BV
+ */
+#include "includes.h"
+
+/**
+ *  Set up namespace
+ */
+namespace React { namespace Dns {
+
+/**
+ *  Constructor
+ *  @param  loop        Event loop
+ *  @param  source      The names to look up
+ *  @param  lookup      Function that starts the lookup of one name
+ *  @param  window      Max number of lookups that are on their way
+ */
+Bulk::Bulk(Loop *loop, const NameSource &source, const Lookup &lookup, size_t window) :
+    _loop(loop), _source(source), _lookup(lookup), _window(std::max(window, (size_t)1)), _started(loop->now()) {}
+
+/**
+ *  Start lookups until the window is full
+ */
+void Bulk::fill()
+{
+    // lookups that fail right away call done() from within this loop
+    if (_filling) return;
+
+    // we are busy, and keep ourselves alive while we are
+    auto self = shared_from_this();
+    _filling = true;
+
+    // the name that is looked up
+    std::string name;
+
+    // start lookups while there is room
+    while (!_exhausted && _inflight < _window)
+    {
+        // get the next name
+        if (!_source(name)) { _exhausted = true; break; }
+
+        // one more lookup is on its way
+        _inflight += 1;
+
+        // the start time, for the latency
+        Timestamp started = _loop->now();
+
+        // start the lookup, the batch stays alive until it is done
+        _lookup(name, [self, started](bool failed) { self->done(started, failed); });
+    }
+
+    // we are no longer busy
+    _filling = false;
+
+    // check if everything is done
+    if (!finished() || _finished > 0.0) return;
+
+    // remember when
+    _finished = _loop->now();
+
+    // report it
+    if (_finishedCallback) _finishedCallback();
+}
+
+/**
+ *  Called when a lookup is done
+ *  @param  started     Time at which the lookup started
+ *  @param  failed      Did the lookup fail?
+ */
+void Bulk::done(Timestamp started, bool failed)
+{
+    // the lookup is no longer on its way
+    _inflight -= 1;
+
+    // update the counters
+    _completed += 1;
+    if (failed) _failed += 1;
+
+    // update the latency
+    Timestamp latency = _loop->now() - started;
+    _latency += latency;
+    _slowest = std::max(_slowest, latency);
+
+    // start the next lookups
+    fill();
+}
+
+/**
+ *  Install the callback that is called when all lookups are done
+ *  @param  callback
+ */
+void Bulk::onFinished(const FinishedCallback &callback)
+{
+    // store the callback
+    _finishedCallback = callback;
+
+    // if we are already done it is called right away
+    if (_finished > 0.0 && callback) callback();
+}
+
+/**
+ *  Stop taking names from the source
+ */
+void Bulk::cancel()
+{
+    // no more names
+    _exhausted = true;
+
+    // the batch may be done now
+    fill();
+}
+
+/**
+ *  Number of seconds since the start, until the batch finished
+ *  @return Timestamp
+ */
+Timestamp Bulk::elapsed() const
+{
+    return (_finished > 0.0 ? _finished : _loop->now()) - _started;
+}
+
+/**
+ *  Number of lookups per second
+ *  @return double
+ */
+double Bulk::throughput() const
+{
+    // time that passed
+    Timestamp elapsed = this->elapsed();
+
+    // avoid a division by zero when everything happened in one iteration
+    return elapsed > 0.0 ? _completed / elapsed : 0.0;
+}
+
+/**
+ *  End namespace
+ */
+}}
@@ -0,0 +1,529 @@
+/**
+ *  Cache.h
+ *
+ *  Implementation-only class with the answers that a resolver received
+ *  before, indexed by name and type. Answers are kept for the lowest TTL of
+ *  their records, and when the cache is full the answer that was used least
+ *  recently is removed.
+ *
+ *  Names that do not exist (NXDOMAIN) and names without records of the
+ *  requested type (NODATA) are cached as well, for the TTL that the SOA
+ *  record in the authority section allows, or a default when there is no
+ *  SOA record. Server failures and timeouts are cached for a short backoff
+ *  period, so that a failing name does not cause a storm of retries.
+ *
+ *  The cache also knows which queries are on their way. A request for a name
+ *  and type that is already asked for does not send a query of its own, but
+ *  waits for the answer to the first one. Requests that are answered from
+ *  the cache are reported in the next iteration of the event loop, so that
+ *  callbacks are never called from within the call to Resolver::ip() or
+ *  Resolver::mx().
+ *
+ *  Every answer counts how often it is used. Answers that are used often
+ *  are hot, and when a hot answer is used in the last 10% of its TTL the
+ *  cache asks for it to be refreshed, so that it is replaced before it
+ *  expires and the lookups for it never have to wait for the server.
+ *
+ *  Resolvers in different threads can share their answers with a
+ *  SharedCache. It is consulted when an answer is not in the own cache,
+ *  and receives the answers and negative answers that come from the
+ *  servers. Failures are not shared.
+ *
+ *  @copyright 2014 Copernica BV
+ */
+
+/**
+ *  Set up namespace
+ */
+namespace React { namespace Dns {
+
+/**
+ *  Class definition
+ */
+class Cache : public std::enable_shared_from_this<Cache>
+{
+private:
+    /**
+     *  An answer together with its key
+     */
+    struct Entry
+    {
+        /**
+         *  The key of the answer
+         *  @var    std::string
+         */
+        std::string key;
+
+        /**
+         *  The answer
+         *  @var    std::shared_ptr<Answer>
+         */
+        std::shared_ptr<Answer> answer;
+
+        /**
+         *  Number of times the answer was used
+         *  @var    size_t
+         */
+        size_t hits = 0;
+
+        /**
+         *  Constructor
+         *  @param  key         The key of the answer
+         *  @param  answer      The answer
+         */
+        Entry(const std::string &key, std::shared_ptr<Answer> &&answer) :
+            key(key), answer(std::move(answer)) {}
+    };
+
+    /**
+     *  Iterators in the list of answers, by key
+     */
+    using Index = std::unordered_map<std::string, std::list<Entry>::iterator>;
+
+    /**
+     *  Pointer to the loop
+     *  @var    Loop
+     */
+    Loop *_loop;
+
+    /**
+     *  The answers, the one that was used most recently comes first
+     *  @var    std::list
+     */
+    std::list<Entry> _entries;
+
+    /**
+     *  Index of the answers by key
+     *  @var    Index
+     */
+    Index _index;
+
+    /**
+     *  The cache that is shared with resolvers in other threads
+     *  @var    std::shared_ptr<SharedCache>
+     */
+    std::shared_ptr<SharedCache> _shared;
+
+    /**
+     *  Requests that are sent and wait for an answer, by key
+     *  @var    std::unordered_map
+     */
+    std::unordered_map<std::string, Request*> _pending;
+
+    /**
+     *  Max number of answers
+     *  @var    size_t
+     */
+    size_t _capacity = 4096;
+
+    /**
+     *  TTL of negative answers without a SOA record, in seconds
+     *  @var    int
+     */
+    int _negative = 60;
+
+    /**
+     *  How long server failures and timeouts are remembered, in seconds
+     *  @var    int
+     */
+    int _backoff = 5;
+
+    /**
+     *  Upper limit for the TTL of answers, in seconds
+     *  @var    int
+     */
+    int _maximum = 604800;
+
+    /**
+     *  Number of hits after which an answer is refreshed before it expires
+     *  @var    size_t
+     */
+    size_t _prefetch = 3;
+
+    /**
+     *  Counters
+     *  @var    uint64_t
+     */
+    uint64_t _hits = 0;
+    uint64_t _misses = 0;
+    uint64_t _refreshes = 0;
+
+    /**
+     *  Requests that are answered in the next iteration
+     *  @var    std::deque
+     */
+    std::deque<std::pair<Request*, std::shared_ptr<Answer>>> _ready;
+
+    /**
+     *  Construct the key for a name and type, names are case insensitive
+     *  @param  name        The domain name
+     *  @param  type        The record type
+     *  @return std::string
+     */
+    static std::string key(const std::string &name, int type)
+    {
+        // the type goes first, followed by the lowercase name
+        std::string result(std::to_string(type));
+        result.push_back(' ');
+
+        // a trailing dot does not change the name
+        size_t size = name.size() > 0 && name.back() == '.' ? name.size() - 1 : name.size();
+
+        // add the name
+        for (size_t i = 0; i < size; ++i) result.push_back(tolower((unsigned char)name[i]));
+
+        // done
+        return result;
+    }
+
+    /**
+     *  How long a result should be kept
+     *  @param  status      Status of the query
+     *  @param  buffer      The answer in wire format
+     *  @param  len         Size of the answer
+     *  @return int         Number of seconds, zero or less if it should not be kept
+     */
+    int ttl(int status, const unsigned char *buffer, int len) const
+    {
+        // check the status
+        switch (status) {
+        case ARES_SUCCESS:
+            // answers are kept for the ttl of their records, but no longer than a week
+            return std::min(Answer::ttl(buffer, len), _maximum);
+
+        case ARES_ENOTFOUND:
+        case ARES_ENODATA: {
+            // negative answers use the SOA record, if there is one
+            int ttl = buffer == nullptr ? -1 : Answer::minimum(buffer, len);
+
+            // or the default
+            return ttl < 0 ? _negative : std::min(ttl, _maximum);
+        }
+
+        case ARES_ESERVFAIL:
+        case ARES_EREFUSED:
+        case ARES_ETIMEOUT:
+        case ARES_ECONNREFUSED:
+            // failures of the server are retried after the backoff
+            return _backoff;
+
+        default:
+            // other errors are not caused by the name
+            return 0;
+        }
+    }
+
+    /**
+     *  Remove an answer
+     *  @param  iter        Iterator in the list of answers
+     */
+    void erase(std::list<Entry>::iterator iter)
+    {
+        // remove it from the index and the list
+        _index.erase(iter->key);
+        _entries.erase(iter);
+    }
+
+    /**
+     *  Add an answer to the front, the answer with the same key should
+     *  already be removed
+     *  @param  key         Key of the answer
+     *  @param  answer      The answer
+     *  @return Index::iterator
+     */
+    Index::iterator insert(const std::string &key, std::shared_ptr<Answer> &&answer)
+    {
+        // make room
+        if (_entries.size() >= _capacity) erase(std::prev(_entries.end()));
+
+        // add the answer to the front
+        _entries.emplace_front(key, std::move(answer));
+
+        // index it
+        return _index.emplace(key, _entries.begin()).first;
+    }
+
+    /**
+     *  Answer the requests that are ready
+     */
+    void deliver()
+    {
+        // take the requests, because new ones may be added by the callbacks
+        std::deque<std::pair<Request*, std::shared_ptr<Answer>>> ready;
+        ready.swap(_ready);
+
+        // report the answers
+        for (auto &item : ready)
+        {
+            // pass the answer to the request
+            item.first->invoke(item.second->status(), item.second->data(), item.second->size());
+
+            // the request is done
+            item.first->free();
+        }
+    }
+
+public:
+    /**
+     *  Constructor
+     *  @param  loop        Event loop
+     */
+    Cache(Loop *loop) : _loop(loop) {}
+
+    /**
+     *  Destructor
+     */
+    virtual ~Cache() {}
+
+    /**
+     *  Change the max number of answers, zero disables the cache
+     *  @param  capacity
+     */
+    void capacity(size_t capacity)
+    {
+        // remember the setting
+        _capacity = capacity;
+
+        // remove the answers that no longer fit
+        while (_entries.size() > _capacity) erase(std::prev(_entries.end()));
+    }
+
+    /**
+     *  Change the TTL of negative answers without a SOA record, zero
+     *  disables caching them
+     *  @param  seconds
+     */
+    void negative(int seconds)
+    {
+        _negative = seconds;
+    }
+
+    /**
+     *  Change how long server failures and timeouts are remembered, zero
+     *  disables caching them
+     *  @param  seconds
+     */
+    void backoff(int seconds)
+    {
+        _backoff = seconds;
+    }
+
+    /**
+     *  Change how often an answer should be used before it is refreshed in
+     *  the last 10% of its TTL, zero disables refreshing
+     *  @param  hits
+     */
+    void prefetch(size_t hits)
+    {
+        _prefetch = hits;
+    }
+
+    /**
+     *  Share the answers with resolvers in other threads, or stop sharing
+     *  them with a nullptr
+     *  @param  shared
+     */
+    void share(const std::shared_ptr<SharedCache> &shared)
+    {
+        _shared = shared;
+    }
+
+    /**
+     *  Number of requests that were answered from the cache
+     *  @return uint64_t
+     */
+    uint64_t hits() const
+    {
+        return _hits;
+    }
+
+    /**
+     *  Number of requests that could not be answered from the cache
+     *  @return uint64_t
+     */
+    uint64_t misses() const
+    {
+        return _misses;
+    }
+
+    /**
+     *  Number of hot answers that were refreshed before they expired
+     *  @return uint64_t
+     */
+    uint64_t refreshes() const
+    {
+        return _refreshes;
+    }
+
+    /**
+     *  Number of answers in the cache
+     *  @return size_t
+     */
+    size_t size() const
+    {
+        return _entries.size();
+    }
+
+    /**
+     *  Store the result of a query
+     *  @param  name        The domain name
+     *  @param  type        The record type
+     *  @param  status      Status of the query
+     *  @param  buffer      The answer in wire format, if there is one
+     *  @param  len         Size of the answer
+     */
+    void store(const std::string &name, int type, int status, const unsigned char *buffer, int len)
+    {
+        // skip if the cache is disabled
+        if (_capacity == 0) return;
+
+        // results that should not be kept, or with a zero ttl, are not stored
+        int ttl = this->ttl(status, buffer, len);
+        if (ttl <= 0) return;
+
+        // only the answers are parsed again, failures do not need the buffer
+        if (status != ARES_SUCCESS) len = 0;
+
+        // the key of the answer
+        std::string key(Cache::key(name, type));
+
+        // answers and negative answers are refreshed when they are hot, failures are not
+        bool answered = status == ARES_SUCCESS || status == ARES_ENOTFOUND || status == ARES_ENODATA;
+
+        // look up the answer that we had before
+        auto iter = _index.find(key);
+        if (iter != _index.end())
+        {
+            // a failed refresh does not replace an answer that is still valid
+            if (!answered && iter->second->answer->expires() > _loop->now()) return;
+
+            // remove the answer
+            erase(iter->second);
+        }
+
+        // hot answers are refreshed in the last 10% of their ttl
+        Timestamp expires = _loop->now() + ttl;
+        Timestamp refresh = answered ? expires - ttl / 10.0 : expires;
+
+        // add the answer
+        auto answer = std::make_shared<Answer>(status, buffer, len, expires, refresh);
+        insert(key, std::shared_ptr<Answer>(answer));
+
+        // other resolvers may use it too, except when it is a failure
+        if (_shared && answered) _shared->store(key, answer, _loop->now());
+    }
+
+    /**
+     *  Let a request wait for an identical one that was already sent
+     *
+     *  If there is no such request, the request is registered as the one
+     *  that is sent, and should be passed to detach() when it is answered.
+     *
+     *  @param  request     The request
+     *  @return bool        Is the request waiting for another one?
+     */
+    bool attach(Request *request)
+    {
+        // register the request, unless there already is one
+        auto result = _pending.emplace(key(request->name(), request->type()), request);
+
+        // if it was registered it should be sent
+        if (result.second) return false;
+
+        // wait for the answer to the other request
+        result.first->second->attach(request);
+
+        // done
+        return true;
+    }
+
+    /**
+     *  Forget a request that was sent, because it is answered
+     *  @param  request     The request that was passed to attach()
+     */
+    void detach(Request *request)
+    {
+        // look up the request
+        auto iter = _pending.find(key(request->name(), request->type()));
+
+        // forget it if it is still the one that was sent
+        if (iter != _pending.end() && iter->second == request) _pending.erase(iter);
+    }
+
+    /**
+     *  Answer a request from the cache
+     *
+     *  If the answer is known, the request is answered in the next iteration
+     *  of the event loop, and freed after that. If the answer is hot and
+     *  about to expire, the refresh parameter is set, and a query for the
+     *  same name and type should be sent to replace the answer. It is set
+     *  only once for every answer.
+     *
+     *  @param  request     The request
+     *  @param  refresh     Set to true if the answer should be refreshed
+     *  @return bool        Was the request answered from the cache?
+     */
+    bool answer(Request *request, bool &refresh)
+    {
+        // skip if the cache is disabled
+        if (_capacity == 0) return false;
+
+        // look up the answer
+        std::string key(Cache::key(request->name(), request->type()));
+        auto iter = _index.find(key);
+
+        // is it missing or expired?
+        if (iter == _index.end() || iter->second->answer->expires() <= _loop->now())
+        {
+            // forget the expired answer
+            if (iter != _index.end()) erase(iter->second);
+
+            // another resolver may have received the answer
+            auto answer = _shared ? _shared->find(key, _loop->now()) : nullptr;
+
+            // if not, we have a miss and the request should be sent
+            if (!answer) { _misses += 1; return false; }
+
+            // we keep the answer ourselves too
+            iter = insert(key, std::move(answer));
+        }
+
+        // the answer is used, so it moves to the front
+        _entries.splice(_entries.begin(), _entries, iter->second);
+
+        // we have a hit
+        _hits += 1;
+
+        // the entry that is used
+        auto &entry = *iter->second;
+
+        // hot answers in the last part of their ttl are refreshed, unless that already happens
+        if (_prefetch > 0 && ++entry.hits >= _prefetch && entry.answer->refresh() <= _loop->now() && _pending.find(key) == _pending.end())
+        {
+            // the answer is refreshed only once, also by the resolvers that share it
+            refresh = entry.answer->claim();
+            if (refresh) _refreshes += 1;
+        }
+
+        // answer it in the next iteration, the timer keeps the cache alive
+        if (_ready.empty())
+        {
+            // pointer to ourselves
+            auto self = shared_from_this();
+
+            // start the timer
+            _loop->onTimeout(0.0, [self]() { self->deliver(); });
+        }
+
+        // remember the request
+        _ready.emplace_back(request, entry.answer);
+
+        // done
+        return true;
+    }
+};
+
+/**
+ *  End namespace
+ */
+}}
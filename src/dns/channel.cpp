@@ -30,6 +30,21 @@ static void timer_expires(ares_channel channel)
     ares_process(channel, &readable, &writable);
 }
 
+/**
+ *  Function that gets called when a socket of the ares library is active
+ *  @param  loop    the event loop
+ *  @param  watcher the watcher structure
+ *  @param  events  the events that happened
+ */
+static void onActive(struct ev_loop *loop, ev_io *watcher, int events)
+{
+    // retrieve a pointer to the channel
+    auto *channel = static_cast<Channel*>(watcher->data);
+
+    // let the ares library process the socket
+    ares_process_fd(*channel, events & EV_READ ? watcher->fd : ARES_SOCKET_BAD, events & EV_WRITE ? watcher->fd : ARES_SOCKET_BAD);
+}
+
 /**
  *  Callback method that is called when a socket changes state
  *  @param  data    Used-supplied-data (pointer to the resolver)
@@ -58,8 +73,17 @@ Channel::Channel(Loop *loop) : _loop(loop), _timer(_loop, 0.0, [this]() { timer_
     options.sock_state_cb = socket_state_callback;
     options.sock_state_cb_data = this;
 
+    // options that we set
+    int optmask = ARES_OPT_SOCK_STATE_CB;
+
+#ifdef ARES_OPT_QUERY_CACHE
+    // the resolver has its own cache, so the one from the ares library is not needed
+    options.qcache_max_ttl = 0;
+    optmask |= ARES_OPT_QUERY_CACHE;
+#endif
+
     // initialize the channel
-    ares_init_options(&_channel, &options, ARES_OPT_SOCK_STATE_CB);
+    ares_init_options(&_channel, &options, optmask);
 }
 
 /**
@@ -78,6 +102,9 @@ Channel::~Channel()
 
     // destroy the channel
     ares_destroy(_channel);
+
+    // stop the watchers of sockets that were not closed
+    for (auto &watcher : _watchers) if (ev_is_active(&watcher)) ev_io_stop(*_loop, &watcher);
 }
 
 /**
@@ -112,35 +139,36 @@ void Channel::setTimeout()
  */
 void Channel::check(int fd, bool read, bool write)
 {
-    // remove from the appriate sets
-    if (!read) _readers.erase(fd);
-    if (!write) _writers.erase(fd);
+    // the events to watch
+    int events = (read ? EV_READ : 0) | (write ? EV_WRITE : 0);
 
-    // insert new entry for readability
-    if (read && _readers.find(fd) == _readers.end())
-    {
-        // add a new reader
-        auto *watcher = new ReadWatcher(_loop, fd, [this,fd]() -> bool {
-            ares_process_fd(*this, fd, 0);
-            return true;
-        });
-
-        // add to the set of watcher
-        _readers[fd] = std::unique_ptr<ReadWatcher>(watcher);
-    }
+    // a socket that we do not know yet, and that needs no watcher, is done
+    if (fd < 0 || ((size_t)fd >= _watchers.size() && events == 0)) return;
 
-    // insert new entry for writability
-    if (write && _writers.find(fd) == _writers.end())
+    // make room for the socket
+    while ((size_t)fd >= _watchers.size())
     {
-        // add a watcher
-        auto *watcher = new WriteWatcher(_loop, fd, [this,fd]() -> bool {
-            ares_process_fd(*this, 0, fd);
-            return true;
-        });
-
-        // add to the set of watchers
-        _writers[fd] = std::unique_ptr<WriteWatcher>(watcher);
+        // add an inactive watcher
+        _watchers.emplace_back();
+        ev_init(&_watchers.back(), onActive);
+        _watchers.back().data = this;
     }
+
+    // the watcher of the socket
+    auto &watcher = _watchers[fd];
+
+    // nothing changes if the watcher already watches the same events
+    if (ev_is_active(&watcher) && (watcher.events & (EV_READ | EV_WRITE)) == events) return;
+
+    // stop the watcher to change it
+    if (ev_is_active(&watcher)) ev_io_stop(*_loop, &watcher);
+
+    // if the socket needs no watching we are done
+    if (events == 0) return;
+
+    // start watching the new events
+    ev_io_set(&watcher, fd, events);
+    ev_io_start(*_loop, &watcher);
 }
 
 /**
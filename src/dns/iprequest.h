@@ -27,10 +27,12 @@ public:
     /**
      *  Constructor
      *  @param  resolver    the resolver object
+     *  @param  name        the domain name
+     *  @param  version     the IP version, 4 or 6
      *  @param  callback    the callback to invoke on completion
      */
-    IpRequest(Base *resolver, const IpCallback &callback) : 
-        Request(resolver), _callback(callback) {}
+    IpRequest(Base *resolver, const std::string &name, int version, const IpCallback &callback) : 
+        Request(resolver, name, version == 6 ? ns_t_aaaa : ns_t_a), _callback(callback) {}
     
     /**
      *  Destructor
@@ -38,14 +40,19 @@ public:
     virtual ~IpRequest() {}
     
     /**
-     *  Invoke the callback
-     *  @param  result          The result to report
-     *  @param  error           Optional error message
+     *  Parse the answer, and pass the result to the callback
+     *  @param  status      Status of the query
+     *  @param  buffer      The answer buffer
+     *  @param  len         Length of the answer buffer
      */
-    void invoke(IpResult &&result, const char *error)
+    virtual void invoke(int status, const unsigned char *buffer, int len) override
     {
-        // execute the callback
-        _callback(std::move(result), error);
+        // report failure
+        if (status != ARES_SUCCESS) _callback(IpResult(), ares_strerror(status));
+
+        // report success
+        else if (_type == ns_t_aaaa) _callback(Ipv6Result(buffer, len), nullptr);
+        else _callback(Ipv4Result(buffer, len), nullptr);
     }
 };
     
@@ -20,39 +20,27 @@ public:
     /**
      *  Constructor
      *  @param  buffer      Received data
-     *  @param  len         qqSize of the data
+     *  @param  len         Size of the data
      */
     Ipv6Result(const unsigned char *buffer, int len)
     {
-        // try parsing answer
-        for (int size = 8; true; size += 4)
+        // walk over the records
+        Parser parser(buffer, len);
+        while (parser.next())
         {
-            // allocate memory
-            auto *addresses = new struct ares_addr6ttl[size];
-            
-            // wrap in smarty pointer so that it gets destructed
-            std::unique_ptr<struct ares_addr6ttl[]> ptr(addresses);
-            
-            // copy size
-            int matches = size;
-            
-            // parse the answer
-            int result = ares_parse_aaaa_reply(buffer, len, nullptr, addresses, &matches);
+            // only addresses of the name or its aliases count, they are in the answer section
+            if (parser.section() != Parser::answer) break;
+            if (parser.type() != ns_t_aaaa || parser.length() != 16 || !parser.relevant()) continue;
 
-            // on failure we leap out, otherwise we continue to allocate more memory
-            if (result != ARES_SUCCESS) return;
+            // copy the address
+            struct in6_addr address;
+            memcpy(&address, parser.data(), 16);
 
-            // check if we had enough space
-            if (matches >= size) continue;
-            
-            // we have enough space, copy the results to the object
-            for (int i=0; i<matches; i++) insert(IpRecord(&addresses[i]));
-
-            // done
-            return;
+            // create record
+            insert(IpRecord(Net::Ipv6(address), parser.ttl()));
         }
     }
-    
+
     /**
      *  Destructor
      */
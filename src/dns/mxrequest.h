@@ -27,10 +27,11 @@ public:
     /**
      *  Constructor
      *  @param  resolver    the resolver object
+     *  @param  name        the domain name
      *  @param  callback    the callback to invoke on completion
      */
-    MxRequest(Base *resolver, const MxCallback &callback) : 
-        Request(resolver), _callback(callback) {}
+    MxRequest(Base *resolver, const std::string &name, const MxCallback &callback) : 
+        Request(resolver, name, ns_t_mx), _callback(callback) {}
     
     /**
      *  Destructor
@@ -38,13 +39,18 @@ public:
     virtual ~MxRequest() {}
     
     /**
-     *  Invoke the callback
-     *  @param  result          The result to report
-     *  @param  error           Optional error message
+     *  Parse the answer, and pass the result to the callback
+     *  @param  status      Status of the query
+     *  @param  buffer      The answer buffer
+     *  @param  len         Length of the answer buffer
      */
-    void invoke(MxResult &&result, const char *error)
+    virtual void invoke(int status, const unsigned char *buffer, int len) override
     {
-        _callback(std::move(result), error);
+        // report failure
+        if (status != ARES_SUCCESS) _callback(MxResult(), ares_strerror(status));
+
+        // report success
+        else _callback(MxResult(buffer, len), nullptr);
     }
 };
     
@@ -0,0 +1,113 @@
+/**
+ *  Pool.h
+ *
+ *  Implementation-only class with the memory of requests that are done, so
+ *  that it can be used again for new requests. Every resolver has its own
+ *  pool, which is kept alive by the requests that use it.
+ *
+ *  @copyright 2014 Copernica BV
+ */
+
+/**
+ *  Set up namespace
+ */
+namespace React { namespace Dns {
+
+/**
+ *  Class definition
+ */
+class Pool
+{
+public:
+    /**
+     *  Size of each block of memory, all requests should fit in it
+     */
+    static const size_t blocksize = 256;
+
+private:
+    /**
+     *  The blocks that are not used
+     *  @var    std::vector
+     */
+    std::vector<void*> _blocks;
+
+    /**
+     *  Max number of blocks that are kept
+     *  @var    size_t
+     */
+    size_t _capacity = 1024;
+
+public:
+    /**
+     *  Constructor
+     */
+    Pool() {}
+
+    /**
+     *  Pools can not be copied
+     *  @param  that
+     */
+    Pool(const Pool &that) = delete;
+
+    /**
+     *  Destructor
+     */
+    virtual ~Pool()
+    {
+        // free all blocks
+        for (auto *block : _blocks) ::operator delete(block);
+    }
+
+    /**
+     *  Construct a request in a block
+     *  @param  args        Arguments for the constructor
+     *  @return T           The request
+     */
+    template <typename T, typename ...Args>
+    T *allocate(Args&&... args)
+    {
+        // the request should fit
+        static_assert(sizeof(T) <= blocksize, "request does not fit in a block");
+
+        // take a block that was used before, or allocate a new one
+        void *block = _blocks.empty() ? ::operator new(blocksize) : _blocks.back();
+        if (!_blocks.empty()) _blocks.pop_back();
+
+        // construct the request
+        try
+        {
+            return new (block) T(std::forward<Args>(args)...);
+        }
+        catch (...)
+        {
+            // give the block back
+            release(block);
+            throw;
+        }
+    }
+
+    /**
+     *  Give back a block, the request in it should already be destructed
+     *  @param  block
+     */
+    void release(void *block)
+    {
+        // keep the block, unless we already have enough
+        if (_blocks.size() < _capacity) _blocks.push_back(block);
+        else ::operator delete(block);
+    }
+
+    /**
+     *  Number of blocks that are kept for new requests
+     *  @return size_t
+     */
+    size_t size() const
+    {
+        return _blocks.size();
+    }
+};
+
+/**
+ *  End namespace
+ */
+}}
@@ -0,0 +1,63 @@
+/**
+ *  RecordRequest.h
+ *
+ *  Class that contains all information for a request of which the result
+ *  is parsed by a result class, like TxtResult or SrvResult
+ *
+ *  @copyright 2014 Copernica BV
+ */
+
+/**
+ *  Set up namespace
+ */
+namespace React { namespace Dns {
+
+/**
+ *  Class definition
+ */
+template <typename RESULT>
+class RecordRequest : public Request
+{
+private:
+    /**
+     *  The callback to be called
+     *  @var    std::function
+     */
+    std::function<void(RESULT &&result, const char *error)> _callback;
+
+public:
+    /**
+     *  Constructor
+     *  @param  resolver    the resolver object
+     *  @param  name        the domain name
+     *  @param  type        the record type
+     *  @param  callback    the callback to invoke on completion
+     */
+    RecordRequest(Base *resolver, const std::string &name, int type, const std::function<void(RESULT &&result, const char *error)> &callback) :
+        Request(resolver, name, type), _callback(callback) {}
+
+    /**
+     *  Destructor
+     */
+    virtual ~RecordRequest() {}
+
+    /**
+     *  Parse the answer, and pass the result to the callback
+     *  @param  status      Status of the query
+     *  @param  buffer      The answer buffer
+     *  @param  len         Length of the answer buffer
+     */
+    virtual void invoke(int status, const unsigned char *buffer, int len) override
+    {
+        // report failure
+        if (status != ARES_SUCCESS) _callback(RESULT(), ares_strerror(status));
+
+        // report success
+        else _callback(RESULT(buffer, len), nullptr);
+    }
+};
+
+/**
+ *  End namespace
+ */
+}}
@@ -0,0 +1,49 @@
+/**
+ *  RefreshRequest.h
+ *
+ *  Class for a request that is sent to replace a hot answer in the cache
+ *  before it expires. Nobody waits for the result, the answer is only
+ *  stored in the cache.
+ *
+ *  @copyright 2014 Copernica BV
+ */
+
+/**
+ *  Set up namespace
+ */
+namespace React { namespace Dns {
+
+/**
+ *  Class definition
+ */
+class RefreshRequest : public Request
+{
+public:
+    /**
+     *  Constructor
+     *  @param  resolver    the resolver object
+     *  @param  name        the domain name
+     *  @param  type        the record type
+     */
+    RefreshRequest(Base *resolver, const std::string &name, int type) :
+        Request(resolver, name, type) {}
+
+    /**
+     *  Destructor
+     */
+    virtual ~RefreshRequest() {}
+
+    /**
+     *  Nothing to report, the answer is already in the cache
+     *  @param  status      Status of the query
+     *  @param  buffer      The answer buffer
+     *  @param  len         Length of the answer buffer
+     */
+    virtual void invoke(int status, const unsigned char *buffer, int len) override {}
+};
+
+/**
+ *  End namespace
+ */
+}}
+
@@ -17,12 +17,6 @@ namespace React { namespace Dns {
 class Request
 {
 protected:
-    /**
-     *  Pointer to the resolver
-     *  @var Base
-     */
-    Base *_resolver;
-
     /**
      *  Keep a copy of the channel pointer
      *  so that it stays in scope as long
@@ -30,11 +24,45 @@ protected:
      */
     std::shared_ptr<Channel> _channel;
 
+    /**
+     *  The pool that holds the memory of the request
+     *  @var    Pool
+     */
+    std::shared_ptr<Pool> _pool;
+
+    /**
+     *  The cache in which the answer is stored, it is kept in scope
+     *  for the same reason
+     *  @var    Cache
+     */
+    std::shared_ptr<Cache> _cache;
+
+    /**
+     *  The domain name
+     *  @var    std::string
+     */
+    std::string _name;
+
+    /**
+     *  The record type
+     *  @var    int
+     */
+    int _type;
+
+    /**
+     *  Identical requests that wait for the answer to this one
+     *  @var    std::vector
+     */
+    std::vector<Request*> _waiters;
+
     /**
      *  Constructor
      *  @param  resolver    the resolver object
+     *  @param  name        the domain name
+     *  @param  type        the record type
      */
-    Request(Base *resolver) : _resolver(resolver), _channel(resolver->channel()) {}
+    Request(Base *resolver, const std::string &name, int type) :
+        _channel(resolver->channel()), _pool(resolver->pool()), _cache(resolver->cache()), _name(name), _type(type) {}
 
 public:
     /**
@@ -43,16 +71,92 @@ public:
     virtual ~Request() {}
 
     /**
-     *  Schedule a delete of the request
-     *
-     *  This will delete the request in
-     *  a later iteration of the event
-     *  loop.
+     *  The domain name
+     *  @return std::string
+     */
+    const std::string &name() const
+    {
+        return _name;
+    }
+
+    /**
+     *  The record type
+     *  @return int
+     */
+    int type() const
+    {
+        return _type;
+    }
+
+    /**
+     *  The channel that runs the query
+     *  @return std::shared_ptr<Channel>
+     */
+    const std::shared_ptr<Channel> &channel() const
+    {
+        return _channel;
+    }
+
+    /**
+     *  The cache in which the answer is stored
+     *  @return Cache
+     */
+    Cache *cache() const
+    {
+        return _cache.get();
+    }
+
+    /**
+     *  Parse the answer, and pass the result to the callback
+     *  @param  status      Status of the query
+     *  @param  buffer      The answer buffer
+     *  @param  len         Length of the answer buffer
+     */
+    virtual void invoke(int status, const unsigned char *buffer, int len) = 0;
+
+    /**
+     *  Let an identical request wait for the answer to this one
+     *  @param  request     the request, which is freed together with this one
+     */
+    void attach(Request *request)
+    {
+        _waiters.push_back(request);
+    }
+
+    /**
+     *  Pass the answer to this request and the ones that wait for it, and
+     *  free them all
+     *  @param  status      Status of the query
+     *  @param  buffer      The answer buffer
+     *  @param  len         Length of the answer buffer
+     */
+    void complete(int status, const unsigned char *buffer, int len)
+    {
+        // report the result
+        invoke(status, buffer, len);
+
+        // the waiters get the same result
+        for (auto *waiter : _waiters)
+        {
+            waiter->invoke(status, buffer, len);
+            waiter->free();
+        }
+
+        // the request is done
+        free();
+    }
+
+    /**
+     *  Destruct the request, and give its memory back to the pool
      */
     void free()
     {
-        // schedule a timeout on the loop
-        _resolver->loop()->onTimeout(0, [this]() { delete this; });
+        // take over the pool, so that it stays in scope until the memory is back
+        auto pool = std::move(_pool);
+
+        // destruct ourselves, and recycle the memory
+        this->~Request();
+        pool->release(this);
     }
 };
 
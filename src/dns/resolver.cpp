@@ -10,94 +10,6 @@
  */
 namespace React { namespace Dns {
 
-/**
- *  Callback method that is called when a resolver call for IPv4 addresses completed
- *  @param  data    User-supplied-data (pointer to the resolver-request)
- *  @param  status  Status of the resolver
- *  @param  timeout Number of times that a query timed out
- *  @param  buffer  The answer buffer
- *  @param  len     Length of the answer buffer
- */
-static void ipv4callback(void *data, int status, int timeout, unsigned char *buffer, int len)
-{
-    // retrieve pointer to the request (and put it in a unique ptr so that it will be destructed)
-    auto request = static_cast<IpRequest*>(data);
-
-    // check result
-    if (status == ARES_SUCCESS)
-    {
-        // report success
-        request->invoke(Ipv4Result(buffer, len), nullptr);
-    }
-    else
-    {
-        // report failure
-        request->invoke(IpResult(), ares_strerror(status));
-    }
-
-    // free the request when it is done
-    request->free();
-}
-
-/**
- *  Callback method that is called when a resolver call for IPv6 addresses completed
- *  @param  data    User-supplied-data (pointer to the resolver-request)
- *  @param  status  Status of the resolver
- *  @param  timeout Number of times that a query timed out
- *  @param  buffer  The answer buffer
- *  @param  len     Length of the answer buffer
- */
-static void ipv6callback(void *data, int status, int timeout, unsigned char *buffer, int len)
-{
-    // retrieve pointer to the request (and put it in a unique ptr so that it will be destructed)
-    // auto request = std::unique_ptr<IpRequest>((IpRequest *)data);
-    auto request = static_cast<IpRequest*>(data);
-
-    // check result
-    if (status == ARES_SUCCESS)
-    {
-        // report success
-        request->invoke(Ipv6Result(buffer, len), nullptr);
-    }
-    else
-    {
-        // report failure
-        request->invoke(IpResult(), ares_strerror(status));
-    }
-
-    // free the request when it is done
-    request->free();
-}
-
-/**
- *  Callback method that is called when a resolver call for MX records completed
- *  @param  data    User-supplied-data (pointer to the resolver-request)
- *  @param  status  Status of the resolver
- *  @param  timeout Number of times that a query timed out
- *  @param  buffer  The answer buffer
- *  @param  len     Length of the answer buffer
- */
-static void mxcallback(void *data, int status, int timeout, unsigned char *buffer, int len)
-{
-    // retrieve pointer to the request (and put it in a unique ptr so that it will be destructed)
-    auto request = static_cast<MxRequest*>(data);
-
-    // check result
-    if (status == ARES_SUCCESS)
-    {
-        // report success
-        request->invoke(MxResult(buffer, len), nullptr);
-    }
-    else
-    {
-        // report failure
-        request->invoke(MxResult(), ares_strerror(status));
-    }
-
-    // free the request when it is done
-    request->free();
-}
-
 /**
  *  Resolve IPv4 addresses
  *  @param  name            The domain to resolve
@@ -110,31 +22,11 @@ bool Resolver::ip(const std::string &domain, int version, const IpCallback &call
     // channel should be valid
     if (!*_channel) return false;
 
-    // construct request object
-    auto *request = new IpRequest(this, callback);
-
-    // what version do we need?
-    if (version == 6)
-    {
-        // tell the ares library to run the AAAA query
-        ares_query(*_channel, domain.c_str(), ns_c_in, ns_t_aaaa, ipv6callback, request);
-    }
-    else if (version == 4)
-    {
-        // tell the ares library to run the A query
-        ares_query(*_channel, domain.c_str(), ns_c_in, ns_t_a, ipv4callback, request);
-    }
-    else
-    {
-        // error
-        return false;
-    }
-
-    // set a new timeout
-    _channel->setTimeout();
+    // only IPv4 and IPv6 are supported
+    if (version != 4 && version != 6) return false;
 
-    // done
-    return true;
+    // run the A or AAAA query
+    return query(_pool->allocate<IpRequest>(static_cast<Base*>(this), domain, version, callback));
 }
 
 /**
@@ -187,17 +79,250 @@ bool Resolver::mx(const std::string &domain, const MxCallback &callback)
     // channel should be valid
     if (!*_channel) return false;
 
-    // construct request object
-    auto *request = new MxRequest(this, callback);
+    // run the MX query
+    return query(_pool->allocate<MxRequest>(static_cast<Base*>(this), domain, callback));
+}
+
+/**
+ *  Find all TXT records for a certain domain
+ *  @param  domain      The domain name to search TXT records for
+ *  @param  callback    Callback that is called when found
+ *  @return bool
+ */
+bool Resolver::txt(const std::string &domain, const TxtCallback &callback)
+{
+    // channel should be valid
+    if (!*_channel) return false;
+
+    // run the TXT query
+    return query(_pool->allocate<RecordRequest<TxtResult>>(static_cast<Base*>(this), domain, ns_t_txt, callback));
+}
+
+/**
+ *  Find the names that belong to an IP address
+ *  @param  ip          The address to do a reverse lookup for
+ *  @param  callback    Callback that is called when found
+ *  @return bool
+ */
+bool Resolver::ptr(const Net::Ip &ip, const PtrCallback &callback)
+{
+    // channel should be valid
+    if (!*_channel) return false;
+
+    // the name is built from the address, starting with the last part
+    std::string name;
+
+    // check the version
+    if (ip.version() == 4)
+    {
+        // the bytes of the address
+        auto *bytes = (const unsigned char *)ip.v4().internal();
+
+        // the bytes in reverse order
+        for (int i = 3; i >= 0; --i) name.append(std::to_string(bytes[i])).append(".");
+
+        // add the domain for IPv4
+        name.append("in-addr.arpa");
+    }
+    else if (ip.version() == 6)
+    {
+        // the bytes of the address
+        auto *bytes = (const unsigned char *)ip.v6().internal();
+
+        // the nibbles in reverse order
+        static const char *digits = "0123456789abcdef";
+        for (int i = 15; i >= 0; --i)
+        {
+            name.push_back(digits[bytes[i] & 0x0f]);
+            name.push_back('.');
+            name.push_back(digits[bytes[i] >> 4]);
+            name.push_back('.');
+        }
+
+        // add the domain for IPv6
+        name.append("ip6.arpa");
+    }
+    else return false;
 
-    // tell the ares library to run the AAAA query
-    ares_query(*_channel, domain.c_str(), ns_c_in, ns_t_mx, mxcallback, request);
+    // run the PTR query
+    return query(_pool->allocate<RecordRequest<PtrResult>>(static_cast<Base*>(this), name, ns_t_ptr, callback));
+}
 
-    // set a new timeout
-    _channel->setTimeout();
+/**
+ *  Find all SRV records for a service
+ *  @param  service     The name of the service
+ *  @param  callback    Callback that is called when found
+ *  @return bool
+ */
+bool Resolver::srv(const std::string &service, const SrvCallback &callback)
+{
+    // channel should be valid
+    if (!*_channel) return false;
+
+    // run the SRV query
+    return query(_pool->allocate<RecordRequest<SrvResult>>(static_cast<Base*>(this), service, ns_t_srv, callback));
+}
+
+/**
+ *  Find all TLSA records for a service
+ *  @param  service     The name of the service
+ *  @param  callback    Callback that is called when found
+ *  @return bool
+ */
+bool Resolver::tlsa(const std::string &service, const TlsaCallback &callback)
+{
+    // channel should be valid
+    if (!*_channel) return false;
+
+    // run the TLSA query
+    return query(_pool->allocate<RecordRequest<TlsaResult>>(static_cast<Base*>(this), service, ns_t_tlsa, callback));
+}
+
+/**
+ *  Look up the IP addresses of a batch of names
+ *  @param  source      Function that produces the names
+ *  @param  version     IP version, can be 4 or 6
+ *  @param  callback    Callback that is called for every name
+ *  @param  window      Max number of lookups that are on their way
+ *  @return std::shared_ptr<Bulk>
+ */
+std::shared_ptr<Bulk> Resolver::bulk(const NameSource &source, int version, const BulkIpCallback &callback, size_t window)
+{
+    // function that looks up one name
+    auto lookup = [this, version, callback](const std::string &name, const std::function<void(bool)> &done) {
+
+        // the callback for the lookup passes the name on, and tells the batch
+        auto handler = [name, callback, done](IpResult &&ips, const char *error) {
+            callback(name, std::move(ips), error);
+            done(error != nullptr);
+        };
+
+        // start the lookup, or report the failure right away
+        if (!ip(name, version, handler)) handler(IpResult(), "failed to start lookup");
+    };
+
+    // construct the batch, and start the first lookups
+    auto result = std::shared_ptr<Bulk>(new Bulk(_loop, source, lookup, window));
+    result->fill();
+
+    // done
+    return result;
+}
+
+/**
+ *  Look up the MX records of a batch of names
+ *  @param  source      Function that produces the names
+ *  @param  callback    Callback that is called for every name
+ *  @param  window      Max number of lookups that are on their way
+ *  @return std::shared_ptr<Bulk>
+ */
+std::shared_ptr<Bulk> Resolver::bulk(const NameSource &source, const BulkMxCallback &callback, size_t window)
+{
+    // function that looks up one name
+    auto lookup = [this, callback](const std::string &name, const std::function<void(bool)> &done) {
+
+        // the callback for the lookup passes the name on, and tells the batch
+        auto handler = [name, callback, done](MxResult &&mxs, const char *error) {
+            callback(name, std::move(mxs), error);
+            done(error != nullptr);
+        };
+
+        // start the lookup, or report the failure right away
+        if (!mx(name, handler)) handler(MxResult(), "failed to start lookup");
+    };
+
+    // construct the batch, and start the first lookups
+    auto result = std::shared_ptr<Bulk>(new Bulk(_loop, source, lookup, window));
+    result->fill();
 
     // done
-    return true;
+    return result;
+}
+
+/**
+ *  Use different name servers than the ones from /etc/resolv.conf
+ *  @param  servers     Comma separated list of servers, like "127.0.0.1:5353,[::1]:53"
+ *  @return bool
+ */
+bool Resolver::servers(const std::string &servers)
+{
+    // channel should be valid
+    if (!*_channel) return false;
+
+    // pass them to the ares library
+    return ares_set_servers_ports_csv(*_channel, servers.c_str()) == ARES_SUCCESS;
+}
+
+/**
+ *  Change the max number of answers in the cache, zero disables the cache
+ *  @param  capacity
+ */
+void Resolver::capacity(size_t capacity)
+{
+    _cache->capacity(capacity);
+}
+
+/**
+ *  Change how long negative answers without a SOA record are cached
+ *  @param  seconds
+ */
+void Resolver::negative(int seconds)
+{
+    _cache->negative(seconds);
+}
+
+/**
+ *  Change how long server failures and timeouts are cached
+ *  @param  seconds
+ */
+void Resolver::backoff(int seconds)
+{
+    _cache->backoff(seconds);
+}
+
+/**
+ *  Change how often an answer should be used before it is refreshed
+ *  @param  hits
+ */
+void Resolver::prefetch(size_t hits)
+{
+    _cache->prefetch(hits);
+}
+
+/**
+ *  Share the answers with the resolvers of other loops
+ *  @param  cache
+ */
+void Resolver::share(const std::shared_ptr<SharedCache> &cache)
+{
+    _cache->share(cache);
+}
+
+/**
+ *  Number of lookups that were answered from the cache
+ *  @return uint64_t
+ */
+uint64_t Resolver::hits() const
+{
+    return _cache->hits();
+}
+
+/**
+ *  Number of lookups that could not be answered from the cache
+ *  @return uint64_t
+ */
+uint64_t Resolver::misses() const
+{
+    return _cache->misses();
+}
+
+/**
+ *  Number of answers that were refreshed before they expired
+ *  @return uint64_t
+ */
+uint64_t Resolver::refreshes() const
+{
+    return _cache->refreshes();
 }
 
 /**
@@ -0,0 +1,230 @@
+/**
+ *  Shard.h
+ *
+ *  Implementation-only class with a part of the answers of a shared cache.
+ *  The answers are kept in two identical tables. Readers use the active
+ *  table, and never wait: they only announce themselves with a counter.
+ *  A writer updates the other table first, makes it the active one, waits
+ *  until the readers have left the old table, and updates that one too.
+ *  Writers do wait for each other, with a mutex.
+ *
+ *  @copyright 2014 Copernica BV
+ */
+
+/**
+ *  Set up namespace
+ */
+namespace React { namespace Dns {
+
+/**
+ *  Class definition
+ */
+class Shard
+{
+private:
+    /**
+     *  Answers indexed by key
+     */
+    using Table = std::unordered_map<std::string, std::shared_ptr<Answer>>;
+
+    /**
+     *  The two copies of the answers
+     *  @var    Table
+     */
+    Table _tables[2];
+
+    /**
+     *  Index of the table that readers should use
+     *  @var    std::atomic<int>
+     */
+    std::atomic<int> _active;
+
+    /**
+     *  Number of readers of each table, readers that only look change it too
+     *  @var    std::atomic<int>
+     */
+    mutable std::atomic<int> _readers[2];
+
+    /**
+     *  Mutex for the writers
+     *  @var    std::mutex
+     */
+    std::mutex _mutex;
+
+    /**
+     *  Max number of answers
+     *  @var    size_t
+     */
+    size_t _capacity;
+
+    /**
+     *  Start reading from the active table
+     *  @return int         Index of the table, which should be passed to leave()
+     */
+    int enter() const
+    {
+        // try until the table is still active after we announced ourselves,
+        // otherwise a writer may not have seen us
+        while (true)
+        {
+            // the table that is active right now
+            int index = _active.load();
+
+            // announce ourselves, and check that the table is still active
+            _readers[index].fetch_add(1);
+            if (_active.load() == index) return index;
+
+            // a writer switched the tables in the meantime
+            _readers[index].fetch_sub(1);
+        }
+    }
+
+    /**
+     *  Stop reading from a table
+     *  @param  index       The index returned by enter()
+     */
+    void leave(int index) const
+    {
+        _readers[index].fetch_sub(1);
+    }
+
+    /**
+     *  Apply the same change to both tables
+     *  @param  change      Function that changes a table
+     */
+    template <typename CHANGE>
+    void modify(const CHANGE &change)
+    {
+        // one writer at a time
+        std::lock_guard<std::mutex> lock(_mutex);
+
+        // the readers that use the inactive table all left it when the
+        // previous writer switched, so it can be changed right away
+        int active = _active.load();
+        change(_tables[1 - active]);
+
+        // new readers use the changed table
+        _active.store(1 - active);
+
+        // wait for the readers of the old table to leave, and change it too
+        while (_readers[active].load() > 0) std::this_thread::yield();
+        change(_tables[active]);
+    }
+
+public:
+    /**
+     *  Constructor
+     *  @param  capacity    Max number of answers
+     */
+    Shard(size_t capacity) : _active(0), _capacity(capacity)
+    {
+        // nobody reads yet
+        _readers[0] = 0;
+        _readers[1] = 0;
+    }
+
+    /**
+     *  Shards can not be copied
+     *  @param  that
+     */
+    Shard(const Shard &that) = delete;
+
+    /**
+     *  Destructor
+     */
+    virtual ~Shard() {}
+
+    /**
+     *  Look up an answer that has not yet expired
+     *  @param  key         Key of the answer
+     *  @param  now         The current time
+     *  @return std::shared_ptr<Answer>
+     */
+    std::shared_ptr<Answer> find(const std::string &key, Timestamp now) const
+    {
+        // the table to read from
+        int index = enter();
+
+        // look up the answer
+        std::shared_ptr<Answer> result;
+        auto iter = _tables[index].find(key);
+        if (iter != _tables[index].end() && iter->second->expires() > now) result = iter->second;
+
+        // done with the table
+        leave(index);
+
+        // done
+        return result;
+    }
+
+    /**
+     *  Store an answer
+     *  @param  key         Key of the answer
+     *  @param  answer      The answer
+     *  @param  now         The current time
+     */
+    void store(const std::string &key, const std::shared_ptr<Answer> &answer, Timestamp now)
+    {
+        // the same change is made to both tables, so it should not depend on
+        // anything else than the table, like the order of the answers in it
+        modify([this, &key, &answer, now](Table &table) {
+
+            // an answer that replaces an older one always fits
+            auto iter = table.find(key);
+            if (iter != table.end()) { iter->second = answer; return; }
+
+            // if the table is full the expired answers are removed
+            if (table.size() >= _capacity)
+            {
+                for (auto iter = table.begin(); iter != table.end(); )
+                {
+                    if (iter->second->expires() <= now) iter = table.erase(iter);
+                    else ++iter;
+                }
+            }
+
+            // if it is still full, the answer that expires first is removed
+            if (table.size() >= _capacity && table.size() > 0)
+            {
+                // find the answer, ties are decided by the key
+                auto oldest = table.begin();
+                for (auto iter = table.begin(); iter != table.end(); ++iter)
+                {
+                    if (iter->second->expires() > oldest->second->expires()) continue;
+                    if (iter->second->expires() == oldest->second->expires() && iter->first > oldest->first) continue;
+                    oldest = iter;
+                }
+
+                // remove it
+                table.erase(oldest);
+            }
+
+            // add the answer
+            if (_capacity > 0) table.emplace(key, answer);
+        });
+    }
+
+    /**
+     *  Number of answers
+     *  @return size_t
+     */
+    size_t size() const
+    {
+        // the table to read from
+        int index = enter();
+
+        // the number of answers
+        size_t result = _tables[index].size();
+
+        // done with the table
+        leave(index);
+
+        // done
+        return result;
+    }
+};
+
+/**
+ *  End namespace
+ */
+}}
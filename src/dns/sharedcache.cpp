@@ -0,0 +1,81 @@
+/**
+ *  SharedCache.cpp
+ *
+ *  @copyright 2014 Copernica BV
+ */
+#include "includes.h"
+
+/**
+ *  Set up namespace
+ */
+namespace React { namespace Dns {
+
+/**
+ *  Constructor
+ *  @param  capacity    Max number of answers
+ *  @param  shards      Number of shards
+ */
+SharedCache::SharedCache(size_t capacity, size_t shards)
+{
+    // there is at least one shard
+    shards = std::max(shards, (size_t)1);
+
+    // the capacity is divided over the shards
+    for (size_t i = 0; i < shards; ++i) _shards.emplace_back(new Shard((capacity + shards - 1) / shards));
+}
+
+/**
+ *  Destructor
+ */
+SharedCache::~SharedCache() {}
+
+/**
+ *  The shard that holds the answer for a key
+ *  @param  key         Key of the answer
+ *  @return Shard
+ */
+Shard &SharedCache::shard(const std::string &key) const
+{
+    return *_shards[std::hash<std::string>()(key) % _shards.size()];
+}
+
+/**
+ *  Look up an answer that has not yet expired
+ *  @param  key         Key of the answer
+ *  @param  now         The current time
+ *  @return std::shared_ptr<Answer>
+ */
+std::shared_ptr<Answer> SharedCache::find(const std::string &key, Timestamp now) const
+{
+    return shard(key).find(key, now);
+}
+
+/**
+ *  Store an answer
+ *  @param  key         Key of the answer
+ *  @param  answer      The answer
+ *  @param  now         The current time
+ */
+void SharedCache::store(const std::string &key, const std::shared_ptr<Answer> &answer, Timestamp now)
+{
+    shard(key).store(key, answer, now);
+}
+
+/**
+ *  Number of answers in the cache
+ *  @return size_t
+ */
+size_t SharedCache::size() const
+{
+    // add up the shards
+    size_t result = 0;
+    for (auto &shard : _shards) result += shard->size();
+
+    // done
+    return result;
+}
+
+/**
+ *  End namespace
+ */
+}}
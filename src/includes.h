@@ -15,8 +15,12 @@
 #include <memory>
 #include <map>
 #include <set>
+#include <list>
+#include <vector>
+#include <unordered_map>
 #include <deque>
 #include <mutex>
+#include <atomic>
 #include <thread>
 #include <condition_variable>
 #include <iostream>
@@ -46,11 +50,22 @@
 #include "../include/net/ipv6.h"
 #include "../include/net/ip.h"
 #include "../include/dns/iprecord.h"
+#include "../include/dns/parser.h"
 #include "../include/dns/mxrecord.h"
 #include "../include/dns/mxresult.h"
+#include "../include/dns/txtrecord.h"
+#include "../include/dns/txtresult.h"
+#include "../include/dns/ptrrecord.h"
+#include "../include/dns/ptrresult.h"
+#include "../include/dns/srvrecord.h"
+#include "../include/dns/srvresult.h"
+#include "../include/dns/tlsarecord.h"
+#include "../include/dns/tlsaresult.h"
 #include "../include/dns/types.h"
+#include "../include/dns/sharedcache.h"
 #include "../include/dns/channel.h"
 #include "../include/dns/base.h"
+#include "../include/dns/bulk.h"
 #include "../include/dns/resolver.h"
 #include "workerimpl.h"
 #include "loopworkerimpl.h"
@@ -63,9 +78,15 @@
 #include "shared/signal.h"
 #include "shared/status.h"
 #include "shared/cleanup.h"
-#include "dns/request.h"
-#include "dns/iprequest.h"
-#include "dns/mxrequest.h"
 #include "dns/ipv4result.h"
 #include "dns/ipv6result.h"
 #include "dns/ipallresult.h"
+#include "dns/answer.h"
+#include "dns/shard.h"
+#include "dns/pool.h"
+#include "dns/request.h"
+#include "dns/cache.h"
+#include "dns/iprequest.h"
+#include "dns/mxrequest.h"
+#include "dns/recordrequest.h"
+#include "dns/refreshrequest.h"
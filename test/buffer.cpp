@@ -0,0 +1,73 @@
+/**
+ *  Buffer.cpp
+ *
+ *  Tests for the Tcp::Buffer class
+ *
+ *  @copyright 2014 Copernica BV
+ */
+
+#include <../reactcpp.h>
+#include <gtest/gtest.h>
+
+TEST(Buffer, Iterator)
+{
+    React::Tcp::Buffer buffer;
+    buffer.add("hel", 3);
+    buffer.add("", 0);
+    buffer.add("lo w", 4);
+    buffer.add("orld", 4);
+
+    // walk over all bytes
+    std::string result(buffer.begin(), buffer.end());
+    EXPECT_EQ("hello world", result);
+
+    // walk over the chunks
+    std::vector<size_t> chunks;
+    for (auto iter = buffer.begin(); iter != buffer.end(); iter.advance(iter.available())) chunks.push_back(iter.available());
+    std::vector<size_t> expected = { 3, 4, 4 };
+    EXPECT_EQ(expected, chunks);
+}
+
+TEST(Buffer, Find)
+{
+    React::Tcp::Buffer buffer;
+    buffer.add("line 1\r\n", 8);
+    buffer.add("line 2\r", 7);
+    buffer.add("\n.", 2);
+    buffer.add("\r\n", 2);
+
+    // patterns that are spread out over chunks
+    EXPECT_EQ(14, buffer.find("\r\n.\r\n", 5));
+    EXPECT_EQ(15, buffer.find("\n.\r", 3));
+    EXPECT_EQ(6, buffer.find("\r\nline", 6));
+    EXPECT_EQ(-1, buffer.find("\r\n\r\n", 4));
+    EXPECT_EQ(-1, buffer.find("\r\n.\r\n.", 6));
+}
+
+TEST(Buffer, PeekConsume)
+{
+    React::Tcp::Buffer buffer;
+    buffer.add("\0\5he", 4);
+    buffer.add("llo!", 4);
+
+    // peek at the length prefix
+    unsigned char header[2];
+    ASSERT_EQ(2u, buffer.peek((char *)header, 2));
+    ASSERT_EQ(8u, buffer.size());
+    size_t length = header[0] << 8 | header[1];
+    ASSERT_EQ(5u, length);
+
+    // peek at the payload, which is spread out over the chunks
+    char payload[8];
+    ASSERT_EQ(length, buffer.peek(payload, length, 2));
+    EXPECT_EQ("hello", std::string(payload, length));
+
+    // consume the frame
+    EXPECT_EQ(7u, buffer.consume(2 + length));
+    EXPECT_EQ(1u, buffer.size());
+    EXPECT_EQ('!', *buffer.begin());
+
+    // peeking beyond the end copies what is there
+    EXPECT_EQ(1u, buffer.peek(payload, sizeof(payload)));
+    EXPECT_EQ(0u, buffer.peek(payload, sizeof(payload), 5));
+}
@@ -0,0 +1,109 @@
+/**
+ *  Compress.cpp
+ *
+ *  Tests for the compression stages
+ *
+ *  @copyright 2014 Copernica BV
+ */
+
+#include <../reactcpp.h>
+#include <reactcpp/tcp/compressor.h>
+#include <reactcpp/tcp/decompressor.h>
+#include <gtest/gtest.h>
+
+TEST(Compress, RoundTrip)
+{
+    using React::Tcp::Connection;
+
+    int pair[2];
+    ASSERT_EQ(socketpair(AF_UNIX, SOCK_STREAM, 0, pair), 0);
+
+    React::MainLoop loop;
+    // Timeout after 5 seconds
+    loop.onTimeout(5.0, [&loop]() {
+        loop.stop();
+        FAIL() << "Timeout";
+    });
+
+    Connection sender(&loop, pair[0]);
+    Connection receiver(&loop, pair[1]);
+
+    React::Tcp::Out out(&sender);
+    React::Tcp::In<> in(&receiver);
+
+    // a small chunk is compressed right away, a large one in the thread
+    React::Tcp::Compressor compressor(&loop, &out, Z_DEFAULT_COMPRESSION, 4096);
+
+    std::string received;
+    React::Tcp::Decompressor decompressor([&received](const void *buffer, size_t size) -> bool {
+        received.append((const char *)buffer, size);
+        return true;
+    });
+
+    in.onData([&decompressor](const void *buffer, size_t size) -> bool {
+        return decompressor.process(buffer, size);
+    });
+    in.onLost([&loop]() { loop.stop(); });
+
+    std::string small("hello world\n");
+    std::string large;
+    for (int i = 0; i < 10000; ++i) large.append("replicated record ").append(std::to_string(i % 10)).append("\n");
+
+    ASSERT_EQ(small.size(), compressor.send(small.data(), small.size()));
+    ASSERT_EQ(large.size(), compressor.send(large.data(), large.size()));
+    ASSERT_EQ(small.size(), compressor.send(small.data(), small.size()));
+    ASSERT_TRUE(compressor.close());
+    ASSERT_EQ(0u, compressor.send(small.data(), small.size()));
+
+    loop.run();
+
+    EXPECT_EQ(small + large + small, received);
+    EXPECT_FALSE(decompressor.error());
+    EXPECT_EQ(received.size(), compressor.bytesIn());
+    EXPECT_EQ(compressor.bytesOut(), decompressor.bytesIn());
+    EXPECT_GT(compressor.ratio(), 10.0);
+    EXPECT_GT(compressor.cpuTime(), 0.0);
+}
+
+TEST(Compress, ClosedOutput)
+{
+    using React::Tcp::Connection;
+
+    int pair[2];
+    ASSERT_EQ(socketpair(AF_UNIX, SOCK_STREAM, 0, pair), 0);
+
+    React::MainLoop loop;
+    Connection sender(&loop, pair[0]);
+    Connection receiver(&loop, pair[1]);
+
+    React::Tcp::Out out(&sender);
+    React::Tcp::Compressor compressor(&loop, &out);
+
+    // the output is closed behind the back of the compressor
+    ASSERT_TRUE(out.close());
+
+    // the callback is still called
+    bool closed = false;
+    ASSERT_TRUE(compressor.close([&closed]() { closed = true; }));
+    EXPECT_TRUE(closed);
+}
+
+TEST(Compress, StopDecompressing)
+{
+    // a buffer that decompresses into many blocks
+    std::string data(100000, 'x');
+    std::string compressed(compressBound(data.size()), '\0');
+    uLongf size = compressed.size();
+    ASSERT_EQ(Z_OK, compress((Bytef *)&compressed[0], &size, (const Bytef *)data.data(), data.size()));
+
+    // the callback is not called again after it returned false
+    int calls = 0;
+    React::Tcp::Decompressor decompressor([&calls](const void *buffer, size_t size) -> bool {
+        calls++;
+        return false;
+    });
+
+    EXPECT_FALSE(decompressor.process(compressed.data(), size));
+    EXPECT_EQ(1, calls);
+    EXPECT_FALSE(decompressor.error());
+}
@@ -0,0 +1,78 @@
+/**
+ *  Connect.cpp
+ *
+ *  Tests for outgoing connection attempts
+ *
+ *  @copyright 2014 Copernica BV
+ */
+
+#include <../reactcpp.h>
+#include <gtest/gtest.h>
+
+TEST(Connect, Refused)
+{
+    using namespace React;
+
+    MainLoop loop;
+    // Timeout after 5 seconds
+    loop.onTimeout(5.0, [&loop]() {
+        loop.stop();
+        FAIL() << "Timeout";
+    });
+
+    // find a port on which nobody listens
+    uint16_t port;
+    {
+        Tcp::Server server(&loop, Net::Ip("127.0.0.1"), 0);
+        port = server.address().port();
+    }
+
+    Tcp::Connection connection(&loop, Net::Ip("127.0.0.1"), port, 1.0);
+
+    std::string error;
+    connection.onConnected([&](const char *message) {
+        error = message ? message : "";
+        loop.stop();
+    });
+
+    loop.run();
+
+    EXPECT_EQ(strerror(ECONNREFUSED), error);
+}
+
+TEST(Connect, Timeout)
+{
+    using namespace React;
+
+    MainLoop loop;
+    // Timeout after 5 seconds
+    loop.onTimeout(5.0, [&loop]() {
+        loop.stop();
+        FAIL() << "Timeout";
+    });
+
+    // a server with a full backlog drops new handshakes
+    Tcp::Server server(&loop, Net::Ip("127.0.0.1"), 0);
+    ASSERT_EQ(listen(server.fd(), 0), 0);
+
+    std::vector<std::unique_ptr<Tcp::Connection>> fillers;
+    for (int i = 0; i < 4; ++i) fillers.emplace_back(new Tcp::Connection(&loop, server.address()));
+
+    // give the handshakes of the fillers some time
+    loop.onTimeout(0.1, [&loop]() { loop.stop(); });
+    loop.run();
+
+    Timestamp started = loop.now();
+    Tcp::Connection connection(&loop, server.address(), 0.2);
+
+    std::string error;
+    connection.onConnected([&](const char *message) {
+        error = message ? message : "";
+        loop.stop();
+    });
+
+    loop.run();
+
+    EXPECT_EQ(strerror(ETIMEDOUT), error);
+    EXPECT_GE(loop.now() - started, 0.19);
+}
@@ -8,6 +8,165 @@
 
 #include <../reactcpp.h>
 #include <gtest/gtest.h>
+#include <thread>
+#include <atomic>
+
+/**
+ *  Minimal name server on the loopback interface, that answers A queries
+ *  for the names that it knows with 127.0.0.1, other queries for those names
+ *  without records, unknown names with NXDOMAIN and failing names with
+ *  SERVFAIL. Negative answers hold a SOA record if the minimum is set.
+ *  Names in the zone are answered with their records of the requested type,
+ *  and CNAME records are followed.
+ */
+class Stub
+{
+public:
+    static std::string encode(const std::string &name)
+    {
+        std::string result;
+        size_t start = 0;
+        while (start < name.size())
+        {
+            size_t end = name.find('.', start);
+            if (end == std::string::npos) end = name.size();
+            result.push_back(end - start);
+            result.append(name, start, end - start);
+            start = end + 1;
+        }
+        result.push_back(0);
+        return result;
+    }
+
+    static std::string decode(const std::string &name)
+    {
+        std::string result;
+        for (size_t pos = 0; pos < name.size() && name[pos] != 0; pos += name[pos] + 1)
+        {
+            if (!result.empty()) result.push_back('.');
+            result.append(name, pos + 1, name[pos]);
+        }
+        return result;
+    }
+
+private:
+    int _fd;
+    std::shared_ptr<React::ReadWatcher> _reader;
+
+    void process()
+    {
+        unsigned char buffer[512];
+        struct sockaddr_in peer;
+        socklen_t size = sizeof(peer);
+        ssize_t len = recvfrom(_fd, buffer, sizeof(buffer), 0, (struct sockaddr *)&peer, &size);
+        if (len < 12) return;
+
+        // parse the question
+        std::string name;
+        ssize_t pos = 12;
+        while (pos < len && buffer[pos] != 0)
+        {
+            if (!name.empty()) name.push_back('.');
+            name.append((const char *)buffer + pos + 1, buffer[pos]);
+            pos += buffer[pos] + 1;
+        }
+        pos += 5;
+        if (pos > len) return;
+        int type = (buffer[pos - 4] << 8) | buffer[pos - 3];
+        queries++;
+        asked[name]++;
+
+        // the answer starts with the header and the question
+        std::string answer((const char *)buffer, pos);
+        answer[2] = (char)0x81;
+        answer[3] = (char)0x80;
+        answer[10] = answer[11] = 0;
+
+        // names in the zone get their records, and those of their aliases
+        if (zone.count(name))
+        {
+            int count = 0;
+            for (std::string current = name; zone.count(current); )
+            {
+                std::string alias;
+                for (auto &record : zone[current])
+                {
+                    if (record.first != type && record.first != 5) continue;
+                    unsigned char header[] = { 0, (unsigned char)record.first, 0, 1, 0, 0, 0x0e, 0x10, (unsigned char)(record.second.size() >> 8), (unsigned char)record.second.size() };
+                    answer.append(encode(current)).append((const char *)header, sizeof(header)).append(record.second);
+                    if (record.first == 5) alias = decode(record.second);
+                    count++;
+                }
+                if (alias.empty()) break;
+                current = alias;
+            }
+            answer[6] = 0; answer[7] = count; answer[8] = answer[9] = 0;
+            sendto(_fd, answer.data(), answer.size(), 0, (struct sockaddr *)&peer, size);
+            return;
+        }
+
+        // do we know the name?
+        auto iter = records.find(name);
+        if (failing.count(name))
+        {
+            answer[3] |= 2;
+            answer[6] = answer[7] = answer[8] = answer[9] = 0;
+        }
+        else if (iter == records.end() || type != 1)
+        {
+            if (iter == records.end()) answer[3] |= 3;
+            answer[6] = answer[7] = answer[8] = answer[9] = 0;
+            if (minimum >= 0)
+            {
+                answer[9] = 1;
+                uint32_t min = minimum;
+                unsigned char record[] = { 0xc0, 0x0c, 0, 6, 0, 1, 0, 0, 0x0e, 0x10, 0, 22, 0, 0, 0, 0, 0, 1, 0, 0, 0x0e, 0x10, 0, 0, 0x03, 0x84, 0, 0x09, 0x3a, 0x80, (unsigned char)(min >> 24), (unsigned char)(min >> 16), (unsigned char)(min >> 8), (unsigned char)min };
+                answer.append((const char *)record, sizeof(record));
+            }
+        }
+        else
+        {
+            answer[6] = 0; answer[7] = 1; answer[8] = answer[9] = 0;
+            uint32_t ttl = iter->second;
+            unsigned char record[] = { 0xc0, 0x0c, 0, 1, 0, 1, (unsigned char)(ttl >> 24), (unsigned char)(ttl >> 16), (unsigned char)(ttl >> 8), (unsigned char)ttl, 0, 4, 127, 0, 0, 1 };
+            answer.append((const char *)record, sizeof(record));
+        }
+
+        sendto(_fd, answer.data(), answer.size(), 0, (struct sockaddr *)&peer, size);
+    }
+
+public:
+    std::map<std::string, std::vector<std::pair<int, std::string>>> zone;
+    std::map<std::string, uint32_t> records;
+    std::set<std::string> failing;
+    int64_t minimum = -1;
+    int queries = 0;
+    std::map<std::string, int> asked;
+
+    Stub(React::Loop *loop) : _fd(socket(AF_INET, SOCK_DGRAM, 0))
+    {
+        struct sockaddr_in address;
+        memset(&address, 0, sizeof(address));
+        address.sin_family = AF_INET;
+        address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+        bind(_fd, (struct sockaddr *)&address, sizeof(address));
+        _reader = loop->onReadable(_fd, [this]() -> bool { process(); return true; });
+    }
+
+    ~Stub()
+    {
+        _reader->cancel();
+        close(_fd);
+    }
+
+    std::string address() const
+    {
+        struct sockaddr_in address;
+        socklen_t size = sizeof(address);
+        getsockname(_fd, (struct sockaddr *)&address, &size);
+        return "127.0.0.1:" + std::to_string(ntohs(address.sin_port));
+    }
+};
 
 /**
  *  This test will require a working network connection!
@@ -46,4 +205,498 @@ TEST(DNS, MXRequest)
     });
 
     loop.run();
-}
\ No newline at end of file
+}
+TEST(DNS, Cache)
+{
+    React::MainLoop loop;
+    // Timeout after 5 seconds
+    loop.onTimeout(5.0, [&loop]() {
+        loop.stop();
+        FAIL() << "Timeout";
+    });
+
+    Stub stub(&loop);
+    stub.records["cached.test"] = 300;
+    stub.records["uncached.test"] = 0;
+
+    React::Dns::Resolver resolver(&loop);
+    ASSERT_TRUE(resolver.servers(stub.address()));
+
+    int answers = 0;
+    auto check = [&](React::Dns::IpResult &&ips, const char *error) {
+        EXPECT_EQ(nullptr, error);
+        EXPECT_EQ(1u, ips.size());
+        // requests are freed after the callback, so we stop in the next iteration
+        if (++answers == 5) loop.onTimeout(0.0, [&loop]() { loop.stop(); });
+    };
+
+    // the first lookups are sent, the answer with a TTL is cached
+    resolver.ip("cached.test", 4, [&](React::Dns::IpResult &&ips, const char *error) {
+        check(std::move(ips), error);
+
+        // a hit is never reported right away
+        int before = answers;
+        resolver.ip("CACHED.test.", 4, check);
+        resolver.ip("cached.test", 4, check);
+        EXPECT_EQ(before, answers);
+
+        // a zero TTL is not cached
+        resolver.ip("uncached.test", 4, [&](React::Dns::IpResult &&ips, const char *error) {
+            check(std::move(ips), error);
+            resolver.ip("uncached.test", 4, check);
+        });
+    });
+
+    loop.run();
+
+    EXPECT_EQ(5, answers);
+    EXPECT_EQ(3, stub.queries);
+    EXPECT_EQ(2u, resolver.hits());
+    EXPECT_EQ(3u, resolver.misses());
+}
+
+TEST(DNS, NegativeCache)
+{
+    React::MainLoop loop;
+    // Timeout after 5 seconds
+    loop.onTimeout(5.0, [&loop]() {
+        loop.stop();
+        FAIL() << "Timeout";
+    });
+
+    Stub stub(&loop);
+    stub.records["known.test"] = 300;
+    stub.failing.insert("broken.test");
+
+    React::Dns::Resolver resolver(&loop);
+    ASSERT_TRUE(resolver.servers(stub.address()));
+
+    std::vector<std::string> errors;
+    auto check = [&](React::Dns::IpResult &&ips, const char *error) {
+        EXPECT_EQ(0u, ips.size());
+        errors.push_back(error ? error : "");
+    };
+
+    // a SOA minimum of zero means that the name is asked again
+    stub.minimum = 0;
+    resolver.ip("gone.test", 4, [&](React::Dns::IpResult &&ips, const char *error) {
+        check(std::move(ips), error);
+        resolver.ip("gone.test", 4, [&](React::Dns::IpResult &&ips, const char *error) {
+            check(std::move(ips), error);
+
+            // the SOA minimum is used for names that do not exist
+            stub.minimum = 300;
+            resolver.ip("missing.test", 4, [&](React::Dns::IpResult &&ips, const char *error) {
+                check(std::move(ips), error);
+                resolver.ip("missing.test", 4, check);
+
+                // the default is used without a SOA record
+                stub.minimum = -1;
+                resolver.ip("known.test", 6, [&](React::Dns::IpResult &&ips, const char *error) {
+                    check(std::move(ips), error);
+                    resolver.ip("known.test", 6, check);
+
+                    // server failures are remembered for the backoff period
+                    resolver.ip("broken.test", 4, [&](React::Dns::IpResult &&ips, const char *error) {
+                        check(std::move(ips), error);
+                        resolver.ip("broken.test", 4, [&](React::Dns::IpResult &&ips, const char *error) {
+                            check(std::move(ips), error);
+                            // requests are freed after the callback, so we stop in the next iteration
+                            loop.onTimeout(0.0, [&loop]() { loop.stop(); });
+                        });
+                    });
+                });
+            });
+        });
+    });
+
+    loop.run();
+
+    ASSERT_EQ(8u, errors.size());
+    EXPECT_EQ(errors[0], errors[1]);
+    EXPECT_EQ(errors[2], errors[3]);
+    EXPECT_EQ(errors[4], errors[5]);
+    EXPECT_EQ(errors[6], errors[7]);
+    EXPECT_NE(errors[2], errors[4]);
+    EXPECT_NE(errors[2], errors[6]);
+    EXPECT_EQ(2, stub.asked["gone.test"]);
+    EXPECT_EQ(1, stub.asked["missing.test"]);
+    EXPECT_EQ(1, stub.asked["known.test"]);
+    EXPECT_EQ(3u, resolver.hits());
+}
+
+TEST(DNS, Coalesce)
+{
+    React::MainLoop loop;
+    // Timeout after 5 seconds
+    loop.onTimeout(5.0, [&loop]() {
+        loop.stop();
+        FAIL() << "Timeout";
+    });
+
+    Stub stub(&loop);
+    stub.records["burst.test"] = 0;
+
+    React::Dns::Resolver resolver(&loop);
+    ASSERT_TRUE(resolver.servers(stub.address()));
+
+    // identical lookups share the query that is on its way
+    int answers = 0;
+    auto check = [&](React::Dns::IpResult &&ips, const char *error) {
+        EXPECT_EQ(nullptr, error);
+        EXPECT_EQ(1u, ips.size());
+        answers++;
+    };
+    for (int i = 0; i < 99; ++i) resolver.ip("burst.test", 4, check);
+
+    // a lookup after the answer sends a new query, because the TTL is zero
+    resolver.ip("Burst.Test.", 4, [&](React::Dns::IpResult &&ips, const char *error) {
+        check(std::move(ips), error);
+        EXPECT_EQ(100, answers);
+        resolver.ip("burst.test", 4, [&](React::Dns::IpResult &&ips, const char *error) {
+            check(std::move(ips), error);
+            // requests are freed after the callback, so we stop in the next iteration
+            loop.onTimeout(0.0, [&loop]() { loop.stop(); });
+        });
+    });
+
+    loop.run();
+
+    EXPECT_EQ(101, answers);
+    EXPECT_EQ(2, stub.asked["burst.test"]);
+}
+
+TEST(DNS, Prefetch)
+{
+    React::MainLoop loop;
+    // Timeout after 5 seconds
+    loop.onTimeout(5.0, [&loop]() {
+        loop.stop();
+        FAIL() << "Timeout";
+    });
+
+    Stub stub(&loop);
+    stub.records["hot.test"] = 2;
+    stub.records["cold.test"] = 2;
+
+    React::Dns::Resolver resolver(&loop);
+    ASSERT_TRUE(resolver.servers(stub.address()));
+
+    int answers = 0;
+    auto check = [&](React::Dns::IpResult &&ips, const char *error) {
+        EXPECT_EQ(nullptr, error);
+        EXPECT_EQ(1u, ips.size());
+        answers++;
+    };
+
+    // both names are cached, but only the first one is used often
+    resolver.ip("hot.test", 4, [&](React::Dns::IpResult &&ips, const char *error) {
+        check(std::move(ips), error);
+        for (int i = 0; i < 3; ++i) resolver.ip("hot.test", 4, check);
+    });
+    resolver.ip("cold.test", 4, check);
+
+    // in the last 10% of the ttl the hot answer is asked for again
+    loop.onTimeout(1.9, [&]() {
+        resolver.ip("hot.test", 4, check);
+        resolver.ip("cold.test", 4, check);
+    });
+
+    // after the ttl the hot answer is still in the cache, the cold one is not
+    loop.onTimeout(2.4, [&]() {
+        resolver.ip("hot.test", 4, check);
+        resolver.ip("cold.test", 4, check);
+        loop.onTimeout(0.1, [&loop]() { loop.stop(); });
+    });
+
+    loop.run();
+
+    EXPECT_EQ(9, answers);
+    EXPECT_EQ(2, stub.asked["hot.test"]);
+    EXPECT_EQ(2, stub.asked["cold.test"]);
+    EXPECT_EQ(1u, resolver.refreshes());
+    EXPECT_EQ(3u, resolver.misses());
+}
+
+TEST(DNS, SharedCache)
+{
+    React::MainLoop loop;
+    // Timeout after 5 seconds
+    loop.onTimeout(5.0, [&loop]() {
+        loop.stop();
+        FAIL() << "Timeout";
+    });
+
+    Stub stub(&loop);
+    for (int i = 0; i < 50; ++i) stub.records["known" + std::to_string(i) + ".test"] = 300;
+    for (int i = 0; i < 50; ++i) stub.records["new" + std::to_string(i) + ".test"] = 300;
+
+    auto shared = std::make_shared<React::Dns::SharedCache>(1000, 4);
+
+    React::Dns::Resolver resolver(&loop);
+    ASSERT_TRUE(resolver.servers(stub.address()));
+    resolver.share(shared);
+
+    // the threads look up names that are shared already, and names that
+    // they ask the stub for, which runs in the main loop
+    std::vector<std::thread> threads;
+    std::atomic<int> finished(0);
+    std::atomic<int> failures(0);
+    uint64_t hits[4] = { 0, 0, 0, 0 };
+    auto run = [&](int thread) {
+        React::Loop own;
+        React::Dns::Resolver resolver(&own);
+        resolver.servers(stub.address());
+        resolver.share(shared);
+
+        int answers = 0;
+        auto check = [&](React::Dns::IpResult &&ips, const char *error) {
+            if (error || ips.size() != 1) failures++;
+            if (++answers == 100) own.onTimeout(0.0, [&own]() { own.stop(); });
+        };
+        for (int i = 0; i < 50; ++i) resolver.ip("known" + std::to_string(i) + ".test", 4, check);
+        for (int i = 0; i < 50; ++i) resolver.ip("new" + std::to_string(i) + ".test", 4, check);
+
+        own.run();
+        hits[thread] = resolver.hits();
+        finished++;
+    };
+
+    int answers = 0;
+    for (int i = 0; i < 50; ++i) resolver.ip("known" + std::to_string(i) + ".test", 4, [&](React::Dns::IpResult &&ips, const char *error) {
+        EXPECT_EQ(nullptr, error);
+        if (++answers < 50) return;
+        for (int t = 0; t < 4; ++t) threads.emplace_back(run, t);
+    });
+
+    // the main loop serves the stub until the threads are done
+    loop.onInterval(0.01, [&]() -> bool {
+        if (finished < 4) return true;
+        loop.stop();
+        return false;
+    });
+
+    loop.run();
+    for (auto &thread : threads) thread.join();
+
+    EXPECT_EQ(4u, threads.size());
+    EXPECT_EQ(0, failures);
+    EXPECT_EQ(100u, shared->size());
+    for (int i = 0; i < 4; ++i) EXPECT_LE(50u, hits[i]);
+    for (int i = 0; i < 50; ++i) EXPECT_EQ(1, stub.asked["known" + std::to_string(i) + ".test"]);
+    for (int i = 0; i < 50; ++i) EXPECT_GE(4, stub.asked["new" + std::to_string(i) + ".test"]);
+}
+
+TEST(DNS, Bulk)
+{
+    React::MainLoop loop;
+    // Timeout after 5 seconds
+    loop.onTimeout(5.0, [&loop]() {
+        loop.stop();
+        FAIL() << "Timeout";
+    });
+
+    Stub stub(&loop);
+    std::vector<std::string> names;
+    for (int i = 0; i < 1000; ++i)
+    {
+        names.push_back("host" + std::to_string(i) + ".test");
+        if (i % 10 != 0) stub.records[names.back()] = 300;
+    }
+
+    React::Dns::Resolver resolver(&loop);
+    ASSERT_TRUE(resolver.servers(stub.address()));
+
+    // never more than the window is on its way
+    std::shared_ptr<React::Dns::Bulk> bulk;
+    std::set<std::string> answered;
+    size_t errors = 0;
+    bulk = resolver.bulk(names.begin(), names.end(), 4, [&](const std::string &name, React::Dns::IpResult &&ips, const char *error) {
+        EXPECT_LE(bulk->inflight(), 16u);
+        EXPECT_EQ(error ? 0u : 1u, ips.size());
+        answered.insert(name);
+        if (error) errors++;
+    }, 16);
+    EXPECT_EQ(16u, bulk->inflight());
+
+    bulk->onFinished([&loop]() {
+        // requests are freed after the callback, so we stop in the next iteration
+        loop.onTimeout(0.0, [&loop]() { loop.stop(); });
+    });
+
+    loop.run();
+
+    EXPECT_TRUE(bulk->finished());
+    EXPECT_EQ(1000u, answered.size());
+    EXPECT_EQ(1000u, bulk->completed());
+    EXPECT_EQ(100u, bulk->failed());
+    EXPECT_EQ(100u, errors);
+    EXPECT_EQ(1000, stub.queries);
+    EXPECT_GE(bulk->slowest(), bulk->latency());
+}
+
+TEST(DNS, Orphaned)
+{
+    React::MainLoop loop;
+    // Timeout after 5 seconds
+    loop.onTimeout(5.0, [&loop]() {
+        loop.stop();
+        FAIL() << "Timeout";
+    });
+
+    Stub stub(&loop);
+    stub.records["orphan.test"] = 300;
+
+    // the lookups are still answered when the resolver is gone
+    int answers = 0;
+    std::unique_ptr<React::Dns::Resolver> resolver(new React::Dns::Resolver(&loop));
+    ASSERT_TRUE(resolver->servers(stub.address()));
+    for (int i = 0; i < 2; ++i) resolver->ip("orphan.test", 4, [&](React::Dns::IpResult &&ips, const char *error) {
+        EXPECT_EQ(nullptr, error);
+        EXPECT_EQ(1u, ips.size());
+        if (++answers == 2) loop.onTimeout(0.0, [&loop]() { loop.stop(); });
+    });
+    resolver.reset();
+
+    loop.run();
+
+    EXPECT_EQ(2, answers);
+    EXPECT_EQ(1, stub.queries);
+}
+
+TEST(DNS, Parser)
+{
+    // an answer for example.test with one record of each type
+    std::string packet("\x00\x00\x81\x80\x00\x01\x00\x00\x00\x00\x00\x00", 12);
+    packet.append("\x07" "example" "\x04" "test" "\x00" "\x00\xff\x00\x01", 18);
+    auto add = [&packet](int type, int ttl, const std::string &data) {
+        unsigned char record[] = { 0xc0, 0x0c, 0, (unsigned char)type, 0, 1, 0, 0, (unsigned char)(ttl >> 8), (unsigned char)ttl, 0, (unsigned char)data.size() };
+        packet.append((const char *)record, sizeof(record)).append(data);
+        packet[7]++;
+    };
+    add(15, 300, std::string("\x00\x0a" "\x02" "mx" "\xc0\x0c", 7));
+    add(16, 60, std::string("\x05" "hello" "\x06" " world", 13));
+    add(12, 600, std::string("\x04" "host" "\xc0\x0c", 7));
+    add(33, 30, std::string("\x00\x01\x00\x05\x01\xbb" "\x03" "srv" "\xc0\x0c", 12));
+    // a pointer to itself is rejected
+    add(12, 600, std::string("\xc0", 1) + (char)(packet.size() + 12));
+    // records of other names are ignored
+    packet.append("\x05" "other" "\x00" "\x00\x10\x00\x01\x00\x00\x00\x3c\x00\x02\x01!", 19);
+    packet[7]++;
+
+    auto *buffer = (const unsigned char *)packet.data();
+    int size = packet.size();
+
+    React::Dns::MxResult mxs(buffer, size);
+    ASSERT_EQ(1u, mxs.size());
+    EXPECT_EQ("mx.example.test", mxs.begin()->hostname());
+    EXPECT_EQ(10, mxs.begin()->priority());
+    EXPECT_EQ(300, mxs.begin()->ttl());
+
+    React::Dns::TxtResult txts(buffer, size);
+    ASSERT_EQ(1u, txts.size());
+    EXPECT_EQ("hello world", txts[0].text());
+
+    React::Dns::PtrResult ptrs(buffer, size);
+    ASSERT_EQ(1u, ptrs.size());
+    EXPECT_EQ("host.example.test", ptrs[0].hostname());
+
+    React::Dns::SrvResult srvs(buffer, size);
+    ASSERT_EQ(1u, srvs.size());
+    EXPECT_EQ("srv.example.test", srvs[0].target());
+    EXPECT_EQ(1, srvs[0].priority());
+    EXPECT_EQ(5, srvs[0].weight());
+    EXPECT_EQ(443, srvs[0].port());
+    EXPECT_EQ(30, srvs[0].ttl());
+
+    // a truncated answer makes the parser invalid
+    React::Dns::Parser parser(buffer, size - 1);
+    int records = 0;
+    while (parser.next()) records++;
+    EXPECT_EQ(5, records);
+    EXPECT_FALSE(parser.valid());
+}
+
+TEST(DNS, NegativeTtl)
+{
+    // an answer with a record whose ttl has the highest bit set
+    std::string packet("\x00\x00\x81\x80\x00\x01\x00\x01\x00\x00\x00\x00", 12);
+    packet.append("\x07" "example" "\x04" "test" "\x00" "\x00\x10\x00\x01", 18);
+    packet.append("\xc0\x0c" "\x00\x10\x00\x01" "\x80\x00\x00\x3c" "\x00\x02\x01!", 14);
+
+    // the ttl is treated as zero
+    React::Dns::Parser parser((const unsigned char *)packet.data(), packet.size());
+    ASSERT_TRUE(parser.next());
+    EXPECT_EQ(0, parser.ttl());
+}
+
+TEST(DNS, RecordTypes)
+{
+    React::MainLoop loop;
+    // Timeout after 5 seconds
+    loop.onTimeout(5.0, [&loop]() {
+        loop.stop();
+        FAIL() << "Timeout";
+    });
+
+    Stub stub(&loop);
+    stub.zone["example.test"] = { { 16, std::string("\x07v=spf1 \x04-all", 13) }, { 15, std::string("\x00\x0a", 2) + Stub::encode("mx.example.test") } };
+    stub.zone["_dmarc.example.test"] = { { 5, Stub::encode("_dmarc.policy.test") } };
+    stub.zone["_dmarc.policy.test"] = { { 16, std::string("\x0dv=DMARC1; p=r", 14) } };
+    stub.zone["4.3.2.1.in-addr.arpa"] = { { 12, Stub::encode("host.example.test") } };
+    stub.zone["_submission._tcp.example.test"] = { { 33, std::string("\x00\x01\x00\x05\x02\x4b", 6) + Stub::encode("smtp.example.test") } };
+    stub.zone["_25._tcp.mx.example.test"] = { { 52, std::string("\x03\x01\x01\xab\xcd", 5) } };
+
+    React::Dns::Resolver resolver(&loop);
+    ASSERT_TRUE(resolver.servers(stub.address()));
+
+    // all lookups run on the same loop
+    int answers = 0;
+    auto done = [&]() { if (++answers == 6) loop.onTimeout(0.0, [&loop]() { loop.stop(); }); };
+
+    resolver.txt("example.test", [&](React::Dns::TxtResult &&txts, const char *error) {
+        EXPECT_EQ(nullptr, error);
+        ASSERT_EQ(1u, txts.size());
+        EXPECT_EQ("v=spf1 -all", txts[0].text());
+        done();
+    });
+    resolver.txt("_dmarc.example.test", [&](React::Dns::TxtResult &&txts, const char *error) {
+        EXPECT_EQ(nullptr, error);
+        ASSERT_EQ(1u, txts.size());
+        EXPECT_EQ("v=DMARC1; p=r", txts[0].text());
+        done();
+    });
+    resolver.mx("example.test", [&](React::Dns::MxResult &&mxs, const char *error) {
+        EXPECT_EQ(nullptr, error);
+        ASSERT_EQ(1u, mxs.size());
+        EXPECT_EQ("mx.example.test", mxs.begin()->hostname());
+        EXPECT_EQ(3600, mxs.begin()->ttl());
+        done();
+    });
+    resolver.ptr(React::Net::Ip("1.2.3.4"), [&](React::Dns::PtrResult &&ptrs, const char *error) {
+        EXPECT_EQ(nullptr, error);
+        ASSERT_EQ(1u, ptrs.size());
+        EXPECT_EQ("host.example.test", ptrs[0].hostname());
+        done();
+    });
+    resolver.srv("_submission._tcp.example.test", [&](React::Dns::SrvResult &&srvs, const char *error) {
+        EXPECT_EQ(nullptr, error);
+        ASSERT_EQ(1u, srvs.size());
+        EXPECT_EQ("smtp.example.test", srvs[0].target());
+        EXPECT_EQ(587, srvs[0].port());
+        done();
+    });
+    resolver.tlsa("_25._tcp.mx.example.test", [&](React::Dns::TlsaResult &&tlsas, const char *error) {
+        EXPECT_EQ(nullptr, error);
+        ASSERT_EQ(1u, tlsas.size());
+        EXPECT_EQ(3, tlsas[0].usage());
+        std::stringstream stream;
+        stream << tlsas[0];
+        EXPECT_EQ("3 1 1 abcd", stream.str());
+        done();
+    });
+
+    loop.run();
+
+    EXPECT_EQ(6, answers);
+}
@@ -0,0 +1,49 @@
+/**
+ *  Idle.cpp
+ *
+ *  Idle tracker related tests
+ *
+ *  @copyright 2014 Copernica BV
+ */
+
+#include <../reactcpp.h>
+#include <gtest/gtest.h>
+
+TEST(IdleTracker, Order)
+{
+    using React::Tcp::Connection;
+
+    int pair1[2], pair2[2];
+    ASSERT_EQ(socketpair(AF_UNIX, SOCK_STREAM, 0, pair1), 0);
+    ASSERT_EQ(socketpair(AF_UNIX, SOCK_STREAM, 0, pair2), 0);
+
+    React::MainLoop loop;
+    // Timeout after 5 seconds
+    loop.onTimeout(5.0, [&loop]() {
+        loop.stop();
+        FAIL() << "Timeout";
+    });
+
+    Connection a(&loop, pair1[0]), peera(&loop, pair1[1]);
+    Connection b(&loop, pair2[0]), peerb(&loop, pair2[1]);
+
+    std::vector<Connection *> expired;
+    React::Tcp::IdleTracker tracker(&loop, 0.2, [&](Connection *connection) {
+        expired.push_back(connection);
+        if (expired.size() == 2) loop.stop();
+    });
+
+    tracker.add(&a);
+    tracker.add(&b);
+    ASSERT_FALSE(tracker.empty());
+
+    // activity on the first connection moves it to the back
+    loop.onTimeout(0.1, [&a]() { a.send("x", 1); });
+
+    loop.run();
+
+    ASSERT_EQ(expired.size(), 2u);
+    EXPECT_EQ(expired[0], &b);
+    EXPECT_EQ(expired[1], &a);
+    EXPECT_TRUE(tracker.empty());
+}
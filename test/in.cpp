@@ -0,0 +1,241 @@
+/**
+ *  In.cpp
+ *
+ *  Tests for the input buffers
+ *
+ *  @copyright 2014 Copernica BV
+ */
+
+#include <../reactcpp.h>
+#include <gtest/gtest.h>
+
+TEST(In, PooledLines)
+{
+    using React::Tcp::Connection;
+
+    int pair[2];
+    ASSERT_EQ(socketpair(AF_UNIX, SOCK_STREAM, 0, pair), 0);
+
+    React::MainLoop loop;
+    // Timeout after 5 seconds
+    loop.onTimeout(5.0, [&loop]() {
+        loop.stop();
+        FAIL() << "Timeout";
+    });
+
+    Connection sender(&loop, pair[0]);
+    Connection receiver(&loop, pair[1]);
+
+    auto pool = std::make_shared<React::Tcp::ReceivePool>(4096, 16);
+    React::Tcp::PooledIn in(&receiver, pool);
+
+    std::vector<std::string> lines;
+    in.onLine([&](const void *buffer, size_t size) -> bool {
+        lines.emplace_back((const char *)buffer, size);
+        loop.stop();
+        return true;
+    });
+
+    // a partial line takes a block from the pool
+    sender.send("one\r\ntw", 7);
+    loop.run();
+    ASSERT_EQ(1u, lines.size());
+    EXPECT_EQ(1u, pool->used());
+
+    // and gives it back when the line is complete
+    sender.send("o\r\n", 3);
+    loop.run();
+    ASSERT_EQ(2u, lines.size());
+    EXPECT_EQ("one", lines[0]);
+    EXPECT_EQ("two", lines[1]);
+    EXPECT_EQ(0u, pool->used());
+    EXPECT_EQ(1u, pool->spare());
+
+    // incomplete lines that are longer than a block come in pieces
+    sender.send("0123456789abcdefXYZ", 19);
+    loop.run();
+    ASSERT_EQ(3u, lines.size());
+    sender.send("\r\n", 2);
+    loop.run();
+    ASSERT_EQ(4u, lines.size());
+    EXPECT_EQ("0123456789abcdef", lines[2]);
+    EXPECT_EQ("XYZ", lines[3]);
+}
+
+TEST(In, Budget)
+{
+    using React::Tcp::Connection;
+
+    int pair[2];
+    ASSERT_EQ(socketpair(AF_UNIX, SOCK_STREAM, 0, pair), 0);
+
+    React::MainLoop loop;
+    // Timeout after 5 seconds
+    loop.onTimeout(5.0, [&loop]() {
+        loop.stop();
+        FAIL() << "Timeout";
+    });
+
+    Connection sender(&loop, pair[0]);
+    Connection receiver(&loop, pair[1]);
+
+    React::Tcp::In<1000> in(&receiver);
+    in.budget(2500);
+
+    std::vector<size_t> sizes;
+    size_t total = 0;
+    in.onData([&](const void *buffer, size_t size) -> bool {
+        sizes.push_back(size);
+        if ((total += size) == 6000) loop.stop();
+        return true;
+    });
+
+    std::string data(6000, 'x');
+    ASSERT_EQ(6000, sender.send(data.data(), data.size()));
+
+    loop.run();
+
+    // the budget cuts every third buffer short
+    std::vector<size_t> expected = { 1000, 1000, 500, 1000, 1000, 500, 1000 };
+    EXPECT_EQ(expected, sizes);
+}
+
+TEST(In, Lines)
+{
+    using React::Tcp::Connection;
+
+    int pair[2];
+    ASSERT_EQ(socketpair(AF_UNIX, SOCK_STREAM, 0, pair), 0);
+
+    React::MainLoop loop;
+    // Timeout after 5 seconds
+    loop.onTimeout(5.0, [&loop]() {
+        loop.stop();
+        FAIL() << "Timeout";
+    });
+
+    Connection sender(&loop, pair[0]);
+    Connection receiver(&loop, pair[1]);
+
+    React::Tcp::In<8> in(&receiver);
+
+    std::vector<std::string> lines;
+    in.onLine([&](const void *buffer, size_t size) -> bool {
+        lines.emplace_back((const char *)buffer, size);
+        return true;
+    }, 32);
+
+    // mixed terminators, a carriage return at the edge of a read, and a
+    // line that is longer than the receive buffer
+    sender.send("one\r\ntwo\nthree\r", 15);
+    loop.onTimeout(0.05, [&loop]() { loop.stop(); });
+    loop.run();
+    sender.send("\nfour five six seven\r\n\n", 23);
+    loop.onTimeout(0.05, [&loop]() { loop.stop(); });
+    loop.run();
+
+    std::vector<std::string> expected = { "one", "two", "three", "four five six seven", "" };
+    EXPECT_EQ(expected, lines);
+}
+
+TEST(In, Frames)
+{
+    using React::Tcp::Connection;
+
+    int pair[2];
+    ASSERT_EQ(socketpair(AF_UNIX, SOCK_STREAM, 0, pair), 0);
+
+    React::MainLoop loop;
+    // Timeout after 5 seconds
+    loop.onTimeout(5.0, [&loop]() {
+        loop.stop();
+        FAIL() << "Timeout";
+    });
+
+    Connection sender(&loop, pair[0]);
+    Connection receiver(&loop, pair[1]);
+
+    // a small buffer, so that frames are split over reads
+    React::Tcp::In<8> in(&receiver);
+
+    std::vector<std::string> frames;
+    auto callback = [&](const void *buffer, size_t size) -> bool {
+        frames.emplace_back((const char *)buffer, size);
+        return true;
+    };
+    auto deliver = [&](const char *data, size_t size) {
+        sender.send(data, size);
+        loop.onTimeout(0.05, [&loop]() { loop.stop(); });
+        loop.run();
+    };
+
+    // length prefixed frames
+    in.onFrame(std::make_shared<React::Tcp::LengthFramer<uint16_t>>(), callback);
+    deliver("\0\3abc\0\0\0\14hello world!", 21);
+    ASSERT_EQ(3u, frames.size());
+    EXPECT_EQ("abc", frames[0]);
+    EXPECT_EQ("", frames[1]);
+    EXPECT_EQ("hello world!", frames[2]);
+
+    // frames that end with a delimiter, that is split over the sends
+    frames.clear();
+    in.onFrame(std::make_shared<React::Tcp::DelimiterFramer>("\r\n.\r\n"), callback);
+    deliver("line 1\r\nline 2\r\n.", 17);
+    EXPECT_EQ(0u, frames.size());
+    deliver("\r\nnext\r\n.\r\n", 11);
+    ASSERT_EQ(2u, frames.size());
+    EXPECT_EQ("line 1\r\nline 2", frames[0]);
+    EXPECT_EQ("next", frames[1]);
+
+    // fixed size records
+    frames.clear();
+    in.onFrame(std::make_shared<React::Tcp::FixedFramer>(5), callback);
+    deliver("aaaaabbbbbcc", 12);
+    deliver("ccc", 3);
+    std::vector<std::string> expected = { "aaaaa", "bbbbb", "ccccc" };
+    EXPECT_EQ(expected, frames);
+
+    // frames that are too large stop the reading
+    frames.clear();
+    auto framer = std::make_shared<React::Tcp::LengthFramer<uint32_t>>(16);
+    in.onFrame(framer, callback);
+    deliver("\0\0\1\0too large for the framer", 28);
+    EXPECT_TRUE(framer->overflow());
+    EXPECT_EQ(0u, frames.size());
+}
+
+TEST(In, OversizedPrefix)
+{
+    using React::Tcp::Connection;
+
+    int pair[2];
+    ASSERT_EQ(socketpair(AF_UNIX, SOCK_STREAM, 0, pair), 0);
+
+    React::MainLoop loop;
+    // Timeout after 5 seconds
+    loop.onTimeout(5.0, [&loop]() {
+        loop.stop();
+        FAIL() << "Timeout";
+    });
+
+    Connection sender(&loop, pair[0]);
+    Connection receiver(&loop, pair[1]);
+    React::Tcp::In<64> in(&receiver);
+
+    int frames = 0;
+    auto framer = std::make_shared<React::Tcp::LengthFramer<uint32_t>>();
+    in.onFrame(framer, [&](const void *buffer, size_t size) -> bool {
+        frames++;
+        return true;
+    });
+
+    // only the prefix is sent, the announced payload never arrives
+    sender.send("\xff\xff\xff\xff", 4);
+    loop.onTimeout(0.05, [&loop]() { loop.stop(); });
+    loop.run();
+
+    // the frame is rejected without buffering anything
+    EXPECT_TRUE(framer->overflow());
+    EXPECT_EQ(0u, framer->size());
+    EXPECT_EQ(0, frames);
+}
@@ -0,0 +1,57 @@
+/**
+ *  RateLimit.cpp
+ *
+ *  Rate limiter related tests
+ *
+ *  @copyright 2014 Copernica BV
+ */
+
+#include <../reactcpp.h>
+#include <gtest/gtest.h>
+
+TEST(RateLimiter, Throttle)
+{
+    using React::Tcp::Connection;
+
+    int pair[2];
+    ASSERT_EQ(socketpair(AF_UNIX, SOCK_STREAM, 0, pair), 0);
+
+    React::MainLoop loop;
+    // Timeout after 5 seconds
+    loop.onTimeout(5.0, [&loop]() {
+        loop.stop();
+        FAIL() << "Timeout";
+    });
+
+    Connection sender(&loop, pair[0]);
+    sender.track();
+    Connection receiver(&loop, pair[1]);
+
+    // 10000 bytes per second, with a burst of 1000 bytes
+    auto limiter = std::make_shared<React::Tcp::RateLimiter>(&loop, 10000, 1000);
+    ASSERT_EQ(limiter->available(), 1000u);
+
+    React::Tcp::Out out(&sender);
+    React::Tcp::In<> in(&receiver);
+    out.limit(limiter);
+
+    React::Timestamp started = loop.now();
+    size_t received = 0;
+
+    in.onData([&](const void *buffer, size_t size) -> bool {
+        received += size;
+        if (received >= 3000) loop.stop();
+        return true;
+    });
+
+    // everything is accepted, but only the burst is sent right away
+    std::string data(3000, 'x');
+    ASSERT_EQ(out.send(data.data(), data.size()), 3000u);
+    ASSERT_EQ(sender.statistics().bytesOut(), 1000u);
+
+    loop.run();
+
+    // the other 2000 bytes need at least two tenths of a second
+    EXPECT_EQ(received, 3000u);
+    EXPECT_GE(loop.now() - started, 0.19);
+}
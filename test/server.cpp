@@ -0,0 +1,312 @@
+/**
+ *  Server.cpp
+ *
+ *  Tcp server related tests
+ *
+ *  @copyright 2014 Copernica BV
+ */
+
+#include <../reactcpp.h>
+#include <gtest/gtest.h>
+
+TEST(Server, Inherit)
+{
+    using React::Tcp::Server;
+    using React::Tcp::Connection;
+    using React::Tcp::Inherited;
+
+    React::MainLoop loop;
+    // Timeout after 5 seconds
+    loop.onTimeout(5.0, [&loop]() {
+        loop.stop();
+        FAIL() << "Timeout";
+    });
+
+    // the "old" server exposes its socket
+    std::unique_ptr<Server> old(new Server(&loop, React::Net::Ip("127.0.0.1")));
+    unsetenv("REACT_TEST_LISTEN");
+    ASSERT_TRUE(old->expose("REACT_TEST_LISTEN"));
+    ASSERT_EQ(std::to_string(old->fd()), getenv("REACT_TEST_LISTEN"));
+
+    // not a listening socket
+    ASSERT_FALSE(Inherited(STDIN_FILENO).valid());
+    ASSERT_FALSE(Inherited("REACT_TEST_LISTEN", 1).valid());
+
+    // the environment variable refers to the listening socket, in this
+    // test we take a copy, because both servers live in the same process
+    Inherited inherited("REACT_TEST_LISTEN");
+    ASSERT_TRUE(inherited.valid());
+    Server server(&loop, Inherited(dup(inherited.fd())));
+    ASSERT_EQ(old->port(), server.port());
+
+    // a connection is set up before the old server is gone
+    Connection client(&loop, server.address());
+    old.reset();
+
+    std::shared_ptr<Connection> accepted;
+    server.onConnect([&]() -> bool {
+        accepted = std::make_shared<Connection>(server);
+        loop.stop();
+        return false;
+    });
+
+    loop.run();
+
+    ASSERT_TRUE(accepted != nullptr);
+    unsetenv("REACT_TEST_LISTEN");
+}
+
+TEST(Server, InheritBlocking)
+{
+    using React::Tcp::Server;
+    using React::Tcp::Inherited;
+
+    React::MainLoop loop;
+
+    // a socket that is not listening is refused, and not closed
+    EXPECT_THROW(Server(&loop, Inherited(STDIN_FILENO)), React::Exception);
+    EXPECT_NE(-1, fcntl(STDIN_FILENO, F_GETFD));
+
+    // supervisors usually pass a blocking socket
+    int fd = socket(AF_INET, SOCK_STREAM, 0);
+    struct sockaddr_in address;
+    memset(&address, 0, sizeof(address));
+    address.sin_family = AF_INET;
+    address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    ASSERT_EQ(0, bind(fd, (struct sockaddr *)&address, sizeof(address)));
+    ASSERT_EQ(0, listen(fd, 16));
+    ASSERT_EQ(0, fcntl(fd, F_GETFL) & O_NONBLOCK);
+
+    // the server makes it non-blocking, so that accepting never blocks the loop
+    Server server(&loop, Inherited(fd));
+    EXPECT_NE(0, fcntl(fd, F_GETFL) & O_NONBLOCK);
+    EXPECT_NE(0, fcntl(fd, F_GETFD) & FD_CLOEXEC);
+}
+
+TEST(Server, Statistics)
+{
+    using React::Tcp::Server;
+    using React::Tcp::Connection;
+
+    React::MainLoop loop;
+    // Timeout after 5 seconds
+    loop.onTimeout(5.0, [&loop]() {
+        loop.stop();
+        FAIL() << "Timeout";
+    });
+
+    Server server(&loop, React::Net::Ip("127.0.0.1"));
+    server.track();
+    Connection client(&loop, server.address());
+    client.track();
+    React::Tcp::Sampler sampler(&loop, 0.01);
+
+    std::shared_ptr<Connection> accepted;
+    server.onConnect([&]() -> bool {
+        accepted = std::make_shared<Connection>(server);
+        sampler.add(accepted.get());
+        accepted->onReadable([&]() -> bool {
+            char buffer[16];
+            accepted->recv(buffer, sizeof(buffer));
+            loop.onTimeout(0.05, [&loop]() { loop.stop(); });
+            return false;
+        });
+        return false;
+    });
+
+    client.onConnected([&](const char *error) {
+        EXPECT_EQ(error, nullptr);
+        client.send("hello", 5);
+    });
+
+    loop.run();
+
+    ASSERT_TRUE(accepted != nullptr);
+    EXPECT_EQ(5u, client.statistics().bytesOut());
+    EXPECT_EQ(1u, client.statistics().sendCalls());
+    EXPECT_EQ(5u, accepted->statistics().bytesIn());
+    EXPECT_GT(accepted->statistics().cwnd(), 0u);
+    EXPECT_EQ(1u, server.connections());
+
+    // statistics remain available after the connection is gone
+    accepted.reset();
+    EXPECT_EQ(0u, server.connections());
+    EXPECT_EQ(5u, server.statistics().bytesIn());
+}
+
+TEST(Server, Untracked)
+{
+    using React::Tcp::Server;
+    using React::Tcp::Connection;
+
+    React::MainLoop loop;
+    // Timeout after 5 seconds
+    loop.onTimeout(5.0, [&loop]() {
+        loop.stop();
+        FAIL() << "Timeout";
+    });
+
+    Server server(&loop, React::Net::Ip("127.0.0.1"));
+    Connection client(&loop, server.address());
+
+    std::unique_ptr<Connection> accepted;
+    server.onConnect([&]() -> bool {
+        accepted.reset(new Connection(server));
+        accepted->onReadable([&]() -> bool {
+            char buffer[16];
+            accepted->recv(buffer, sizeof(buffer));
+            loop.stop();
+            return false;
+        });
+        return false;
+    });
+
+    client.onConnected([&](const char *error) {
+        EXPECT_EQ(error, nullptr);
+        client.send("hello", 5);
+    });
+
+    loop.run();
+
+    // without tracking nothing is counted or registered
+    ASSERT_TRUE(accepted != nullptr);
+    EXPECT_EQ(0u, accepted->statistics().bytesIn());
+    EXPECT_EQ(0u, client.statistics().bytesOut());
+    EXPECT_EQ(0u, server.connections());
+
+    // the server does not know what to drain
+    bool drained = false;
+    EXPECT_FALSE(server.drain(1.0, [&]() { drained = true; }));
+    EXPECT_FALSE(drained);
+}
+
+TEST(Server, Drain)
+{
+    using React::Tcp::Server;
+    using React::Tcp::Connection;
+
+    React::MainLoop loop;
+    // Timeout after 5 seconds
+    loop.onTimeout(5.0, [&loop]() {
+        loop.stop();
+        FAIL() << "Timeout";
+    });
+
+    Server server(&loop, React::Net::Ip("127.0.0.1"));
+    server.track();
+    Connection client1(&loop, server.address());
+    Connection client2(&loop, server.address());
+
+    std::vector<std::unique_ptr<Connection>> accepted;
+    server.onConnect([&]() -> bool {
+        accepted.emplace_back(new Connection(server));
+        if (accepted.size() == 2) loop.stop();
+        return true;
+    });
+
+    loop.run();
+    ASSERT_EQ(2u, server.connections());
+
+    // the server side destructs a connection when the peer has closed it
+    for (auto &connection : accepted)
+    {
+        Connection *pointer = connection.get();
+        pointer->onReadable([&accepted, pointer]() -> bool {
+            char buffer[16];
+            if (pointer->recv(buffer, sizeof(buffer)) != 0) return true;
+            for (auto &connection : accepted) if (connection.get() == pointer) connection.reset();
+            return false;
+        });
+    }
+
+    // the first connection is busy, and finishes its work when asked
+    accepted[0]->onDrain([&accepted]() {
+        accepted[0]->send("bye", 3);
+        accepted[0]->shutdown();
+    });
+
+    // the clients close their side when they see the end of the data
+    std::string received;
+    auto reader = [&received](Connection *client) {
+        client->onReadable([&received, client]() -> bool {
+            char buffer[16];
+            ssize_t bytes = client->recv(buffer, sizeof(buffer));
+            if (bytes > 0) received.append(buffer, bytes);
+            if (bytes != 0) return true;
+            client->close();
+            return false;
+        });
+    };
+    reader(&client1);
+    reader(&client2);
+
+    bool drained = false;
+    React::Timestamp started = loop.now();
+    ASSERT_TRUE(server.drain(1.0, [&]() {
+        drained = true;
+        loop.stop();
+    }));
+
+    loop.run();
+
+    EXPECT_TRUE(drained);
+    EXPECT_LT(loop.now() - started, 1.0);
+    EXPECT_EQ("bye", received);
+    EXPECT_EQ(0u, server.connections());
+}
+
+TEST(Server, DrainDeadline)
+{
+    using React::Tcp::Server;
+    using React::Tcp::Connection;
+
+    React::MainLoop loop;
+    // Timeout after 5 seconds
+    loop.onTimeout(5.0, [&loop]() {
+        loop.stop();
+        FAIL() << "Timeout";
+    });
+
+    Server server(&loop, React::Net::Ip("127.0.0.1"));
+    server.track();
+    Connection client1(&loop, server.address());
+    Connection client2(&loop, server.address());
+
+    std::vector<std::unique_ptr<Connection>> accepted;
+    server.onConnect([&]() -> bool {
+        accepted.emplace_back(new Connection(server));
+        if (accepted.size() == 2) loop.stop();
+        return true;
+    });
+
+    loop.run();
+    ASSERT_EQ(2u, accepted.size());
+
+    // the owners destruct the connections when they are aborted
+    int lost = 0;
+    for (auto &connection : accepted)
+    {
+        auto *pointer = &connection;
+        connection->onLost([&lost, pointer]() {
+            lost++;
+            pointer->reset();
+        });
+    }
+
+    // the peers never close, so the connections are aborted at the deadline
+    bool drained = false;
+    React::Timestamp started = loop.now();
+    ASSERT_TRUE(server.drain(0.1, [&]() {
+        drained = true;
+        loop.stop();
+    }));
+
+    loop.run();
+
+    EXPECT_TRUE(drained);
+    EXPECT_GE(loop.now() - started, 0.09);
+    EXPECT_EQ(2, lost);
+    EXPECT_EQ(nullptr, accepted[0]);
+    EXPECT_EQ(nullptr, accepted[1]);
+    EXPECT_EQ(0u, server.connections());
+}
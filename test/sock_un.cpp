@@ -65,3 +65,89 @@ TEST(UnixDomainSocket, ClientTest)
     ASSERT_STREQ(SERVER_TX_MSG, client_rx_msg);
 }
 
+
+TEST(UnixDomainSocket, PassFiledescriptors)
+{
+    using React::Tcp::Connection;
+
+    int pair[2];
+    ASSERT_EQ(socketpair(AF_UNIX, SOCK_STREAM, 0, pair), 0);
+
+    int fds[2];
+    ASSERT_EQ(pipe(fds), 0);
+
+    React::MainLoop loop;
+    Connection sender(&loop, pair[0]);
+    Connection receiver(&loop, pair[1]);
+
+    // pass both ends of the pipe in a single message
+    ASSERT_EQ(sender.send("x", 1, fds, 2), 1);
+
+    char buffer[8];
+    int received[4];
+    size_t count = 4;
+    bool truncated = true;
+    ASSERT_EQ(receiver.recv(buffer, sizeof(buffer), received, count, truncated), 1);
+    ASSERT_EQ(count, 2u);
+    ASSERT_FALSE(truncated);
+    ASSERT_EQ(buffer[0], 'x');
+
+    // the received filedescriptors refer to the same pipe
+    ASSERT_EQ(write(received[1], "pipe", 4), 4);
+    ASSERT_EQ(read(fds[0], buffer, sizeof(buffer)), 4);
+    ASSERT_EQ(std::string(buffer, 4), "pipe");
+
+    close(fds[0]);
+    close(fds[1]);
+    close(received[0]);
+    close(received[1]);
+}
+
+TEST(UnixDomainSocket, TruncatedFiledescriptors)
+{
+    using React::Tcp::Connection;
+
+    int pair[2];
+    ASSERT_EQ(socketpair(AF_UNIX, SOCK_STREAM, 0, pair), 0);
+
+    // the credentials take up room in the ancillary data of the receiver
+    int on = 1;
+    ASSERT_EQ(setsockopt(pair[1], SOL_SOCKET, SO_PASSCRED, &on, sizeof(on)), 0);
+
+    int fds[2];
+    ASSERT_EQ(pipe(fds), 0);
+
+    React::MainLoop loop;
+    Connection sender(&loop, pair[0]);
+    Connection receiver(&loop, pair[1]);
+
+    // pass the max number of filedescriptors (SCM_MAX_FD), they no longer fit
+    std::vector<int> passed(253, fds[0]);
+    ASSERT_EQ(sender.send("hello", 5, passed.data(), passed.size()), 5);
+    ASSERT_EQ(sender.send("world", 5), 5);
+
+    // the number of the next filedescriptor, to check that nothing leaks
+    int next = dup(fds[0]);
+    close(next);
+
+    // the data survives, but the filedescriptors are lost
+    char buffer[8];
+    std::vector<int> received(passed.size());
+    size_t count = received.size();
+    bool truncated = false;
+    ASSERT_EQ(receiver.recv(buffer, sizeof(buffer), received.data(), count, truncated), 5);
+    ASSERT_EQ(std::string(buffer, 5), "hello");
+    ASSERT_TRUE(truncated);
+    ASSERT_EQ(count, 0u);
+
+    // the stream is still in sync
+    ASSERT_EQ(receiver.recv(buffer, sizeof(buffer)), 5);
+    ASSERT_EQ(std::string(buffer, 5), "world");
+
+    int check = dup(fds[0]);
+    EXPECT_EQ(check, next);
+    close(check);
+
+    close(fds[0]);
+    close(fds[1]);
+}
@@ -0,0 +1,338 @@
+/**
+ *  Tls.cpp
+ *
+ *  Tests for the TLS layer
+ *
+ *  @copyright 2014 Copernica BV
+ */
+
+#include <../reactcpp.h>
+#include <reactcpp/tcp/tlscontext.h>
+#include <reactcpp/tcp/tls.h>
+#include <openssl/x509.h>
+#include <gtest/gtest.h>
+
+/**
+ *  Helper class with a self-signed certificate for "localhost", and
+ *  contexts for a server that uses it and a client that trusts it
+ */
+class Certificate
+{
+public:
+    EVP_PKEY *key = EVP_EC_gen("P-256");
+    X509 *certificate = X509_new();
+    std::shared_ptr<React::Tcp::TlsContext> server = std::make_shared<React::Tcp::TlsContext>(true);
+    std::shared_ptr<React::Tcp::TlsContext> client = std::make_shared<React::Tcp::TlsContext>(false);
+
+    Certificate()
+    {
+        // fill in the certificate, and sign it
+        ASN1_INTEGER_set(X509_get_serialNumber(certificate), 1);
+        X509_gmtime_adj(X509_getm_notBefore(certificate), 0);
+        X509_gmtime_adj(X509_getm_notAfter(certificate), 3600);
+        X509_set_pubkey(certificate, key);
+        X509_NAME_add_entry_by_txt(X509_get_subject_name(certificate), "CN", MBSTRING_ASC, (const unsigned char *)"localhost", -1, -1, 0);
+        X509_set_issuer_name(certificate, X509_get_subject_name(certificate));
+        X509_sign(certificate, key, EVP_sha256());
+
+        // install it
+        SSL_CTX_use_certificate(server->handle(), certificate);
+        SSL_CTX_use_PrivateKey(server->handle(), key);
+        X509_STORE_add_cert(SSL_CTX_get_cert_store(client->handle()), certificate);
+    }
+
+    ~Certificate()
+    {
+        X509_free(certificate);
+        EVP_PKEY_free(key);
+    }
+};
+
+TEST(Tls, RoundTrip)
+{
+    using React::Tcp::Connection;
+    using React::Tcp::Tls;
+
+    Certificate certificate;
+
+    React::MainLoop loop;
+    // Timeout after 5 seconds
+    loop.onTimeout(5.0, [&loop]() {
+        loop.stop();
+        FAIL() << "Timeout";
+    });
+
+    // the second connection resumes the session of the first
+    for (int round = 0; round < 2; ++round)
+    {
+        int pair[2];
+        ASSERT_EQ(socketpair(AF_UNIX, SOCK_STREAM, 0, pair), 0);
+
+        Connection server(&loop, pair[0]);
+        Connection client(&loop, pair[1]);
+
+        int secured = 0;
+        auto check = [&secured](const char *error) { EXPECT_EQ(nullptr, error); secured++; };
+
+        Tls serverTls(&server, certificate.server, check);
+        Tls clientTls(&client, certificate.client, check, "localhost");
+
+        // handlers that are installed during the handshake wait for it
+        React::Tcp::Out serverOut(&server);
+        React::Tcp::In<> clientIn(&client);
+
+        std::string received;
+        clientIn.onData([&received](const void *buffer, size_t size) -> bool {
+            received.append((const char *)buffer, size);
+            return true;
+        });
+        clientIn.onLost([&loop]() { loop.stop(); });
+
+        // small blocks are combined, large blocks span multiple records
+        std::string data;
+        for (int i = 0; i < 1000; ++i)
+        {
+            std::string number = std::to_string(i);
+            serverOut.send(number.data(), number.size());
+            data.append(number);
+        }
+        std::string large(100000, 'x');
+        serverOut.send(large.data(), large.size());
+        serverOut.close();
+
+        loop.run();
+
+        EXPECT_EQ(2, secured);
+        EXPECT_EQ(data + large, received);
+        EXPECT_EQ(round == 1, clientTls.resumed());
+        EXPECT_EQ(1u, certificate.client->sessions());
+        EXPECT_STREQ("TLSv1.3", clientTls.protocol());
+    }
+}
+
+TEST(Tls, StartTls)
+{
+    using React::Tcp::Connection;
+    using React::Tcp::Tls;
+
+    Certificate certificate;
+
+    React::MainLoop loop;
+    // Timeout after 5 seconds
+    loop.onTimeout(5.0, [&loop]() {
+        loop.stop();
+        FAIL() << "Timeout";
+    });
+
+    int pair[2];
+    ASSERT_EQ(socketpair(AF_UNIX, SOCK_STREAM, 0, pair), 0);
+
+    Connection server(&loop, pair[0]);
+    Connection client(&loop, pair[1]);
+
+    React::Tcp::Out serverOut(&server);
+    React::Tcp::Out clientOut(&client);
+    React::Tcp::In<> serverIn(&server);
+    React::Tcp::In<> clientIn(&client);
+
+    std::unique_ptr<Tls> serverTls;
+    std::unique_ptr<Tls> clientTls;
+
+    std::vector<std::string> lines;
+
+    // the server answers in plain text, and then upgrades the connection
+    React::Tcp::DataCallback command = [&](const void *buffer, size_t size) -> bool {
+        lines.emplace_back((const char *)buffer, size);
+        if (serverTls) { serverOut.close(); return false; }
+        serverOut.send("220 Ready to start TLS\r\n", 24);
+        serverTls.reset(new Tls(&server, certificate.server, [&](const char *error) {
+            EXPECT_EQ(nullptr, error);
+            serverIn.onLine(command);
+        }));
+        return false;
+    };
+    serverIn.onLine(command);
+    clientOut.send("STARTTLS\r\n", 10);
+
+    // the client upgrades after the answer, and sends the next command securely
+    clientIn.onLine([&](const void *buffer, size_t size) -> bool {
+        lines.emplace_back((const char *)buffer, size);
+        clientTls.reset(new Tls(&client, certificate.client, [&](const char *error) {
+            EXPECT_EQ(nullptr, error);
+            clientOut.send("EHLO localhost\r\n", 16);
+            clientIn.onData([](const void *buffer, size_t size) -> bool { return true; });
+            clientIn.onLost([&loop]() { loop.stop(); });
+        }, "localhost"));
+        return false;
+    });
+
+    loop.run();
+
+    ASSERT_EQ(3u, lines.size());
+    EXPECT_EQ("STARTTLS", lines[0]);
+    EXPECT_EQ("220 Ready to start TLS", lines[1]);
+    EXPECT_EQ("EHLO localhost", lines[2]);
+}
+
+TEST(Tls, Untrusted)
+{
+    using React::Tcp::Connection;
+    using React::Tcp::Tls;
+
+    Certificate certificate;
+
+    React::MainLoop loop;
+    // Timeout after 5 seconds
+    loop.onTimeout(5.0, [&loop]() {
+        loop.stop();
+        FAIL() << "Timeout";
+    });
+
+    int pair[2];
+    ASSERT_EQ(socketpair(AF_UNIX, SOCK_STREAM, 0, pair), 0);
+
+    Connection server(&loop, pair[0]);
+    Connection client(&loop, pair[1]);
+
+    // the certificate is not valid for this name
+    std::string error;
+    Tls serverTls(&server, certificate.server, nullptr);
+    Tls clientTls(&client, certificate.client, [&](const char *message) {
+        error = message ? message : "";
+        loop.stop();
+    }, "example.com");
+
+    loop.run();
+
+    EXPECT_EQ("certificate verify failed", error);
+    EXPECT_FALSE(clientTls.secured());
+}
+
+TEST(Tls, SessionEviction)
+{
+    using React::Tcp::Connection;
+    using React::Tcp::Tls;
+
+    Certificate certificate;
+    certificate.client->verify(false);
+    certificate.client->capacity(2);
+
+    React::MainLoop loop;
+    // Timeout after 5 seconds
+    loop.onTimeout(5.0, [&loop]() {
+        loop.stop();
+        FAIL() << "Timeout";
+    });
+
+    // connect to a server name, and wait until the session arrives
+    auto connect = [&](const char *name) {
+        int pair[2];
+        ASSERT_EQ(socketpair(AF_UNIX, SOCK_STREAM, 0, pair), 0);
+
+        Connection server(&loop, pair[0]);
+        Connection client(&loop, pair[1]);
+
+        Tls serverTls(&server, certificate.server, nullptr);
+        Tls clientTls(&client, certificate.client, nullptr, name);
+
+        React::Tcp::Out serverOut(&server);
+        React::Tcp::In<> clientIn(&client);
+        clientIn.onData([](const void *buffer, size_t size) -> bool { return true; });
+        clientIn.onLost([&loop]() { loop.stop(); });
+
+        serverOut.send("x", 1);
+        serverOut.close();
+
+        loop.run();
+    };
+
+    connect("a.test");
+    connect("b.test");
+    ASSERT_EQ(2u, certificate.client->sessions());
+
+    // using the session of a makes b the least recently used one
+    ASSERT_NE(nullptr, certificate.client->session("a.test"));
+    connect("c.test");
+
+    EXPECT_EQ(2u, certificate.client->sessions());
+    EXPECT_NE(nullptr, certificate.client->session("a.test"));
+    EXPECT_EQ(nullptr, certificate.client->session("b.test"));
+    EXPECT_NE(nullptr, certificate.client->session("c.test"));
+}
+
+TEST(Tls, ReadWantsWrite)
+{
+    using React::Tcp::Connection;
+    using React::Tcp::Tls;
+
+    // the contexts normally refuse renegotiation, but it is the easiest way
+    // to make the server write while it reads, and it needs tls 1.2
+    Certificate certificate;
+    SSL_CTX_set_max_proto_version(certificate.server->handle(), TLS1_2_VERSION);
+    SSL_CTX_clear_options(certificate.server->handle(), SSL_OP_NO_RENEGOTIATION);
+    SSL_CTX_clear_options(certificate.client->handle(), SSL_OP_NO_RENEGOTIATION);
+    SSL_CTX_set_options(certificate.server->handle(), SSL_OP_ALLOW_CLIENT_RENEGOTIATION);
+
+    React::MainLoop loop;
+    // Timeout after 5 seconds
+    loop.onTimeout(5.0, [&loop]() {
+        loop.stop();
+        FAIL() << "Timeout";
+    });
+
+    int pair[2];
+    ASSERT_EQ(socketpair(AF_UNIX, SOCK_STREAM, 0, pair), 0);
+
+    Connection server(&loop, pair[0]);
+    Connection client(&loop, pair[1]);
+
+    // both sides have to be done with the first handshake
+    int secured = 0;
+    auto check = [&](const char *error) { if (++secured == 2) loop.stop(); };
+
+    Tls serverTls(&server, certificate.server, check);
+    Tls clientTls(&client, certificate.client, check, "localhost");
+
+    loop.run();
+    ASSERT_TRUE(serverTls.secured());
+    ASSERT_TRUE(clientTls.secured());
+
+    // the client asks for a new handshake, which the server answers while
+    // it reads
+    ASSERT_EQ(1, SSL_renegotiate(clientTls.handle()));
+    SSL_do_handshake(clientTls.handle());
+
+    // the server sends data that the client does not read yet, and shrinks
+    // its buffer so that there is no room left for the answer
+    char chunk[4096] = {};
+    for (int i = 0; i < 16; ++i) ASSERT_EQ((ssize_t)sizeof(chunk), serverTls.send(chunk, sizeof(chunk)));
+    int size = 1;
+    ASSERT_EQ(0, setsockopt(pair[0], SOL_SOCKET, SO_SNDBUF, &size, sizeof(size)));
+
+    React::Tcp::Out clientOut(&client);
+    React::Tcp::In<> serverIn(&server);
+    React::Tcp::In<> clientIn(&client);
+
+    std::string received;
+    serverIn.onData([&](const void *buffer, size_t size) -> bool {
+        received.append((const char *)buffer, size);
+        if (received == "ping") loop.stop();
+        return true;
+    });
+
+    // the client starts reading later
+    loop.onTimeout(0.1, [&]() {
+        clientIn.onData([](const void *buffer, size_t size) -> bool { return true; });
+    });
+
+    // and sends data once the new handshake is over
+    loop.onInterval(0.01, [&]() -> bool {
+        if (!SSL_is_init_finished(clientTls.handle())) return true;
+        clientOut.send("ping", 4);
+        return false;
+    });
+
+    loop.run();
+
+    EXPECT_EQ("ping", received);
+}
@@ -0,0 +1,167 @@
+/**
+ *  Udp.cpp
+ *
+ *  UDP socket related tests
+ *
+ *  @copyright 2014 Copernica BV
+ */
+
+#include <../reactcpp.h>
+#include <gtest/gtest.h>
+
+TEST(Udp, Batch)
+{
+    React::MainLoop loop;
+    // Timeout after 5 seconds
+    loop.onTimeout(5.0, [&loop]() {
+        loop.stop();
+        FAIL() << "Timeout";
+    });
+
+    React::Udp::Socket server(&loop, React::Net::Ip("127.0.0.1"));
+    React::Udp::Socket client(&loop, React::Net::Ip("127.0.0.1"));
+
+    std::vector<std::string> received;
+
+    server.onDatagrams([&](const React::Udp::Datagrams &datagrams) -> bool {
+        for (auto &datagram : datagrams)
+        {
+            received.emplace_back(datagram.data(), datagram.size());
+            EXPECT_EQ(client.address().port(), datagram.address().port());
+        }
+        if (received.size() >= 3) loop.stop();
+        return true;
+    });
+
+    ASSERT_TRUE(client.queue(server.address(), "one", 3));
+    ASSERT_TRUE(client.queue(server.address(), "two", 3));
+    ASSERT_TRUE(client.queue(server.address(), "three", 5));
+    ASSERT_EQ(3u, client.pending());
+    ASSERT_EQ(3u, client.flush());
+    ASSERT_EQ(0u, client.pending());
+
+    loop.run();
+
+    ASSERT_EQ(3u, received.size());
+    EXPECT_EQ("one", received[0]);
+    EXPECT_EQ("two", received[1]);
+    EXPECT_EQ("three", received[2]);
+}
+
+TEST(Udp, Connected)
+{
+    React::MainLoop loop;
+    // Timeout after 5 seconds
+    loop.onTimeout(5.0, [&loop]() {
+        loop.stop();
+        FAIL() << "Timeout";
+    });
+
+    React::Udp::Socket server(&loop, React::Net::Ip("127.0.0.1"));
+    React::Udp::Socket client(&loop, React::Net::Ip("127.0.0.1"));
+
+    ASSERT_TRUE(client.connect(server.address()));
+
+    std::string received;
+
+    server.onDatagrams([&](const React::Udp::Datagrams &datagrams) -> bool {
+        for (auto &datagram : datagrams) received.append(datagram.data(), datagram.size());
+        loop.stop();
+        return false;
+    });
+
+    ASSERT_EQ(5, client.send("hello", 5));
+
+    loop.run();
+
+    EXPECT_EQ("hello", received);
+}
+
+TEST(Udp, Segmentation)
+{
+    React::MainLoop loop;
+    // Timeout after 5 seconds
+    loop.onTimeout(5.0, [&loop]() {
+        loop.stop();
+        FAIL() << "Timeout";
+    });
+
+    // the receiver needs slots that can hold coalesced datagrams
+    React::Udp::Socket server(&loop, React::Net::Ip("127.0.0.1"), 0, 8, 65535);
+    React::Udp::Socket client(&loop, React::Net::Ip("127.0.0.1"));
+
+    // the kernel may not support the offloads
+    if (!client.segment(100) || !server.coalesce()) GTEST_SKIP() << "UDP GSO or GRO is not supported";
+
+    std::vector<std::string> received;
+
+    server.onDatagrams([&](const React::Udp::Datagrams &datagrams) -> bool {
+        for (auto &datagram : datagrams) received.emplace_back(datagram.data(), datagram.size());
+        if (received.size() >= 4) loop.stop();
+        return true;
+    });
+
+    // a single buffer is split into datagrams of 100 bytes
+    std::string data(100, 'a');
+    data.append(100, 'b').append(100, 'c').append(50, 'd');
+    ASSERT_EQ(350, client.send(server.address(), data.data(), data.size()));
+
+    loop.run();
+
+    ASSERT_EQ(4u, received.size());
+    EXPECT_EQ(std::string(100, 'a'), received[0]);
+    EXPECT_EQ(std::string(100, 'b'), received[1]);
+    EXPECT_EQ(std::string(100, 'c'), received[2]);
+    EXPECT_EQ(std::string(50, 'd'), received[3]);
+}
+
+TEST(Udp, Truncated)
+{
+    React::MainLoop loop;
+    // Timeout after 5 seconds
+    loop.onTimeout(5.0, [&loop]() {
+        loop.stop();
+        FAIL() << "Timeout";
+    });
+
+    // slots of 16 bytes are too small for coalesced datagrams
+    React::Udp::Socket server(&loop, React::Net::Ip("127.0.0.1"), 0, 8, 16);
+    React::Udp::Socket client(&loop, React::Net::Ip("127.0.0.1"));
+    EXPECT_FALSE(server.coalesce());
+
+    std::vector<std::pair<std::string, bool>> received;
+
+    server.onDatagrams([&](const React::Udp::Datagrams &datagrams) -> bool {
+        for (auto &datagram : datagrams) received.emplace_back(std::string(datagram.data(), datagram.size()), datagram.truncated());
+        if (received.size() >= 2) loop.stop();
+        return true;
+    });
+
+    // the first datagram does not fit in a slot
+    std::string large(40, 'x');
+    ASSERT_TRUE(client.queue(server.address(), large.data(), large.size()));
+    ASSERT_TRUE(client.queue(server.address(), "small", 5));
+    ASSERT_EQ(2u, client.flush());
+
+    loop.run();
+
+    ASSERT_EQ(2u, received.size());
+    EXPECT_EQ(std::string(16, 'x'), received[0].first);
+    EXPECT_TRUE(received[0].second);
+    EXPECT_EQ("small", received[1].first);
+    EXPECT_FALSE(received[1].second);
+}
+
+TEST(Udp, BindFailure)
+{
+    React::MainLoop loop;
+
+    // binding to a port that is in use fails, without leaking the socket
+    React::Udp::Socket first(&loop, React::Net::Ip("127.0.0.1"));
+    int before = dup(0);
+    close(before);
+    EXPECT_THROW(React::Udp::Socket(&loop, React::Net::Ip("127.0.0.1"), first.address().port()), React::Exception);
+    int after = dup(0);
+    close(after);
+    EXPECT_EQ(before, after);
+}
@@ -0,0 +1,113 @@
+/**
+ *  Bulk.cpp
+ *
+ *  Benchmark for bulk lookups with the resolver. Without arguments it runs
+ *  against a minimal name server in a separate thread, that answers every
+ *  A query with 127.0.0.1. Pass the number of names, the window and the
+ *  address of a name server to run it against a real server.
+ *
+ *      bulk [count] [window] [server]
+ *
+ *  @copyright 2014 Copernica BV
+ */
+#include <reactcpp.h>
+#include <iostream>
+#include <thread>
+
+/**
+ *  Answer all queries that arrive on a socket
+ *  @param  fd          The socket
+ */
+static void serve(int fd)
+{
+    // buffer for the queries
+    unsigned char buffer[512];
+
+    // the address of the peer
+    struct sockaddr_in peer;
+    socklen_t size = sizeof(peer);
+
+    // process queries until the socket is closed
+    ssize_t len;
+    while ((len = recvfrom(fd, buffer, sizeof(buffer) - 16, 0, (struct sockaddr *)&peer, &size)) >= 0)
+    {
+        // skip queries that have no question
+        if (len < 17) continue;
+
+        // turn the query into an answer with one record
+        buffer[2] = 0x81; buffer[3] = 0x80;
+        buffer[6] = 0; buffer[7] = 1;
+        buffer[8] = buffer[9] = buffer[10] = buffer[11] = 0;
+
+        // the record refers to the name in the question, and has a zero ttl
+        unsigned char record[] = { 0xc0, 0x0c, 0, 1, 0, 1, 0, 0, 0, 0, 0, 4, 127, 0, 0, 1 };
+        memcpy(buffer + len, record, sizeof(record));
+
+        // send it back
+        sendto(fd, buffer, len + sizeof(record), 0, (struct sockaddr *)&peer, size);
+        size = sizeof(peer);
+    }
+}
+
+/**
+ *  Main procedure
+ *  @param  argc
+ *  @param  argv
+ *  @return int
+ */
+int main(int argc, char *argv[])
+{
+    // the settings
+    size_t count = argc > 1 ? std::stoul(argv[1]) : 100000;
+    size_t window = argc > 2 ? std::stoul(argv[2]) : 100;
+    std::string server = argc > 3 ? argv[3] : "";
+
+    // without a server we start our own
+    int fd = -1;
+    std::thread thread;
+    if (server.empty())
+    {
+        // bind a socket to a free port on the loopback interface
+        struct sockaddr_in address;
+        socklen_t size = sizeof(address);
+        memset(&address, 0, sizeof(address));
+        address.sin_family = AF_INET;
+        address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+        fd = socket(AF_INET, SOCK_DGRAM, 0);
+        bind(fd, (struct sockaddr *)&address, sizeof(address));
+        getsockname(fd, (struct sockaddr *)&address, &size);
+
+        // answer the queries in a thread
+        server = "127.0.0.1:" + std::to_string(ntohs(address.sin_port));
+        thread = std::thread(serve, fd);
+    }
+
+    // we need an event loop and a resolver
+    React::MainLoop loop;
+    React::Dns::Resolver resolver(&loop);
+    resolver.servers(server);
+
+    // the names are generated while the batch runs
+    size_t next = 0;
+    auto source = [&next, count](std::string &name) -> bool {
+        if (next == count) return false;
+        name = "host" + std::to_string(next++) + ".bench";
+        return true;
+    };
+
+    // run the batch
+    auto bulk = resolver.bulk(source, 4, [](const std::string &name, React::Dns::IpResult &&ips, const char *error) {}, window);
+    bulk->onFinished([&loop]() { loop.stop(); });
+    loop.run();
+
+    // report
+    std::cout << bulk->completed() << " lookups, " << bulk->failed() << " failed, window " << window << std::endl;
+    std::cout << bulk->elapsed() << " seconds, " << bulk->throughput() << " lookups/s" << std::endl;
+    std::cout << "latency: " << bulk->latency() * 1000.0 << " ms average, " << bulk->slowest() * 1000.0 << " ms slowest" << std::endl;
+
+    // stop our own server
+    if (fd >= 0) { shutdown(fd, SHUT_RDWR); close(fd); thread.join(); }
+
+    // done
+    return 0;
+}
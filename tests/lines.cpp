@@ -0,0 +1,92 @@
+#include <reactcpp.h>
+#include <iostream>
+#include <chrono>
+
+/**
+ *  The line splitting that was used by Tcp::In before, it searches for
+ *  carriage returns and skips the line feed that should follow
+ *  @param  buffer      The buffer
+ *  @param  size        Number of bytes in the buffer
+ *  @param  callback    Function called for each line
+ *  @return size_t      Number of bytes that remain
+ */
+static size_t previous(char *buffer, size_t size, const React::Tcp::DataCallback &callback)
+{
+    // the starting point of each chunk
+    char *start;
+
+    // process all lines in the data
+    for (start = buffer; auto *newline = (char*)std::memchr(start, '\r', size + buffer - start); start = newline + 2)
+    {
+        // execute the callback
+        callback(start, newline - start);
+    }
+
+    // number of bytes that remain
+    return start < buffer + size ? buffer + size - start : 0;
+}
+
+/**
+ *  Run a benchmark
+ *  @param  name        Name of the implementation
+ *  @param  data        The data to split
+ *  @param  rounds      Number of rounds
+ *  @param  function    Function that splits the data once
+ */
+template <typename FUNCTION>
+static void measure(const char *name, const std::string &data, size_t rounds, const FUNCTION &function)
+{
+    // start time
+    auto start = std::chrono::steady_clock::now();
+
+    // number of lines found
+    size_t lines = 0;
+
+    // run all rounds
+    for (size_t i = 0; i < rounds; ++i) lines += function();
+
+    // time it took
+    std::chrono::duration<double> seconds = std::chrono::steady_clock::now() - start;
+
+    // report
+    std::cout << name << ": " << lines << " lines, " << (data.size() * rounds / seconds.count() / 1048576.0) << " MB/s" << std::endl;
+}
+
+/**
+ *  Main application procedure
+ *  @return int
+ */
+int main()
+{
+    // construct a buffer of SMTP-like lines of different lengths
+    std::string data;
+    for (size_t i = 0; data.size() < 1536 - 100; ++i) data.append(std::string(20 + (i * 37) % 70, 'x')).append("\r\n");
+
+    // number of rounds
+    size_t rounds = 1000000;
+
+    // buffer to work on
+    std::vector<char> buffer(data.begin(), data.end());
+
+    // callback that counts the lines
+    size_t count = 0;
+    React::Tcp::DataCallback callback = [&count](const void *buffer, size_t size) -> bool { count++; return true; };
+
+    // the previous implementation
+    measure("memchr \\r", data, rounds, [&]() -> size_t {
+        count = 0;
+        previous(buffer.data(), buffer.size(), callback);
+        return count;
+    });
+
+    // the line splitter
+    React::Tcp::LineSplitter splitter(1536);
+    measure("LineSplitter", data, rounds, [&]() -> size_t {
+        count = 0;
+        splitter.process(buffer.data(), buffer.size(), callback);
+        return count;
+    });
+
+    // done
+    return 0;
+}
@@ -0,0 +1,155 @@
+/**
+ *  Parse.cpp
+ *
+ *  Benchmark for parsing answers, the parsers of the ares library compared
+ *  to the allocation-free parser that the resolver uses
+ *
+ *  @copyright 2014 Copernica BV
+ */
+#include <reactcpp.h>
+#include <iostream>
+#include <chrono>
+
+/**
+ *  Build an answer for example.test
+ *  @param  type        Record type
+ *  @param  records     The data of the records
+ *  @return std::string
+ */
+static std::string answer(int type, const std::vector<std::string> &records)
+{
+    // the header and the question
+    std::string result("\x00\x00\x81\x80\x00\x01\x00\x00\x00\x00\x00\x00", 12);
+    result.append("\x07" "example" "\x04" "test" "\x00", 14);
+    result.push_back(0); result.push_back(type); result.push_back(0); result.push_back(1);
+
+    // the records refer to the name in the question
+    for (auto &data : records)
+    {
+        unsigned char header[] = { 0xc0, 0x0c, 0, (unsigned char)type, 0, 1, 0, 0, 0x0e, 0x10, (unsigned char)(data.size() >> 8), (unsigned char)data.size() };
+        result.append((const char *)header, sizeof(header)).append(data);
+    }
+
+    // set the number of records
+    result[7] = records.size();
+
+    // done
+    return result;
+}
+
+/**
+ *  Run a benchmark
+ *  @param  name        Name of the implementation
+ *  @param  rounds      Number of rounds
+ *  @param  function    Function that parses the answer once, and returns the number of records
+ */
+template <typename FUNCTION>
+static void measure(const char *name, size_t rounds, const FUNCTION &function)
+{
+    // start time
+    auto start = std::chrono::steady_clock::now();
+
+    // number of records found
+    size_t records = 0;
+
+    // run all rounds
+    for (size_t i = 0; i < rounds; ++i) records += function();
+
+    // time it took
+    std::chrono::duration<double> seconds = std::chrono::steady_clock::now() - start;
+
+    // report
+    std::cout << name << ": " << records << " records, " << (seconds.count() * 1e9 / rounds) << " ns per answer" << std::endl;
+}
+
+/**
+ *  Main application procedure
+ *  @return int
+ */
+int main()
+{
+    // number of rounds
+    size_t rounds = 1000000;
+
+    // an answer with sixteen addresses
+    std::vector<std::string> addresses;
+    for (int i = 0; i < 16; ++i) addresses.push_back(std::string("\x0a\x00\x00", 3) + (char)i);
+    std::string a = answer(ns_t_a, addresses);
+
+    // an answer with five mail servers
+    std::vector<std::string> servers;
+    for (int i = 0; i < 5; ++i) servers.push_back(std::string("\x00", 1) + (char)(i * 10) + "\x03mx" + (char)('0' + i) + std::string("\xc0\x0c", 2));
+    std::string mx = answer(ns_t_mx, servers);
+
+    // an answer with three texts, one of them split in two strings like long DKIM keys
+    std::string spf = "v=spf1 include:_spf.example.test ~all";
+    std::string key = "v=DKIM1; k=rsa; p=" + std::string(200, 'A');
+    std::vector<std::string> texts = { (char)spf.size() + spf, (char)key.size() + key + (char)key.size() + key, std::string("\x05hello") };
+    std::string txt = answer(ns_t_txt, texts);
+
+    // addresses with the ares library, with the growing arrays that the resolver used before
+    measure("A ares_parse_a_reply", rounds, [&]() -> size_t {
+        React::Dns::IpResult result;
+        for (int size = 8; true; size += 4)
+        {
+            std::unique_ptr<struct ares_addrttl[]> addresses(new struct ares_addrttl[size]);
+            int matches = size;
+            if (ares_parse_a_reply((const unsigned char *)a.data(), a.size(), nullptr, addresses.get(), &matches) != ARES_SUCCESS) break;
+            if (matches >= size) continue;
+            for (int i = 0; i < matches; ++i) result.insert(React::Dns::IpRecord(&addresses[i]));
+            break;
+        }
+        return result.size();
+    });
+
+    // addresses with the parser
+    measure("A Parser", rounds, [&]() -> size_t {
+        React::Dns::IpResult result;
+        React::Dns::Parser parser((const unsigned char *)a.data(), a.size());
+        while (parser.next())
+        {
+            if (parser.type() != ns_t_a || parser.length() != 4) continue;
+            struct in_addr address;
+            memcpy(&address, parser.data(), 4);
+            result.insert(React::Dns::IpRecord(React::Net::Ipv4(address), parser.ttl()));
+        }
+        return result.size();
+    });
+
+    // mail servers with the ares library
+    measure("MX ares_parse_mx_reply", rounds, [&]() -> size_t {
+        std::set<React::Dns::MxRecord> result;
+        struct ares_mx_reply *first = nullptr;
+        if (ares_parse_mx_reply((const unsigned char *)mx.data(), mx.size(), &first) != ARES_SUCCESS) return 0;
+        for (auto current = first; current; current = current->next) result.insert(React::Dns::MxRecord(current->host, current->priority));
+        ares_free_data(first);
+        return result.size();
+    });
+
+    // mail servers with the parser
+    measure("MX MxResult", rounds, [&]() -> size_t {
+        return React::Dns::MxResult((const unsigned char *)mx.data(), mx.size()).size();
+    });
+
+    // texts with the ares library
+    measure("TXT ares_parse_txt_reply_ext", rounds, [&]() -> size_t {
+        std::vector<std::string> result;
+        struct ares_txt_ext *first = nullptr;
+        if (ares_parse_txt_reply_ext((const unsigned char *)txt.data(), txt.size(), &first) != ARES_SUCCESS) return 0;
+        for (auto current = first; current; current = current->next)
+        {
+            if (current->record_start) result.emplace_back();
+            result.back().append((const char *)current->txt, current->length);
+        }
+        ares_free_data(first);
+        return result.size();
+    });
+
+    // texts with the parser
+    measure("TXT TxtResult", rounds, [&]() -> size_t {
+        return React::Dns::TxtResult((const unsigned char *)txt.data(), txt.size()).size();
+    });
+
+    // done
+    return 0;
+}